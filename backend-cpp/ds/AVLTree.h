@@ -10,6 +10,7 @@
  * Key Features:
  *   - Self-balancing with LL, RR, LR, RL rotations
  *   - findClosest(target) - CRITICAL for rank-based matchmaking
+ *   - rangeTraversal(low, high) - visit only the values inside a window
  *   - In-order traversal for leaderboard generation
  * 
  * Time Complexity:
@@ -17,7 +18,10 @@
  *   - remove(): O(log n)
  *   - search(): O(log n)
  *   - findClosest(): O(log n)
+ *   - rangeTraversal(): O(log n + k) for k values in range
  *   - inOrderTraversal(): O(n)
+ *   - replaceInOrder(): O(n), no allocation
+ *   - assignSorted(): O(n), builds a balanced tree without rotations
  * 
  * No STL dependencies - pure pointer-based implementation
  */
@@ -412,6 +416,80 @@ private:
         reverseInOrderHelper(node->left, callback);
     }
     
+public:
+    /**
+     * rangeTraversal - For window-based matchmaking
+     * 
+     * Visits values v with low <= v <= high in ascending order, skipping
+     * subtrees that lie entirely outside the range.
+     * 
+     * @param callback Called for each value in range; return false to stop
+     * 
+     * Time Complexity: O(log n + k) for k values visited
+     */
+    template <typename Callback>
+    void rangeTraversal(const T& low, const T& high, Callback callback) const {
+        rangeHelper(root, low, high, callback);
+    }
+    
+private:
+    // Returns false once the callback asks to stop
+    template <typename Callback>
+    bool rangeHelper(Node* node, const T& low, const T& high, Callback& callback) const {
+        if (!node) return true;
+        if (low < node->data && !rangeHelper(node->left, low, high, callback)) return false;
+        if (!(node->data < low) && !(high < node->data) && !callback(node->data)) return false;
+        if (node->data < high) return rangeHelper(node->right, low, high, callback);
+        return true;
+    }
+    
+public:
+    /**
+     * Replace every value, in order, with values[0 .. size() - 1] - O(n)
+     *
+     * values must be sorted. The tree's shape (and so its balance) is
+     * kept and nothing is allocated, so re-keying every entry through an
+     * order-preserving map costs one walk instead of n removes and
+     * inserts.
+     */
+    void replaceInOrder(const T* values) {
+        size_t next = 0;
+        replaceHelper(root, values, next);
+    }
+    
+private:
+    void replaceHelper(Node* node, const T* values, size_t& next) {
+        if (!node) return;
+        replaceHelper(node->left, values, next);
+        node->data = values[next++];
+        replaceHelper(node->right, values, next);
+    }
+    
+public:
+    /**
+     * Replace the contents with values[0 .. count - 1] - O(n)
+     *
+     * values must be sorted and distinct. The middle value becomes the
+     * root, and so on down each half, so the tree comes out balanced
+     * without a single rotation where n inserts would cost O(n log n).
+     */
+    void assignSorted(const T* values, size_t count) {
+        clear();
+        root = buildBalanced(values, 0, count);
+        nodeCount = count;
+    }
+    
+private:
+    Node* buildBalanced(const T* values, size_t begin, size_t end) {
+        if (begin >= end) return nullptr;
+        size_t middle = begin + (end - begin) / 2;
+        Node* node = new Node(values[middle]);
+        node->left = buildBalanced(values, begin, middle);
+        node->right = buildBalanced(values, middle + 1, end);
+        updateHeight(node);
+        return node;
+    }
+    
 public:
     // Get size - O(1)
     size_t size() const {
@@ -0,0 +1,144 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include <cstddef>
+
+/**
+ * Bitset - A growable array of bits packed into 64-bit words
+ *
+ * Purpose: Availability flags over a sorted pool (e.g. which bots are free)
+ * Key Features:
+ *   - set/clear/test a single bit in O(1)
+ *   - findNext/findPrevious skip 64 bits per step, so locating the nearest
+ *     set bit to a position is a short word scan even in a sparse set
+ *
+ * Time Complexity:
+ *   - set(), clear(), test(): O(1)
+ *   - findNext(), findPrevious(): O(distance / 64)
+ *   - resize(): O(n / 64)
+ *
+ * No STL dependencies - pure array-based implementation
+ */
+class Bitset {
+public:
+    static const long long NONE = -1;
+
+private:
+    typedef unsigned long long Word;
+    static const size_t WORD_BITS = 64;
+
+    Word* words;
+    size_t wordCount;
+    size_t bitCount;
+
+    static int lowestBit(Word word) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(word);
+#else
+        int bit = 0;
+        while (!(word & 1)) { word >>= 1; bit++; }
+        return bit;
+#endif
+    }
+
+    static int highestBit(Word word) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(word);
+#else
+        int bit = 63;
+        while (!(word >> bit)) bit--;
+        return bit;
+#endif
+    }
+
+public:
+    Bitset() : words(nullptr), wordCount(0), bitCount(0) {}
+
+    ~Bitset() {
+        delete[] words;
+    }
+
+    Bitset(const Bitset&) = delete;
+    Bitset& operator=(const Bitset&) = delete;
+
+    // Grow (or shrink) to bits; new bits are cleared
+    void resize(size_t bits) {
+        size_t needed = (bits + WORD_BITS - 1) / WORD_BITS;
+        if (needed > wordCount) {
+            Word* newWords = new Word[needed];
+            for (size_t i = 0; i < needed; i++) {
+                newWords[i] = i < wordCount ? words[i] : 0;
+            }
+            delete[] words;
+            words = newWords;
+            wordCount = needed;
+        }
+        // Clear anything beyond the new end so scans never see it
+        for (size_t i = bits; i < bitCount && i < wordCount * WORD_BITS; i++) {
+            clear(i);
+        }
+        bitCount = bits;
+    }
+
+    void set(size_t bit) {
+        words[bit / WORD_BITS] |= static_cast<Word>(1) << (bit % WORD_BITS);
+    }
+
+    void clear(size_t bit) {
+        words[bit / WORD_BITS] &= ~(static_cast<Word>(1) << (bit % WORD_BITS));
+    }
+
+    bool test(size_t bit) const {
+        return (words[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1;
+    }
+
+    void clearAll() {
+        for (size_t i = 0; i < wordCount; i++) {
+            words[i] = 0;
+        }
+    }
+
+    /**
+     * First set bit at or after from
+     *
+     * @return Bit position, or NONE
+     */
+    long long findNext(size_t from) const {
+        if (from >= bitCount) return NONE;
+        size_t w = from / WORD_BITS;
+        Word word = words[w] & (~static_cast<Word>(0) << (from % WORD_BITS));
+        while (true) {
+            if (word) {
+                size_t bit = w * WORD_BITS + lowestBit(word);
+                return bit < bitCount ? static_cast<long long>(bit) : NONE;
+            }
+            if (++w >= wordCount) return NONE;
+            word = words[w];
+        }
+    }
+
+    /**
+     * Last set bit at or before from
+     *
+     * @return Bit position, or NONE
+     */
+    long long findPrevious(long long from) const {
+        if (from < 0 || bitCount == 0) return NONE;
+        if (static_cast<size_t>(from) >= bitCount) from = static_cast<long long>(bitCount) - 1;
+        size_t w = static_cast<size_t>(from) / WORD_BITS;
+        size_t offset = static_cast<size_t>(from) % WORD_BITS;
+        Word word = words[w] & (offset == WORD_BITS - 1 ? ~static_cast<Word>(0)
+                                                        : (static_cast<Word>(1) << (offset + 1)) - 1);
+        while (true) {
+            if (word) return static_cast<long long>(w * WORD_BITS + highestBit(word));
+            if (w == 0) return NONE;
+            word = words[--w];
+        }
+    }
+
+    size_t size() const {
+        return bitCount;
+    }
+};
+
+#endif // BITSET_H
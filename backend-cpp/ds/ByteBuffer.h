@@ -0,0 +1,207 @@
+#ifndef BYTE_BUFFER_H
+#define BYTE_BUFFER_H
+
+#include <cstring>
+#include <cstddef>
+
+/**
+ * ByteWriter / ByteReader - Flat binary encoding of fixed-width fields
+ *
+ * Purpose: Building and parsing binary records (write-ahead log entries,
+ *          snapshots) without a per-field allocation or text formatting
+ * Key Features:
+ *   - ByteWriter appends ints, longs, doubles and raw bytes to one growable
+ *     array (doubling), in host byte order
+ *   - ByteReader reads them back in the same order; any read past the end
+ *     clears ok() and returns zeros instead of touching memory it does not
+ *     own, so a truncated record is detected once, after parsing
+ *   - align() pads / skips to a boundary, so arrays inside a buffer can be
+ *     used in place once it is loaded or mapped
+ *   - crc32() checksums a byte range (IEEE polynomial, table-driven)
+ *
+ * Time Complexity:
+ *   - put*(), get*(): O(1) amortized (O(n) for n raw bytes)
+ *   - crc32(): O(n)
+ *   - Space: O(bytes written)
+ *
+ * No STL dependencies - pure array-based implementation
+ */
+class ByteWriter {
+private:
+    char* data;
+    size_t length;
+    size_t capacity;
+
+public:
+    ByteWriter() : data(nullptr), length(0), capacity(0) {}
+
+    ~ByteWriter() {
+        delete[] data;
+    }
+
+    ByteWriter(const ByteWriter&) = delete;
+    ByteWriter& operator=(const ByteWriter&) = delete;
+
+    // Make room for extra more bytes (one allocation for a known size)
+    void reserve(size_t extra) {
+        if (length + extra <= capacity) return;
+        size_t grown = capacity == 0 ? 256 : capacity * 2;
+        while (grown < length + extra) grown *= 2;
+        char* bigger = new char[grown];
+        if (length > 0) memcpy(bigger, data, length);
+        delete[] data;
+        data = bigger;
+        capacity = grown;
+    }
+
+    void putBytes(const void* bytes, size_t count) {
+        reserve(count);
+        if (count > 0) memcpy(data + length, bytes, count);
+        length += count;
+    }
+
+    void putByte(unsigned char value) { putBytes(&value, sizeof(value)); }
+    void putInt(int value) { putBytes(&value, sizeof(value)); }
+    void putUnsigned(unsigned value) { putBytes(&value, sizeof(value)); }
+    void putLong(long long value) { putBytes(&value, sizeof(value)); }
+    void putDouble(double value) { putBytes(&value, sizeof(value)); }
+    void putFloat(float value) { putBytes(&value, sizeof(value)); }
+
+    // Zero bytes up to the next multiple of alignment
+    void align(size_t alignment) {
+        static const char zeros[64] = {0};
+        while (length % alignment != 0) {
+            size_t pad = alignment - length % alignment;
+            putBytes(zeros, pad < sizeof(zeros) ? pad : sizeof(zeros));
+        }
+    }
+
+    // Length-prefixed string (int length, then the bytes, no terminator)
+    void putString(const char* text) {
+        int count = static_cast<int>(strlen(text));
+        putInt(count);
+        putBytes(text, static_cast<size_t>(count));
+    }
+
+    /**
+     * Overwrite an int written earlier (e.g. a count or length filled in
+     * once the fields after it are known)
+     */
+    void patchInt(size_t offset, int value) {
+        if (offset + sizeof(value) <= length) memcpy(data + offset, &value, sizeof(value));
+    }
+
+    void patchUnsigned(size_t offset, unsigned value) {
+        if (offset + sizeof(value) <= length) memcpy(data + offset, &value, sizeof(value));
+    }
+
+    void patchLong(size_t offset, long long value) {
+        if (offset + sizeof(value) <= length) memcpy(data + offset, &value, sizeof(value));
+    }
+
+    const char* bytes() const { return data; }
+    size_t size() const { return length; }
+
+    // Forget the contents, keeping the allocation
+    void clear() { length = 0; }
+
+    // Exchange contents with another writer - O(1)
+    void swap(ByteWriter& other) {
+        char* d = data; data = other.data; other.data = d;
+        size_t l = length; length = other.length; other.length = l;
+        size_t c = capacity; capacity = other.capacity; other.capacity = c;
+    }
+};
+
+class ByteReader {
+private:
+    const char* data;
+    size_t length;
+    size_t position;
+    bool valid;
+
+public:
+    ByteReader(const char* bytes, size_t count) : data(bytes), length(count), position(0), valid(true) {}
+
+    bool getBytes(void* out, size_t count) {
+        if (!valid || count > length - position) {
+            valid = false;
+            memset(out, 0, count);
+            return false;
+        }
+        memcpy(out, data + position, count);
+        position += count;
+        return true;
+    }
+
+    unsigned char getByte() { unsigned char v; getBytes(&v, sizeof(v)); return v; }
+    int getInt() { int v; getBytes(&v, sizeof(v)); return v; }
+    unsigned getUnsigned() { unsigned v; getBytes(&v, sizeof(v)); return v; }
+    long long getLong() { long long v; getBytes(&v, sizeof(v)); return v; }
+    double getDouble() { double v; getBytes(&v, sizeof(v)); return v; }
+    float getFloat() { float v; getBytes(&v, sizeof(v)); return v; }
+
+    /**
+     * Length-prefixed string into out (capacity bytes, always terminated;
+     * longer strings are cut)
+     */
+    bool getString(char* out, size_t capacity) {
+        int count = getInt();
+        if (!valid || count < 0 || static_cast<size_t>(count) > length - position) {
+            valid = false;
+            if (capacity > 0) out[0] = '\0';
+            return false;
+        }
+        size_t kept = static_cast<size_t>(count) < capacity ? static_cast<size_t>(count) : capacity - 1;
+        memcpy(out, data + position, kept);
+        out[kept] = '\0';
+        position += static_cast<size_t>(count);
+        return true;
+    }
+
+    // Step over count bytes (e.g. an array used in place)
+    bool skip(size_t count) {
+        if (!valid || count > length - position) {
+            valid = false;
+            return false;
+        }
+        position += count;
+        return true;
+    }
+
+    // Skip the padding ByteWriter::align() wrote
+    bool align(size_t alignment) {
+        return position % alignment == 0 || skip(alignment - position % alignment);
+    }
+
+    // False once any read ran past the end
+    bool ok() const { return valid; }
+
+    size_t remaining() const { return length - position; }
+    size_t offset() const { return position; }
+};
+
+// Lookup table for crc32(), built once
+struct Crc32Table {
+    unsigned entries[256];
+
+    Crc32Table() {
+        for (unsigned i = 0; i < 256; i++) {
+            unsigned c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+// CRC-32 (IEEE 802.3) of a byte range
+inline unsigned crc32(const char* bytes, size_t count) {
+    static const Crc32Table table;  // Thread-safe one-time initialization
+    unsigned crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < count; i++) {
+        crc = table.entries[(crc ^ static_cast<unsigned char>(bytes[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#endif // BYTE_BUFFER_H
@@ -0,0 +1,134 @@
+#ifndef CHUNKEDARRAY_H
+#define CHUNKEDARRAY_H
+
+#include <cstddef>
+
+/**
+ * ChunkedArray<T> - A growable array made of fixed-size chunks
+ *
+ * Purpose: Dense column storage for the player store (one array per field)
+ * Key Features:
+ *   - Elements never move once allocated (growth only adds new chunks),
+ *     so pointers and references into the array stay valid
+ *   - Each chunk is contiguous, so scans over a column stay cache friendly
+ *   - The first chunks can be borrowed from caller memory (adopt(), e.g. a
+ *     mapped file) instead of allocated, so a column loads without a copy
+ *
+ * Time Complexity:
+ *   - append(): O(1) amortized (one chunk allocation every CHUNK_SIZE items)
+ *   - operator[]: O(1)
+ *   - size(): O(1)
+ *
+ * No STL dependencies - pure pointer-based implementation
+ */
+
+template <typename T>
+class ChunkedArray {
+public:
+    static const size_t CHUNK_BITS = 12;
+    static const size_t CHUNK_SIZE = static_cast<size_t>(1) << CHUNK_BITS;  // 4096 elements
+    static const size_t CHUNK_MASK = CHUNK_SIZE - 1;
+    static const size_t MAX_CHUNKS = 16384;                                 // ~67M elements
+
+private:
+    T** chunks;
+    size_t chunkCount;
+    size_t elementCount;
+    size_t borrowedChunks;  // Leading chunks owned by the caller (adopt)
+
+    // Make sure the chunk holding index exists
+    bool ensureChunk(size_t index) {
+        size_t chunk = index >> CHUNK_BITS;
+        if (chunk >= MAX_CHUNKS) return false;
+        while (chunkCount <= chunk) {
+            chunks[chunkCount++] = new T[CHUNK_SIZE]();  // Value-initialized
+        }
+        return true;
+    }
+
+public:
+    // Constructor
+    ChunkedArray() : chunks(new T*[MAX_CHUNKS]()), chunkCount(0), elementCount(0), borrowedChunks(0) {}
+
+    // Destructor
+    ~ChunkedArray() {
+        for (size_t i = borrowedChunks; i < chunkCount; i++) {
+            delete[] chunks[i];
+        }
+        delete[] chunks;
+    }
+
+    // Columns are owned by a single store - no copying
+    ChunkedArray(const ChunkedArray&) = delete;
+    ChunkedArray& operator=(const ChunkedArray&) = delete;
+
+    // Append a value-initialized element - O(1) amortized
+    // Returns index of the new element, or -1 if capacity is exhausted
+    long long append() {
+        if (!ensureChunk(elementCount)) return -1;
+        return static_cast<long long>(elementCount++);
+    }
+
+    // Append a copy of value - O(1) amortized
+    long long append(const T& value) {
+        long long index = append();
+        if (index >= 0) {
+            (*this)[static_cast<size_t>(index)] = value;
+        }
+        return index;
+    }
+
+    /**
+     * Use caller memory for the first count elements - O(count / CHUNK_SIZE)
+     *
+     * base holds count elements followed by room up to a whole number of
+     * chunks. Those chunks are used in place and never freed here (the
+     * memory must outlive the array); appends carry on into them, then
+     * into chunks of our own. Only while empty; T is used as raw bytes.
+     *
+     * @return false if the array is not empty or count is too large
+     */
+    bool adopt(T* base, size_t count) {
+        size_t needed = (count + CHUNK_MASK) >> CHUNK_BITS;
+        if (chunkCount > 0 || needed > MAX_CHUNKS) return false;
+        for (size_t i = 0; i < needed; i++) {
+            chunks[i] = base + i * CHUNK_SIZE;
+        }
+        chunkCount = needed;
+        borrowedChunks = needed;
+        elementCount = count;
+        return true;
+    }
+
+    // Element access - O(1), no bounds check
+    T& operator[](size_t index) {
+        return chunks[index >> CHUNK_BITS][index & CHUNK_MASK];
+    }
+
+    const T& operator[](size_t index) const {
+        return chunks[index >> CHUNK_BITS][index & CHUNK_MASK];
+    }
+
+    // Get number of elements - O(1)
+    size_t size() const {
+        return elementCount;
+    }
+
+    // Check if empty - O(1)
+    bool isEmpty() const {
+        return elementCount == 0;
+    }
+
+    // Clear all elements - O(chunks)
+    void clear() {
+        for (size_t i = 0; i < chunkCount; i++) {
+            if (i >= borrowedChunks) delete[] chunks[i];
+            chunks[i] = nullptr;
+        }
+        chunkCount = 0;
+        borrowedChunks = 0;
+        elementCount = 0;
+    }
+};
+
+#endif // CHUNKEDARRAY_H
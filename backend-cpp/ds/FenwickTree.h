@@ -0,0 +1,122 @@
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+/**
+ * FenwickTree - Binary indexed tree of counts over positions 0..size-1
+ *
+ * Purpose: Running distribution of a bounded integer key (e.g. how many
+ *          ranked players sit at each ELO), queried by prefix
+ * Key Features:
+ *   - add() changes one position's count; prefix sums stay exact
+ *   - countBelow/countAtOrAbove/rangeCount are prefix-sum differences
+ *   - findByRank walks down the implicit tree (binary lifting), so the
+ *     position of the k-th smallest entry needs no search over prefixes
+ *
+ * Node i (1-based) holds the sum of the (i & -i) positions ending at i.
+ *
+ * Time Complexity (R = size):
+ *   - add(), countBelow(), rangeCount(), findByRank(): O(log R)
+ *   - assign(): O(R) (every count at once)
+ *   - total(): O(1)
+ *   - Space: O(R)
+ *
+ * No STL dependencies - pure array-based implementation
+ */
+class FenwickTree {
+private:
+    int* nodes;       // 1-based
+    int length;
+    int highestStep;  // Largest power of two <= length
+    long long count;  // Sum of all positions
+
+public:
+    explicit FenwickTree(int size) : nodes(nullptr), length(size < 1 ? 1 : size), highestStep(1), count(0) {
+        nodes = new int[length + 1]();
+        while (highestStep * 2 <= length) highestStep *= 2;
+    }
+
+    ~FenwickTree() {
+        delete[] nodes;
+    }
+
+    FenwickTree(const FenwickTree&) = delete;
+    FenwickTree& operator=(const FenwickTree&) = delete;
+
+    int size() const { return length; }
+
+    long long total() const { return count; }
+
+    // Add delta to the count at a position - O(log R)
+    void add(int position, int delta) {
+        if (position < 0 || position >= length) return;
+        count += delta;
+        for (int i = position + 1; i <= length; i += i & -i) {
+            nodes[i] += delta;
+        }
+    }
+
+    // Entries at positions < position - O(log R)
+    long long countBelow(int position) const {
+        if (position <= 0) return 0;
+        if (position > length) position = length;
+        long long sum = 0;
+        for (int i = position; i > 0; i -= i & -i) {
+            sum += nodes[i];
+        }
+        return sum;
+    }
+
+    // Entries at positions >= position - O(log R)
+    long long countAtOrAbove(int position) const {
+        return count - countBelow(position);
+    }
+
+    // Entries at positions in [from, to) - O(log R)
+    long long rangeCount(int from, int to) const {
+        return to <= from ? 0 : countBelow(to) - countBelow(from);
+    }
+
+    /**
+     * Position of the k-th smallest entry (k from 1) - O(log R)
+     *
+     * @return size() if k exceeds total()
+     */
+    int findByRank(long long k) const {
+        if (k <= 0) return 0;
+        int position = 0;
+        for (int step = highestStep; step > 0; step >>= 1) {
+            int next = position + step;
+            if (next <= length && nodes[next] < k) {
+                position = next;
+                k -= nodes[next];
+            }
+        }
+        return position;  // Longest prefix holding fewer than k entries
+    }
+
+    /**
+     * Replace every count at once: counts[0 .. size() - 1] - O(R)
+     *
+     * Each node pushes its sum to its parent, so a full rebuild costs
+     * one pass instead of one add() per entry.
+     */
+    void assign(const int* counts) {
+        count = 0;
+        for (int i = 1; i <= length; i++) {
+            nodes[i] = counts[i - 1];
+            count += counts[i - 1];
+        }
+        for (int i = 1; i <= length; i++) {
+            int parent = i + (i & -i);
+            if (parent <= length) nodes[parent] += nodes[i];
+        }
+    }
+
+    // Reset every count to zero - O(R)
+    void clear() {
+        for (int i = 0; i <= length; i++) nodes[i] = 0;
+        count = 0;
+    }
+};
+
+#endif // FENWICK_TREE_H
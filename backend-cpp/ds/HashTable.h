@@ -250,13 +250,14 @@ public:
         elementCount = 0;
     }
     
-    // Get all keys (useful for iteration)
-    void getAllKeys(K* outKeys, size_t& outCount) const {
+    // Get all keys (useful for iteration) - writes at most maxKeys keys
+    void getAllKeys(K* outKeys, size_t maxKeys, size_t& outCount) const {
         outCount = 0;
         for (size_t i = 0; i < tableSize; i++) {
             LinkedList<KeyValuePair<K, V>>& bucket = 
                 const_cast<LinkedList<KeyValuePair<K, V>>&>(buckets[i]);
             for (auto it = bucket.begin(); it != bucket.end(); ++it) {
+                if (outCount == maxKeys) return;
                 outKeys[outCount++] = (*it).key;
             }
         }
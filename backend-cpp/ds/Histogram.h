@@ -0,0 +1,123 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+
+/**
+ * Histogram - Fixed-size log-linear histogram with lock-free recording
+ *
+ * Purpose: Distributions of values recorded on hot paths (queue waits,
+ *          ELO gaps) that other threads read at any time
+ * Key Features:
+ *   - HDR-style buckets: values below 2^SUB_BUCKET_BITS are exact; above
+ *     that each power of two is split into 2^SUB_BUCKET_BITS equal buckets,
+ *     so every bucket is within ~6% of the values it holds, from 1 up to
+ *     2^MAX_EXPONENT, in BUCKET_COUNT counters
+ *   - record() is a few relaxed atomic adds - no locks, no allocation
+ *   - Readers see a consistent-enough snapshot without stopping writers:
+ *     each counter is exact, counts recorded during a read may or may not
+ *     be included
+ *   - Values above the range land in the last bucket (max stays exact)
+ *
+ * Time Complexity:
+ *   - record(): O(1)
+ *   - percentile(): O(BUCKET_COUNT)
+ *   - count(), mean(), max(): O(1)
+ *
+ * No STL containers - a fixed array of std::atomic counters
+ */
+class Histogram {
+public:
+    static const int SUB_BUCKET_BITS = 4;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;          // 16
+    static const int MAX_EXPONENT = 40;                            // ~1.1e12
+    static const int BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+private:
+    std::atomic<long long> counts[BUCKET_COUNT];
+    std::atomic<long long> total;
+    std::atomic<long long> sum;
+    std::atomic<long long> maximum;
+
+    static int highestBit(unsigned long long value) {
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+    }
+
+public:
+    Histogram() : total(0), sum(0), maximum(0) {
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    // Bucket holding a value (negative values count as 0)
+    static int bucketOf(long long value) {
+        if (value < SUB_BUCKETS) return value < 0 ? 0 : static_cast<int>(value);
+        int shift = highestBit(static_cast<unsigned long long>(value)) - SUB_BUCKET_BITS;
+        int bucket = (shift + 1) * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+        return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+    }
+
+    // Largest value that falls in a bucket
+    static long long bucketHigh(int bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        int shift = bucket / SUB_BUCKETS - 1;
+        long long top = SUB_BUCKETS + bucket % SUB_BUCKETS;
+        return ((top + 1) << shift) - 1;
+    }
+
+    // Record one value - lock-free, O(1)
+    void record(long long value) {
+        if (value < 0) value = 0;
+        counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+
+        long long seen = maximum.load(std::memory_order_relaxed);
+        while (value > seen && !maximum.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+            // seen reloaded by the failed CAS
+        }
+    }
+
+    long long count() const {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    long long max() const {
+        return maximum.load(std::memory_order_relaxed);
+    }
+
+    double mean() const {
+        long long n = count();
+        return n > 0 ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    /**
+     * Value at a percentile (0-100), as the upper edge of its bucket
+     * capped at the recorded maximum; 0 if empty
+     */
+    long long percentile(double percent) const {
+        long long n = count();
+        if (n == 0) return 0;
+        long long rank = static_cast<long long>(percent / 100.0 * n + 0.5);
+        if (rank < 1) rank = 1;
+
+        long long seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                long long high = bucketHigh(i);
+                long long top = max();
+                return high < top ? high : top;
+            }
+        }
+        return max();
+    }
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,130 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * MappedFile - A whole file mapped copy-on-write into memory
+ *
+ * Purpose: Loading a large on-disk image (the player store) without
+ *          reading it: map() only reserves address space, and each page is
+ *          read from the file the first time it is touched
+ * Key Features:
+ *   - Private mapping: the memory is writable, but writes stay in this
+ *     process and never reach the file, so the file remains the image it
+ *     was when written (and may even be deleted while mapped on POSIX)
+ *   - The mapping is page aligned, so offsets aligned in the file are
+ *     aligned in memory
+ *
+ * Time Complexity:
+ *   - map(): O(1) (pages are faulted in lazily, O(1) each)
+ *   - unmap(): O(pages touched)
+ *
+ * No STL dependencies - thin wrapper over mmap / MapViewOfFile
+ */
+class MappedFile {
+private:
+    char* base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+public:
+#ifdef _WIN32
+    MappedFile() : base(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+#else
+    MappedFile() : base(nullptr), length(0) {}
+#endif
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map a whole file (replacing any current mapping)
+     *
+     * @return false if the file is missing, empty or cannot be mapped
+     */
+    bool map(const char* path) {
+        unmap();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+            unmap();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+        if (!view) {
+            unmap();
+            return false;
+        }
+        base = static_cast<char*>(view);
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);  // The mapping keeps the file referenced
+        if (view == MAP_FAILED) return false;
+        base = static_cast<char*>(view);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    // Exchange mappings with another object - O(1)
+    void swap(MappedFile& other) {
+        char* b = base; base = other.base; other.base = b;
+        size_t l = length; length = other.length; other.length = l;
+#ifdef _WIN32
+        HANDLE f = file; file = other.file; other.file = f;
+        HANDLE m = mapping; mapping = other.mapping; other.mapping = m;
+#endif
+    }
+
+    bool isMapped() const { return base != nullptr; }
+    char* data() const { return base; }
+    size_t size() const { return length; }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,65 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <cstddef>
+
+/**
+ * Sort - Stable merge sort over a plain array
+ *
+ * Purpose: Order matchmaking snapshots (e.g. queue entries by ELO) while
+ *          keeping equal keys in their original (FIFO) order
+ * Key Features:
+ *   - Stable: equal elements keep their relative order
+ *   - Bottom-up (no recursion); caller supplies the scratch buffer so
+ *     repeated sorts of similar sizes do not allocate
+ *   - Ordering is given by a functor: less(a, b) returns true if a < b
+ *
+ * Time Complexity:
+ *   - mergeSort(): O(n log n), O(n) scratch space
+ *
+ * No STL dependencies - pure array-based implementation
+ */
+
+/**
+ * Sort data[0..count-1] in place
+ *
+ * @param data Elements to sort
+ * @param scratch Buffer of at least count elements
+ * @param count Number of elements
+ * @param less Strict ordering functor
+ */
+template <typename T, typename Less>
+void mergeSort(T* data, T* scratch, size_t count, Less less) {
+    if (count < 2) return;
+
+    T* from = data;
+    T* to = scratch;
+
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t left = 0; left < count; left += 2 * width) {
+            size_t mid = left + width < count ? left + width : count;
+            size_t right = left + 2 * width < count ? left + 2 * width : count;
+
+            size_t i = left, j = mid, k = left;
+            while (i < mid && j < right) {
+                // Take from the right run only if strictly smaller (stability)
+                if (less(from[j], from[i])) to[k++] = from[j++];
+                else to[k++] = from[i++];
+            }
+            while (i < mid) to[k++] = from[i++];
+            while (j < right) to[k++] = from[j++];
+        }
+        T* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    // Result ended up in the scratch buffer - copy back
+    if (from != data) {
+        for (size_t i = 0; i < count; i++) {
+            data[i] = from[i];
+        }
+    }
+}
+
+#endif // SORT_H
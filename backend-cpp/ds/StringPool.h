@@ -0,0 +1,309 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include "ChunkedArray.h"
+#include "HashTable.h"
+#include "ByteBuffer.h"
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+
+/**
+ * StringPool - Interns strings into an arena and hands out stable IDs
+ *
+ * Purpose: Store each distinct username exactly once
+ * Key Features:
+ *   - Each distinct string is copied once into a block arena; the bytes
+ *     never move, so get() pointers stay valid for the pool's lifetime
+ *   - Interned strings are identified by a dense int ID, so equality
+ *     between two interned strings is a single integer compare
+ *   - A JSON-escaped copy is built once at intern time, so response
+ *     building just copies the escaped bytes
+ *   - Lookup by content uses HashTable<const char*, int> keyed by the
+ *     arena copy (djb2 hash)
+ *
+ * IMAGES:
+ * writeImage() lays the whole pool out flat (string table, open-addressing
+ * content index, bytes); attachImage() uses such an image in place (e.g.
+ * from a mapped file) as the pool's first strings. Only the string table
+ * is read at attach time - the bytes and the index are touched when a
+ * string is used or looked up. Strings interned later go to the arena
+ * and the HashTable as usual.
+ *
+ * Time Complexity:
+ *   - intern(): O(length) average
+ *   - find(): O(length) average
+ *   - get()/getEscaped()/length(): O(1)
+ *   - writeImage(): O(total bytes)
+ *   - attachImage(): O(strings)
+ */
+class StringPool {
+public:
+    static const int NO_STRING = -1;
+
+private:
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    struct Entry {
+        const char* raw;
+        const char* escaped;
+        unsigned int rawLength;
+        unsigned int escapedLength;
+
+        Entry() : raw(nullptr), escaped(nullptr), rawLength(0), escapedLength(0) {}
+    };
+
+    // Arena: list of byte blocks (blocks never move, the list may grow)
+    char** blocks;
+    size_t blockCount;
+    size_t blockCapacity;
+    size_t blockUsed;     // Bytes used in the last block
+    size_t lastBlockSize;
+
+    // String table entry in an image (byte offsets into its byte section)
+    struct ImageString {
+        long long offset;
+        unsigned int rawLength;
+        unsigned int escapedLength;
+    };
+
+    ChunkedArray<Entry> entries;
+    HashTable<const char*, int> index;
+
+    // Content index of an attached image (linear probing, NO_STRING = empty)
+    const int* imageSlots;
+    size_t imageMask;
+    int imageCount;
+
+    static size_t imageSlotCount(int count) {
+        size_t slots = 16;
+        while (slots < static_cast<size_t>(count) * 2) slots *= 2;
+        return slots;
+    }
+
+    // Probe an attached image's index for str
+    int findInImage(const char* str) const {
+        size_t slot = HashFunc<const char*>()(str, imageMask + 1);
+        for (size_t probes = 0; probes <= imageMask; probes++, slot = (slot + 1) & imageMask) {
+            int id = imageSlots[slot];
+            if (id < 0 || id >= imageCount) break;
+            if (strcmp(entries[id].raw, str) == 0) return id;
+        }
+        return NO_STRING;
+    }
+
+    // Reserve bytes in the arena - O(1) amortized
+    char* allocate(size_t bytes) {
+        if (blockCount == 0 || blockUsed + bytes > lastBlockSize) {
+            if (blockCount == blockCapacity) {
+                size_t newCapacity = blockCapacity == 0 ? 16 : blockCapacity * 2;
+                char** newBlocks = new char*[newCapacity];
+                for (size_t i = 0; i < blockCount; i++) {
+                    newBlocks[i] = blocks[i];
+                }
+                delete[] blocks;
+                blocks = newBlocks;
+                blockCapacity = newCapacity;
+            }
+            lastBlockSize = bytes > BLOCK_SIZE ? bytes : BLOCK_SIZE;
+            blocks[blockCount++] = new char[lastBlockSize];
+            blockUsed = 0;
+        }
+        char* out = blocks[blockCount - 1] + blockUsed;
+        blockUsed += bytes;
+        return out;
+    }
+
+    // Bytes needed to JSON-escape str (without surrounding quotes)
+    static size_t escapedSize(const char* str, size_t length) {
+        size_t size = 0;
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(str[i]);
+            if (c == '"' || c == '\\') size += 2;
+            else if (c < 0x20) size += 6;  // \u00XX
+            else size += 1;
+        }
+        return size;
+    }
+
+    static void escapeInto(const char* str, size_t length, char* out) {
+        for (size_t i = 0; i < length; i++) {
+            unsigned char c = static_cast<unsigned char>(str[i]);
+            if (c == '"' || c == '\\') {
+                *out++ = '\\';
+                *out++ = static_cast<char>(c);
+            } else if (c < 0x20) {
+                snprintf(out, 7, "\\u%04x", c);
+                out += 6;
+            } else {
+                *out++ = static_cast<char>(c);
+            }
+        }
+        *out = '\0';
+    }
+
+public:
+    // Constructor
+    StringPool()
+        : blocks(nullptr), blockCount(0), blockCapacity(0),
+          blockUsed(0), lastBlockSize(0), imageSlots(nullptr), imageMask(0), imageCount(0) {}
+
+    // Destructor
+    ~StringPool() {
+        for (size_t i = 0; i < blockCount; i++) {
+            delete[] blocks[i];
+        }
+        delete[] blocks;
+    }
+
+    // Interned pointers are handed out - no copying
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * Intern a string
+     *
+     * @param str NUL-terminated string
+     * @return ID of the (possibly existing) interned copy, or NO_STRING if
+     *         the pool is full
+     */
+    int intern(const char* str) {
+        int existing = find(str);
+        if (existing != NO_STRING) return existing;
+
+        size_t length = strlen(str);
+        size_t escLength = escapedSize(str, length);
+
+        // Raw and escaped copies are laid out back to back
+        char* raw = allocate(length + 1 + escLength + 1);
+        memcpy(raw, str, length + 1);
+        char* escaped = raw + length + 1;
+        escapeInto(str, length, escaped);
+
+        Entry entry;
+        entry.raw = raw;
+        entry.escaped = escaped;
+        entry.rawLength = static_cast<unsigned int>(length);
+        entry.escapedLength = static_cast<unsigned int>(escLength);
+
+        long long id = entries.append(entry);
+        if (id < 0) return NO_STRING;
+
+        index.insert(raw, static_cast<int>(id));
+        return static_cast<int>(id);
+    }
+
+    /**
+     * Find an already-interned string
+     *
+     * @return ID, or NO_STRING if never interned
+     */
+    int find(const char* str) const {
+        if (imageSlots) {
+            int id = findInImage(str);
+            if (id != NO_STRING) return id;
+        }
+        const int* id = index.get(str);
+        return id ? *id : NO_STRING;
+    }
+
+    // Interned bytes (NUL-terminated)
+    const char* get(int id) const { return entries[id].raw; }
+    size_t length(int id) const { return entries[id].rawLength; }
+
+    // JSON-escaped bytes without surrounding quotes (NUL-terminated)
+    const char* getEscaped(int id) const { return entries[id].escaped; }
+    size_t escapedLength(int id) const { return entries[id].escapedLength; }
+
+    // Number of distinct strings
+    int size() const {
+        return static_cast<int>(entries.size());
+    }
+
+    /**
+     * Append a flat image of every string to out
+     *
+     * Layout: count, index slots, byte count, ImageString[count],
+     * int[slots] content index, then raw + NUL + escaped + NUL per string.
+     */
+    void writeImage(ByteWriter& out) const {
+        int count = size();
+        size_t slotCount = imageSlotCount(count);
+        out.putInt(count);
+        out.putInt(static_cast<int>(slotCount));
+        size_t byteCountAt = out.size();
+        out.putLong(0);
+
+        out.align(8);
+        out.reserve(static_cast<size_t>(count) * sizeof(ImageString) + slotCount * sizeof(int));
+        long long offset = 0;
+        for (int id = 0; id < count; id++) {
+            ImageString image;
+            image.offset = offset;
+            image.rawLength = entries[id].rawLength;
+            image.escapedLength = entries[id].escapedLength;
+            out.putBytes(&image, sizeof(image));
+            offset += image.rawLength + 1 + image.escapedLength + 1;
+        }
+
+        int* slots = new int[slotCount];
+        for (size_t i = 0; i < slotCount; i++) slots[i] = NO_STRING;
+        for (int id = 0; id < count; id++) {
+            size_t slot = HashFunc<const char*>()(entries[id].raw, slotCount);
+            while (slots[slot] != NO_STRING) slot = (slot + 1) & (slotCount - 1);
+            slots[slot] = id;
+        }
+        out.putBytes(slots, slotCount * sizeof(int));
+        delete[] slots;
+
+        out.reserve(static_cast<size_t>(offset));
+        for (int id = 0; id < count; id++) {
+            out.putBytes(entries[id].raw, entries[id].rawLength + 1);
+            out.putBytes(entries[id].escaped, entries[id].escapedLength + 1);
+        }
+        out.patchLong(byteCountAt, offset);
+    }
+
+    /**
+     * Use an image written by writeImage() as this (empty) pool's strings
+     *
+     * @param in   Reader positioned at the image within base
+     * @param base Start of the buffer in reads; must outlive the pool
+     * @return false if the pool is not empty or the image is malformed
+     */
+    bool attachImage(ByteReader& in, const char* base) {
+        if (size() > 0) return false;
+        int count = in.getInt();
+        int slotCount = in.getInt();
+        long long byteCount = in.getLong();
+        if (!in.ok() || count < 0 || slotCount < 1 || (slotCount & (slotCount - 1)) != 0 || byteCount < 0) return false;
+
+        in.align(8);
+        const ImageString* table = reinterpret_cast<const ImageString*>(base + in.offset());
+        in.skip(static_cast<size_t>(count) * sizeof(ImageString));
+        const int* slots = reinterpret_cast<const int*>(base + in.offset());
+        in.skip(static_cast<size_t>(slotCount) * sizeof(int));
+        const char* bytes = base + in.offset();
+        if (!in.skip(static_cast<size_t>(byteCount))) return false;
+
+        for (int id = 0; id < count; id++) {
+            const ImageString& image = table[id];
+            if (image.offset < 0 || image.offset + image.rawLength + image.escapedLength + 2 > byteCount) {
+                entries.clear();
+                return false;
+            }
+            Entry entry;
+            entry.raw = bytes + image.offset;
+            entry.escaped = entry.raw + image.rawLength + 1;
+            entry.rawLength = image.rawLength;
+            entry.escapedLength = image.escapedLength;
+            entries.append(entry);
+        }
+        imageSlots = slots;
+        imageMask = static_cast<size_t>(slotCount) - 1;
+        imageCount = count;
+        return true;
+    }
+};
+
+#endif // STRINGPOOL_H
@@ -0,0 +1,763 @@
+/**
+ * Matchmaking Benchmark - Greedy vs Batch pairing
+ *
+ * PURPOSE:
+ * Fills one game's queue with N players of random ELO, then matches the
+ * whole queue two ways on identical input:
+ *   - greedy: repeated Matchmaker::tryCreateMatch() (front of queue takes
+ *             the closest opponent inside its window, AVL range query)
+ *   - batch:  one Matchmaker::processMatchmaking() tick (sorted snapshot,
+ *             minimum total ELO gap via BatchMatcher)
+ *
+ * REPORTS (per path):
+ *   pairs created, pairs/sec, average and maximum ELO gap
+ *
+ * Also times closest-free-bot lookups (Matchmaker::findClosestBotOpponent)
+ * against a large BotPool with half the bots busy, and one batch tick over
+ * several games' queues run serially vs. one thread per game shard.
+ *
+ * Team games: one batch tick forming 2v2 and 5v5 matches from a queue ten
+ * times the player count (matches/sec, gap between team averages, ELO
+ * spread per match), and TeamBalancer's heuristic against exact search on
+ * random groups (splits/sec, average gap, how often the heuristic is
+ * optimal).
+ *
+ * Candidate index: nearest compatible opponent over ELO, latency bucket
+ * and input device (CandidateIndex) vs. a linear scan of the same
+ * candidates, with synthetic pings (four regions plus jitter) and devices
+ * generated locally.
+ *
+ * Restore: a state of R players (rated and ranked in every game) is
+ * snapshotted, a few hundred thousand queue / match / result operations
+ * are written to the write-ahead log, and the whole state is restored
+ * into fresh services (snapshot load + log replay) and compared with the
+ * original. Files go to ./matchmaking_bench_state and are removed after.
+ *
+ * Checks (exit status 1 if any fails):
+ *   - replay: a logged 2v2 match taking one member of a queued party of
+ *     two is replayed; the other member must be idle and the queue empty
+ *   - ranking: after a Glicko-2 2v2 result, and after the rating period
+ *     closes, all four members must be in the ranking tree
+ *   - versions: a result in one game must change the leaderboard version
+ *     of another game that lists the player (it shows their wins/losses)
+ *   - team size: parties that are not exactly one team are refused, and
+ *     every match of a 2v2 game (parties and solos) has two per side
+ *
+ * Startup: twenty times the bot count per game created and made ready
+ * (bot pools and ranking trees) one bot at a time, as initializeBots used
+ * to, vs. BulkLoader (one pass per structure, games in parallel).
+ *
+ * BUILD:
+ *   g++ -std=c++11 -O2 -pthread -o matchmaking_bench matchmaking_bench.cpp
+ *
+ * USAGE:
+ *   ./matchmaking_bench [players] [seed] [bots] [games] [restorePlayers]
+ *   (default 10000 players, 5000 bots, 4 games, 1000000 restored players)
+ */
+
+#include "models/Match.h"
+#include "services/PlayerStore.h"
+#include "services/GameRegistry.h"
+#include "services/RankingService.h"
+#include "services/HistoryService.h"
+#include "services/Matchmaker.h"
+#include "services/TeamBalancer.h"
+#include "services/CandidateIndex.h"
+#include "services/StateLog.h"
+#include "services/Persistence.h"
+#include "services/BulkLoader.h"
+#include "services/Clock.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+struct BenchResult {
+    int pairs;
+    double seconds;
+    double averageGap;
+    int maxGap;
+};
+
+// Deterministic ELO list shared by both runs (800-2000, clustered near 1200)
+void generateElos(int* elos, int count, unsigned seed) {
+    srand(seed);
+    for (int i = 0; i < count; i++) {
+        int spread = (rand() % 401) + (rand() % 401) + (rand() % 401);  // 0-1200, bell-shaped
+        elos[i] = 800 + spread;
+    }
+}
+
+BenchResult run(const int* elos, int count, bool batch) {
+    GameRegistry games;
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+
+    const int gameId = 0;
+    char name[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "player_%d", i);
+        store.create(i + 1, name, elos[i]);
+        matchmaker.joinQueue(i + 1, gameId);
+    }
+
+    long long start = Clock::monotonicNanos();
+    int pairs = 0;
+    if (batch) {
+        pairs = matchmaker.processMatchmaking(gameId);
+    } else {
+        while (matchmaker.getQueueSize(gameId) >= 2 && matchmaker.tryCreateMatch(gameId) != -1) {
+            pairs++;
+        }
+    }
+    long long elapsed = Clock::monotonicNanos() - start;
+
+    BenchResult result;
+    result.pairs = pairs;
+    result.seconds = static_cast<double>(elapsed) / Clock::NANOS_PER_SECOND;
+    result.maxGap = 0;
+
+    long long totalGap = 0;
+    for (int sequence = 1; sequence <= pairs; sequence++) {
+        Match match;
+        if (!matchmaker.getMatch((sequence << MatchmakingShard::MATCH_SHARD_BITS) | gameId, match)) continue;
+        int gap = elos[match.player1Id - 1] - elos[match.player2Id - 1];
+        if (gap < 0) gap = -gap;
+        totalGap += gap;
+        if (gap > result.maxGap) result.maxGap = gap;
+    }
+    result.averageGap = pairs > 0 ? static_cast<double>(totalGap) / pairs : 0.0;
+    return result;
+}
+
+// Closest-free-bot lookups against a pool of botCount bots
+void benchBotPick(int botCount, int lookups, unsigned seed) {
+    GameRegistry games;
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+
+    const int gameId = 0;
+    srand(seed);
+    char name[32];
+    for (int i = 0; i < botCount; i++) {
+        snprintf(name, sizeof(name), "BOT_%d", i + 1);
+        store.create(i + 1, name, 600 + rand() % 1801, true);
+        matchmaker.registerBot(i + 1, gameId);
+    }
+
+    // Occupy every other bot in a match so lookups must skip busy ones
+    // (one opponent per match - a player is only ever in one match)
+    for (int i = 0; i < botCount; i += 2) {
+        int opponentId = botCount + 1 + i / 2;
+        snprintf(name, sizeof(name), "opponent_%d", i / 2);
+        store.create(opponentId, name, 1200);
+        matchmaker.createMatchBetween(opponentId, i + 1, gameId);
+    }
+    
+    const int humanId = botCount + 1 + botCount;
+    store.create(humanId, "human", 1200);
+
+    long long start = Clock::monotonicNanos();
+    long long checksum = 0;
+    for (int i = 0; i < lookups; i++) {
+        checksum += matchmaker.findClosestBotOpponent(humanId, 600 + rand() % 1801, gameId);
+    }
+    double seconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+
+    printf("bot pick lookups: %8d   bots: %6d   time: %9.3f ms   lookups/sec: %12.0f   (checksum %lld)\n",
+           lookups, botCount, seconds * 1000.0, seconds > 0 ? lookups / seconds : 0.0, checksum);
+}
+
+// One batch tick over gameCount queues: serially, then one thread per shard
+void benchShards(const int* elos, int perGame, int gameCount) {
+    double seconds[2];
+    int pairs[2];
+    
+    for (int parallel = 0; parallel < 2; parallel++) {
+        std::string gameList;
+        for (int g = 0; g < gameCount; g++) {
+            if (g > 0) gameList += ",";
+            gameList += "game" + std::to_string(g);
+        }
+        GameRegistry games;
+        games.configure(gameList.c_str());
+        PlayerStore store;
+        store.setGameCount(games.size());
+        RankingService ranking(&store, &games);
+        HistoryService history;
+        Matchmaker matchmaker(&store, &ranking, &history, &games);
+        matchmaker.setLogging(false);
+        
+        char name[32];
+        for (int g = 0; g < gameCount; g++) {
+            for (int i = 0; i < perGame; i++) {
+                int playerId = g * perGame + i + 1;
+                snprintf(name, sizeof(name), "player_%d", playerId);
+                store.create(playerId, name, elos[i]);
+                matchmaker.joinQueue(playerId, g);
+            }
+        }
+        
+        int created[GameRegistry::MAX_GAMES] = {0};
+        long long start = Clock::monotonicNanos();
+        if (parallel) {
+            std::thread workers[GameRegistry::MAX_GAMES];
+            for (int g = 0; g < gameCount; g++) {
+                workers[g] = std::thread([&matchmaker, &created, g]() {
+                    created[g] = matchmaker.processMatchmaking(g);
+                });
+            }
+            for (int g = 0; g < gameCount; g++) {
+                workers[g].join();
+            }
+        } else {
+            for (int g = 0; g < gameCount; g++) {
+                created[g] = matchmaker.processMatchmaking(g);
+            }
+        }
+        seconds[parallel] = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+        
+        pairs[parallel] = 0;
+        for (int g = 0; g < gameCount; g++) {
+            pairs[parallel] += created[g];
+        }
+    }
+    
+    printf("shards   games: %2d   serial: %9.3f ms   parallel: %9.3f ms   speedup: %5.2fx   (pairs %d / %d, %u hw threads)\n",
+           gameCount, seconds[0] * 1000.0, seconds[1] * 1000.0,
+           seconds[1] > 0 ? seconds[0] / seconds[1] : 0.0, pairs[0], pairs[1],
+           std::thread::hardware_concurrency());
+}
+
+// One batch tick of an NvN game over a queue of count players
+void benchTeams(const int* elos, int count, int teamSize) {
+    std::string gameList = "team:" + std::to_string(teamSize);
+    GameRegistry games;
+    games.configure(gameList.c_str());
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+    
+    const int gameId = 0;
+    char name[32];
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "player_%d", i);
+        store.create(i + 1, name, elos[i]);
+        matchmaker.joinQueue(i + 1, gameId);
+    }
+    
+    long long start = Clock::monotonicNanos();
+    int matches = matchmaker.processMatchmaking(gameId);
+    double seconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    
+    double totalGap = 0.0;
+    long long totalSpread = 0;
+    for (int sequence = 1; sequence <= matches; sequence++) {
+        Match match;
+        if (!matchmaker.getMatch((sequence << MatchmakingShard::MATCH_SHARD_BITS) | gameId, match)) continue;
+        long long sums[2] = {0, 0};
+        int low = elos[match.team1[0] - 1];
+        int high = low;
+        for (int i = 0; i < match.teamSize; i++) {
+            int elo1 = elos[match.team1[i] - 1];
+            int elo2 = elos[match.team2[i] - 1];
+            sums[0] += elo1;
+            sums[1] += elo2;
+            low = elo1 < low ? elo1 : low;
+            low = elo2 < low ? elo2 : low;
+            high = elo1 > high ? elo1 : high;
+            high = elo2 > high ? elo2 : high;
+        }
+        double gap = static_cast<double>(sums[0] - sums[1]) / match.teamSize;
+        totalGap += gap < 0 ? -gap : gap;
+        totalSpread += high - low;
+    }
+    
+    printf("teams %dv%d queued: %8d   matches: %7d   time: %9.3f ms   matches/sec: %10.0f   avg team gap: %6.2f   avg spread: %6.1f\n",
+           teamSize, teamSize, count, matches, seconds * 1000.0, seconds > 0 ? matches / seconds : 0.0,
+           matches > 0 ? totalGap / matches : 0.0, matches > 0 ? static_cast<double>(totalSpread) / matches : 0.0);
+}
+
+// TeamBalancer heuristic vs. exact search on random groups of 2N players
+void benchBalancer(int teamSize, int groups, unsigned seed) {
+    srand(seed);
+    int count = 2 * teamSize;
+    int* elos = new int[groups * count];
+    for (int i = 0; i < groups * count; i++) {
+        elos[i] = 800 + rand() % 1201;
+    }
+    
+    int side[2 * TeamBalancer::MAX_TEAM_SIZE];
+    double seconds[2];
+    long long totalGap[2];
+    long long* gaps = new long long[groups];
+    int optimal = 0;
+    for (int exact = 0; exact < 2; exact++) {
+        totalGap[exact] = 0;
+        long long start = Clock::monotonicNanos();
+        for (int g = 0; g < groups; g++) {
+            const int* group = elos + g * count;
+            long long gap = exact ? TeamBalancer::splitExact(group, teamSize, side)
+                                  : TeamBalancer::splitGreedy(group, teamSize, side);
+            totalGap[exact] += gap;
+            if (!exact) gaps[g] = gap;
+            else if (gaps[g] == gap) optimal++;
+        }
+        seconds[exact] = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    }
+    
+    printf("balance %dv%d   heuristic: %10.0f splits/sec avg gap %6.1f   exact: %10.0f splits/sec avg gap %6.1f   heuristic optimal: %5.1f%%\n",
+           teamSize, teamSize,
+           seconds[0] > 0 ? groups / seconds[0] : 0.0, static_cast<double>(totalGap[0]) / groups,
+           seconds[1] > 0 ? groups / seconds[1] : 0.0, static_cast<double>(totalGap[1]) / groups,
+           100.0 * optimal / groups);
+    delete[] gaps;
+    delete[] elos;
+}
+
+// Nearest compatible candidate: CandidateIndex vs. scanning every candidate
+void benchCandidates(const int* elos, int count, int queries, unsigned seed) {
+    static const int REGION_PING_MS[4] = {20, 70, 130, 220};
+    srand(seed);
+    MatchAttributes* attributes = new MatchAttributes[count];
+    for (int i = 0; i < count; i++) {
+        int ping = REGION_PING_MS[rand() % 4] + rand() % 40;
+        int roll = rand() % 100;
+        int device = roll < 50 ? MatchAttributes::KEYBOARD_MOUSE
+                   : roll < 85 ? MatchAttributes::CONTROLLER : MatchAttributes::TOUCH;
+        attributes[i] = MatchAttributes(MatchAttributes::bucketForPing(ping), device);
+    }
+    
+    CandidateIndex index;
+    for (int i = 0; i < count; i++) {
+        index.insert(i + 1, elos[i], attributes[i]);
+    }
+    
+    const int window = 300;
+    int* probes = new int[queries];
+    for (int q = 0; q < queries; q++) {
+        probes[q] = rand() % count;
+    }
+    
+    // Indexed search
+    long long start = Clock::monotonicNanos();
+    int found = 0;
+    long long totalCost = 0;
+    int* indexCosts = new int[queries];
+    for (int q = 0; q < queries; q++) {
+        int p = probes[q];
+        int cost = 0;
+        int match = index.findNearest(p + 1, elos[p], attributes[p], window, [](int) { return true; }, &cost);
+        indexCosts[q] = match == -1 ? -1 : cost;
+        if (match != -1) {
+            found++;
+            totalCost += cost;
+        }
+    }
+    double indexSeconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    
+    // Linear scan over every candidate (fewer queries - it is O(n) each)
+    int scanQueries = queries < 1000 ? queries : 1000;
+    int agree = 0;
+    start = Clock::monotonicNanos();
+    for (int q = 0; q < scanQueries; q++) {
+        int p = probes[q];
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (i == p) continue;
+            int penalty = CandidateIndex::penalty(attributes[p], attributes[i]);
+            if (penalty == CandidateIndex::INCOMPATIBLE) continue;
+            int gap = elos[i] > elos[p] ? elos[i] - elos[p] : elos[p] - elos[i];
+            int cost = gap + penalty;
+            if (cost <= window && (best == -1 || cost < best)) best = cost;
+        }
+        if (best == indexCosts[q]) agree++;
+    }
+    double scanSeconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    
+    printf("candidates: %8d   index: %10.0f queries/sec (found %5.1f%%, avg cost %6.2f)   scan: %8.0f queries/sec   same cost: %d/%d\n",
+           count, indexSeconds > 0 ? queries / indexSeconds : 0.0, 100.0 * found / queries,
+           found > 0 ? static_cast<double>(totalCost) / found : 0.0,
+           scanSeconds > 0 ? scanQueries / scanSeconds : 0.0, agree, scanQueries);
+    
+    delete[] indexCosts;
+    delete[] probes;
+    delete[] attributes;
+}
+
+// Ratings, records and ranking sizes folded into one number
+long long stateChecksum(PlayerStore& store, RankingService& ranking, int gameCount) {
+    long long sum = 0;
+    for (int i = 0; i < store.size(); i++) {
+        const Player& profile = store.getProfile(i);
+        sum = sum * 31 + store.getId(i) + profile.wins * 7 + profile.losses * 13;
+        for (int g = 0; g < gameCount; g++) sum = sum * 31 + store.getElo(i, g);
+        PlayerState::Word state = store.getState(i);  // Queue handles are not durable, status and match are
+        sum = sum * 31 + PlayerState::status(state) * 1000003LL + PlayerState::matchId(state);
+    }
+    for (int g = 0; g < gameCount; g++) {
+        sum = sum * 31 + static_cast<long long>(ranking.getRankingCount(g));
+        ranking.forEachRanked(g, [&sum](const PlayerELO& entry) { sum = sum * 31 + entry.playerId; });
+    }
+    return sum;
+}
+
+// Snapshot + log of `count` players, then a full restore into fresh services
+void benchRestore(int count, int gameCount, unsigned seed) {
+    const std::string dir = "matchmaking_bench_state";
+    std::string gameList;
+    for (int g = 0; g < gameCount; g++) {
+        if (g > 0) gameList += ",";
+        gameList += "game" + std::to_string(g);
+    }
+    int* elos = new int[count];
+    int operations = count / 4 < 100000 ? count / 4 : 100000;  // Matches played after the snapshot
+    long long checksum = 0;
+    long long snapshotBytes = 0, snapshotNanos = 0, lockedNanos = 0, buildNanos = 0;
+    long long records = 0, commits = 0;
+
+    {
+        GameRegistry games;
+        games.configure(gameList.c_str());
+        PlayerStore store;
+        store.setGameCount(games.size());
+        RankingService ranking(&store, &games);
+        HistoryService history;
+        Matchmaker matchmaker(&store, &ranking, &history, &games);
+        matchmaker.setLogging(false);
+        StateLog log;
+        Persistence persistence(&store, &ranking, &history, &matchmaker, &games, &log);
+        persistence.restore(dir);
+
+        long long start = Clock::monotonicNanos();
+        char name[32];
+        for (int i = 0; i < count; i++) {
+            snprintf(name, sizeof(name), "player_%d", i + 1);
+            store.create(i + 1, name);
+        }
+        for (int g = 0; g < gameCount; g++) {
+            generateElos(elos, count, seed + g);
+            for (int i = 0; i < count; i++) {
+                store.setElo(i, g, elos[i]);
+                ranking.insertRanking(i, g);
+            }
+        }
+        buildNanos = Clock::monotonicNanos() - start;
+
+        persistence.start();
+        snapshotBytes = persistence.getLastSnapshotBytes();
+        snapshotNanos = persistence.getLastSnapshotNanos();
+        lockedNanos = persistence.getLastSnapshotLockedNanos();
+
+        // Logged traffic: queue both, pair them (leaving the ranking tree as
+        // tryCreateMatch does), report a result (a tenth left in progress)
+        for (int m = 0; m < operations; m++) {
+            int game = m % gameCount;
+            int a = (m * 2) % count + 1;
+            int b = (m * 2 + 1) % count + 1;
+            matchmaker.joinQueue(a, game);
+            matchmaker.joinQueue(b, game);
+            ranking.removeRanking(store.indexOf(a), game);
+            ranking.removeRanking(store.indexOf(b), game);
+            int matchId = matchmaker.createMatchBetween(a, b, game);
+            if (matchId != -1 && m % 10 != 0) matchmaker.submitMatchResult(matchId, m % 3 == 0 ? b : a);
+        }
+        log.sync();
+        records = log.getAppendedCount();
+        commits = log.getCommitCount();
+        checksum = stateChecksum(store, ranking, gameCount);
+        persistence.stop();
+    }
+
+    GameRegistry games;
+    games.configure(gameList.c_str());
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+    StateLog log;
+    Persistence persistence(&store, &ranking, &history, &matchmaker, &games, &log);
+
+    long long start = Clock::monotonicNanos();
+    persistence.restore(dir);
+    double restoreSeconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    const Persistence::RestoreStats& restored = persistence.getRestoreStats();
+    bool same = stateChecksum(store, ranking, gameCount) == checksum;
+
+    printf("restore  players: %d x %d games   build: %7.0f ms   snapshot: %6.1f MB in %6.0f ms (%4.0f ms locked)\n",
+           count, gameCount, buildNanos / 1e6, snapshotBytes / 1048576.0, snapshotNanos / 1e6, lockedNanos / 1e6);
+    printf("restore  log: %lld records, %lld commits (%.0f per commit)   restore: %6.3f s (players ready %5.1f ms, snapshot %6.0f ms + replay %6.0f ms, %d failed)   state %s\n",
+           records, commits, commits > 0 ? static_cast<double>(records) / commits : 0.0, restoreSeconds,
+           restored.playersNanos / 1e6, restored.snapshotNanos / 1e6, restored.replayNanos / 1e6, restored.failedRecords,
+           same ? "identical" : "DIFFERS");
+
+    for (long long g = 0; g <= restored.segments + 1; g++) remove(StateLog::segmentPath(dir, g).c_str());
+    for (long long g = 0; g <= restored.segments + 1; g++) {
+        remove((dir + "/players-" + std::to_string(g) + ".img").c_str());
+    }
+    remove((dir + "/snapshot.bin").c_str());
+    remove(dir.c_str());
+    delete[] elos;
+}
+
+// A 2v2 team match under Glicko-2: the result only buffers ratings, and
+// every member must still be back on the leaderboard afterwards
+bool checkGlickoTeamRanking() {
+    GameRegistry games;
+    games.configure("arena:2");
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    ranking.setRatingSystem(RankingService::GLICKO2);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+
+    char name[32];
+    for (int id = 1; id <= 4; id++) {
+        snprintf(name, sizeof(name), "player_%d", id);
+        store.create(id, name, 1000 + id);
+        matchmaker.joinQueue(id, 0);
+    }
+    bool ok = matchmaker.processMatchmaking(0) == 1 && ranking.getRankingCount(0) == 0;
+    int matchId = matchmaker.getPlayerActiveMatch(1);
+    ok = ok && matchmaker.submitMatchResult(matchId, 1);
+    size_t afterResult = ranking.getRankingCount(0);
+    matchmaker.closeRatingPeriod();
+    size_t afterPeriod = ranking.getRankingCount(0);
+    ok = ok && afterResult == 4 && afterPeriod == 4 && ranking.getPercentile(0, 5000) == 100.0;
+    printf("ranking  glicko2 2v2 result: %s\n", ok ? "all members ranked" : "FAILED");
+    return ok;
+}
+
+// A result in one game changes the player's win/loss counts, which every
+// game's leaderboard shows: the other game's version must move too
+bool checkLeaderboardVersions() {
+    GameRegistry games;
+    games.configure("first,second");
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+
+    store.create(1, "player_1", 1000);
+    store.create(2, "player_2", 1000);
+    ranking.addPlayerToRanking(1, 0);
+    bool ok = matchmaker.joinQueue(1, 1) && matchmaker.joinQueue(2, 1) && matchmaker.processMatchmaking(1) == 1;
+    long long before = ranking.getLeaderboardVersion(0);
+    ok = ok && matchmaker.submitMatchResult(matchmaker.getPlayerActiveMatch(1), 1);
+    ok = ok && ranking.getLeaderboardVersion(0) != before;
+    printf("ranking  result in another game: %s\n", ok ? "leaderboard version moved" : "FAILED");
+    return ok;
+}
+
+// Every match of a team game has the registered team size per side, and a
+// party is only queued if it is exactly one team
+bool checkTeamSizes() {
+    GameRegistry games;
+    games.configure("duel,arena:2");
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+
+    struct Sizes { int matches; int wrong; } sizes = {0, 0};
+    matchmaker.setMatchListener([](const Match& match, void* context) {
+        Sizes* seen = static_cast<Sizes*>(context);
+        seen->matches++;
+        if (match.teamSize != 2) seen->wrong++;
+    }, &sizes);
+
+    char name[32];
+    for (int id = 1; id <= 11; id++) {
+        snprintf(name, sizeof(name), "player_%d", id);
+        store.create(id, name, 1000 + id);
+    }
+    int duo[2] = {1, 2};
+    int trio[3] = {1, 2, 3};
+    bool ok = !matchmaker.joinPartyQueue(duo, 2, 0) && !matchmaker.joinPartyQueue(trio, 3, 1);
+    int second[2] = {3, 4};
+    ok = ok && matchmaker.joinPartyQueue(duo, 2, 1) && matchmaker.joinPartyQueue(second, 2, 1);
+    for (int id = 5; id <= 8; id++) ok = ok && matchmaker.joinQueue(id, 1);
+    matchmaker.processMatchmaking(1);
+    ok = ok && sizes.matches == 2 && sizes.wrong == 0 && matchmaker.getQueueSize(1) == 0;
+    printf("teams    2v2 parties and solos: %s\n", ok ? "every match 2 per side" : "FAILED");
+    return ok;
+}
+
+// Replay of a MATCH record that takes only part of a queued party: the
+// members left out must end up idle (not queued in a party that is gone)
+bool checkPartialPartyReplay() {
+    const std::string dir = "matchmaking_bench_party";
+    {
+        StateLog log;
+        log.open(dir, 0);
+        log.playerCreated(1, "leader", 1000, false);
+        log.playerCreated(2, "member", 1000, false);
+        log.playerCreated(3, "solo_3", 1000, false);
+        log.playerCreated(4, "solo_4", 1000, false);
+        log.playerCreated(5, "solo_5", 1000, false);
+        int party[2] = {1, 2};
+        log.partyQueued(party, 2, 0);
+        int first[2] = {1, 3};
+        int second[2] = {4, 5};
+        Match match((1 << MatchmakingShard::MATCH_SHARD_BITS) | 0, 1, 4, 0, 0);
+        match.setTeams(first, second, 2);
+        log.matchCreated(match);
+        log.close();
+    }
+
+    GameRegistry games;
+    games.configure("arena:2");
+    PlayerStore store;
+    store.setGameCount(games.size());
+    RankingService ranking(&store, &games);
+    HistoryService history;
+    Matchmaker matchmaker(&store, &ranking, &history, &games);
+    matchmaker.setLogging(false);
+    StateLog log;
+    Persistence persistence(&store, &ranking, &history, &matchmaker, &games, &log);
+    persistence.restore(dir);
+
+    bool ok = persistence.getRestoreStats().failedRecords == 0 &&
+              matchmaker.isPlayerInMatch(1) && matchmaker.isPlayerInMatch(3) && matchmaker.isPlayerInMatch(5) &&
+              !matchmaker.isPlayerInMatch(2) && !matchmaker.isPlayerInQueue(2) &&
+              matchmaker.getQueueSize(0) == 0 &&
+              matchmaker.joinQueue(2, 0) && matchmaker.getQueueSize(0) == 1;
+    printf("replay   party of 2, one member matched: %s\n", ok ? "other member idle, queue empty" : "FAILED");
+
+    remove(StateLog::segmentPath(dir, 0).c_str());
+    remove(dir.c_str());
+    return ok;
+}
+
+// Time to ready for perGame bots in every game: one create / registerBot /
+// addPlayerToRanking per bot (as initializeBots did) vs. BulkLoader
+void benchStartup(int perGame, int gameCount, unsigned seed) {
+    std::string gameList;
+    for (int g = 0; g < gameCount; g++) {
+        if (g > 0) gameList += ",";
+        gameList += "game" + std::to_string(g);
+    }
+    int total = perGame * gameCount;
+    int* elos = new int[total];
+    srand(seed);
+    for (int i = 0; i < total; i++) elos[i] = 800 + rand() % 801;
+
+    long long nanos[2] = {0, 0};
+    long long checksums[2] = {0, 0};
+    int threads = 0;
+    for (int bulk = 0; bulk < 2; bulk++) {
+        GameRegistry games;
+        games.configure(gameList.c_str());
+        PlayerStore store;
+        store.setGameCount(games.size());
+        RankingService ranking(&store, &games);
+        HistoryService history;
+        Matchmaker matchmaker(&store, &ranking, &history, &games);
+        BulkLoader loader(&store, &ranking, &matchmaker, &games);
+
+        long long start = Clock::monotonicNanos();
+        char name[32];
+        for (int g = 0; g < gameCount; g++) {
+            for (int i = 0; i < perGame; i++) {
+                int botId = 1000 + g * perGame + i;
+                snprintf(name, sizeof(name), "BOT_%d", g * perGame + i + 1);
+                if (bulk) {
+                    loader.addBot(botId, name, elos[g * perGame + i], g);
+                } else {
+                    int index = store.create(botId, name, elos[g * perGame + i], true);
+                    store.getProfile(index).setPreferredGame(g);
+                    matchmaker.registerBot(botId, g);
+                    ranking.addPlayerToRanking(botId, g);
+                }
+            }
+        }
+        if (bulk) {
+            loader.build();
+            threads = loader.getReport().threads;
+        }
+        nanos[bulk] = Clock::monotonicNanos() - start;
+
+        long long sum = 0;
+        for (int g = 0; g < gameCount; g++) {
+            sum = sum * 31 + matchmaker.getBotCount(g);
+            ranking.forEachRanked(g, [&sum](const PlayerELO& entry) { sum = sum * 31 + entry.playerId; });
+            sum = sum * 31 + static_cast<long long>(ranking.getPercentile(g, 1200) * 1000);
+        }
+        checksums[bulk] = sum;
+    }
+
+    printf("startup  bots: %d x %d games   one by one: %8.1f ms   bulk: %8.1f ms (%d threads)   speedup: %5.1fx   same state: %s\n",
+           perGame, gameCount, nanos[0] / 1e6, nanos[1] / 1e6, threads,
+           nanos[1] > 0 ? static_cast<double>(nanos[0]) / nanos[1] : 0.0,
+           checksums[0] == checksums[1] ? "yes" : "NO");
+    delete[] elos;
+}
+
+void report(const char* label, const BenchResult& result) {
+    double pairsPerSecond = result.seconds > 0 ? result.pairs / result.seconds : 0.0;
+    printf("%-8s pairs: %8d   time: %9.3f ms   pairs/sec: %12.0f   avg gap: %7.2f   max gap: %5d\n",
+           label, result.pairs, result.seconds * 1000.0, pairsPerSecond,
+           result.averageGap, result.maxGap);
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    unsigned seed = argc > 2 ? static_cast<unsigned>(atoi(argv[2])) : 42u;
+    int botCount = argc > 3 ? atoi(argv[3]) : 5000;
+    int gameCount = argc > 4 ? atoi(argv[4]) : 4;
+    int restoreCount = argc > 5 ? atoi(argv[5]) : 1000000;
+    if (count < 2) count = 2;
+    if (botCount < 1) botCount = 1;
+    if (gameCount < 1) gameCount = 1;
+    if (gameCount > GameRegistry::MAX_GAMES) gameCount = GameRegistry::MAX_GAMES;
+
+    int* elos = new int[count];
+    generateElos(elos, count, seed);
+
+    printf("Matchmaking benchmark: %d queued players, seed %u\n", count, seed);
+    report("greedy", run(elos, count, false));
+    report("batch", run(elos, count, true));
+    benchBotPick(botCount, 100000, seed);
+    benchShards(elos, count, gameCount);
+
+    // Team games at ten times the queue depth
+    int teamCount = count * 10;
+    int* teamElos = new int[teamCount];
+    generateElos(teamElos, teamCount, seed);
+    benchTeams(teamElos, teamCount, 2);
+    benchTeams(teamElos, teamCount, 5);
+    delete[] teamElos;
+    benchBalancer(2, 100000, seed);
+    benchBalancer(5, 100000, seed);
+    benchBalancer(8, 10000, seed);
+    benchCandidates(elos, count, 100000, seed);
+    bool checksPassed = checkPartialPartyReplay();
+    checksPassed = checkGlickoTeamRanking() && checksPassed;
+    checksPassed = checkLeaderboardVersions() && checksPassed;
+    checksPassed = checkTeamSizes() && checksPassed;
+    benchStartup(botCount * 20, gameCount, seed);
+    if (restoreCount > 0) benchRestore(restoreCount, gameCount < 3 ? gameCount : 3, seed);
+
+    delete[] elos;
+    return checksPassed ? 0 : 1;
+}
@@ -11,15 +11,35 @@
  * 
  * DSA PRESERVED:
  *   - AVLTree<PlayerELO>       : O(log n) closest-ELO matching
- *   - HashTable<int, Player>   : O(1) player storage
+ *   - PlayerStore              : O(1) hot/cold player storage
  *   - Queue<QueueEntry>        : O(1) FIFO matchmaking lobby
  *   - LinkedList<Match>        : O(1) match history
  * 
+ * MATCHING:
+ * QUEUE only places the player in the queue and answers QUEUED. Each
+ * game's shard is ticked on its own thread (MatchmakingTicker, every
+ * ARENA_TICK_MS, default 100ms), which pairs the queue and pushes MATCHED
+ * to the client of every human in a new match. Output lines are written
+ * whole under outputMutex, so they never interleave.
+ * QUEUE may carry "pingMs" and "device" ("keyboard", "controller",
+ * "touch"); they decide which opponents are compatible (CandidateIndex).
+ * QUEUE_PARTY {"playerIds":[leader, ...]} queues a pre-formed party as one
+ * entry; the party must be one whole team of a team game (as many players
+ * as the game's team size). It is matched against another party, and
+ * every member whose client has JOINed receives MATCHED.
+ * METRICS answers with each game's match-quality summary (queue wait and
+ * ELO gap percentiles, human vs. bot - see MatchTelemetry).
+ * 
  * BUILD:
- *   g++ -std=c++11 -O2 -o engine matchmaking_engine.cpp
+ *   g++ -std=c++11 -O2 -pthread -o engine matchmaking_engine.cpp
  * 
  * USAGE:
  *   ./engine           (reads from stdin, writes to stdout)
+ *   ARENA_GAMES=pingpong,snake,tank ./engine   (override the game list)
+ *   ARENA_TICK_MS=50 ./engine                  (matchmaking tick interval)
+ *   ARENA_SEED=42 ./engine                     (reproducible bot ratings)
+ *   ARENA_RATING=glicko2 ./engine              (Glicko-2 in rating periods of
+ *                                               ARENA_RATING_PERIOD_SECONDS, default 60)
  */
 
 #include "ds/HashTable.h"
@@ -28,9 +48,15 @@
 #include "ds/LinkedList.h"
 #include "models/Player.h"
 #include "models/Match.h"
+#include "models/Party.h"
+#include "services/PlayerStore.h"
+#include "services/GameRegistry.h"
 #include "services/RankingService.h"
 #include "services/HistoryService.h"
 #include "services/Matchmaker.h"
+#include "services/MatchmakingTicker.h"
+#include "services/BulkLoader.h"
+#include "services/Random.h"
 
 #include <iostream>
 #include <string>
@@ -38,6 +64,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <mutex>
 
 // ============== SIMPLE JSON PARSER ==============
 
@@ -96,36 +123,76 @@ int getJsonInt(const std::string& json, const std::string& key) {
     return 0;
 }
 
+/**
+ * Extract a flat integer array from JSON - returns count, or -1
+ * Example: getJsonIntArray("{\"ids\":[4,7]}", "ids", out, 4) -> 2
+ */
+int getJsonIntArray(const std::string& json, const std::string& key, int* out, int maxCount) {
+    std::string searchKey = "\"" + key + "\"";
+    size_t keyPos = json.find(searchKey);
+    if (keyPos == std::string::npos) return -1;
+    
+    size_t open = json.find('[', keyPos);
+    size_t close = json.find(']', keyPos);
+    if (open == std::string::npos || close == std::string::npos || close < open) return -1;
+    
+    int count = 0;
+    size_t pos = open + 1;
+    while (pos < close) {
+        while (pos < close && (json[pos] == ' ' || json[pos] == ',' || json[pos] == '\t')) pos++;
+        if (pos >= close) break;
+        if (count == maxCount) return -1;
+        
+        size_t end = pos;
+        while (end < close && json[end] >= '0' && json[end] <= '9') end++;
+        if (end == pos) return -1;
+        out[count++] = std::stoi(json.substr(pos, end - pos));
+        pos = end;
+    }
+    return count;
+}
+
 // ============== JSON OUTPUT HELPERS ==============
 
+// Shard tick threads publish MATCHED while the main thread answers
+// commands; each line is written whole under this lock
+std::mutex outputMutex;
+
 void outputJson(const std::string& json) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << json << std::endl;
     std::cout.flush();
 }
 
 void outputOk(const std::string& clientId, int playerId) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"OK\",\"clientId\":\"" << clientId 
               << "\",\"playerId\":" << playerId << "}" << std::endl;
     std::cout.flush();
 }
 
 void outputQueued(const std::string& clientId, int position) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"QUEUED\",\"clientId\":\"" << clientId 
               << "\",\"position\":" << position << "}" << std::endl;
     std::cout.flush();
 }
 
+// opponent is the pre-escaped interned username
 void outputMatched(const std::string& clientId, int matchId, 
-                   const std::string& opponent, int opponentElo, const std::string& game) {
+                   const char* opponent, size_t opponentLength, int opponentElo, const std::string& game) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"MATCHED\",\"clientId\":\"" << clientId 
               << "\",\"matchId\":" << matchId 
-              << ",\"opponent\":\"" << opponent 
-              << "\",\"opponentElo\":" << opponentElo 
+              << ",\"opponent\":\"";
+    std::cout.write(opponent, opponentLength);
+    std::cout << "\",\"opponentElo\":" << opponentElo 
               << ",\"game\":\"" << game << "\"}" << std::endl;
     std::cout.flush();
 }
 
 void outputStatus(const std::string& clientId, bool inQueue, bool inMatch, int matchId) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"STATUS\",\"clientId\":\"" << clientId 
               << "\",\"inQueue\":" << (inQueue ? "true" : "false")
               << ",\"inMatch\":" << (inMatch ? "true" : "false")
@@ -133,33 +200,55 @@ void outputStatus(const std::string& clientId, bool inQueue, bool inMatch, int m
     std::cout.flush();
 }
 
+// names are pre-escaped interned usernames
 void outputLeaderboard(const std::string& clientId, const std::string& game,
-                       int* playerIds, int* elos, const char** names, int count) {
+                       int* playerIds, int* elos, const char** names, const size_t* nameLengths, int count) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"LEADERBOARD\",\"clientId\":\"" << clientId 
               << "\",\"game\":\"" << game << "\",\"players\":[";
     for (int i = 0; i < count; i++) {
         if (i > 0) std::cout << ",";
         std::cout << "{\"rank\":" << (i+1) 
-                  << ",\"name\":\"" << names[i] 
-                  << "\",\"elo\":" << elos[i] << "}";
+                  << ",\"name\":\"";
+        std::cout.write(names[i], nameLengths[i]);
+        std::cout << "\",\"elo\":" << elos[i] << "}";
     }
     std::cout << "]}" << std::endl;
     std::cout.flush();
 }
 
+void outputStats(const std::string& clientId, int players, size_t activeMatches, size_t retiringMatches) {
+    std::lock_guard<std::mutex> guard(outputMutex);
+    std::cout << "{\"type\":\"STATS\",\"clientId\":\"" << clientId 
+              << "\",\"players\":" << players
+              << ",\"activeMatches\":" << activeMatches
+              << ",\"retiringMatches\":" << retiringMatches << "}" << std::endl;
+    std::cout.flush();
+}
+
+void outputMetrics(const std::string& clientId, const std::string& gamesJson) {
+    std::lock_guard<std::mutex> guard(outputMutex);
+    std::cout << "{\"type\":\"METRICS\",\"clientId\":\"" << clientId 
+              << "\",\"games\":[" << gamesJson << "]}" << std::endl;
+    std::cout.flush();
+}
+
 void outputResult(const std::string& clientId, int newElo) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"RESULT\",\"clientId\":\"" << clientId 
               << "\",\"newElo\":" << newElo << "}" << std::endl;
     std::cout.flush();
 }
 
 void outputError(const std::string& clientId, const std::string& message) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cout << "{\"type\":\"ERROR\",\"clientId\":\"" << clientId 
               << "\",\"message\":\"" << message << "\"}" << std::endl;
     std::cout.flush();
 }
 
 void outputLog(const std::string& message) {
+    std::lock_guard<std::mutex> guard(outputMutex);
     std::cerr << "[Engine] " << message << std::endl;
 }
 
@@ -167,7 +256,8 @@ void outputLog(const std::string& message) {
 
 class MatchmakingEngine {
 private:
-    HashTable<int, Player> playerStorage;
+    GameRegistry gameRegistry;
+    PlayerStore playerStore;
     RankingService rankingService;
     HistoryService historyService;
     Matchmaker matchmaker;
@@ -175,6 +265,12 @@ private:
     // Client ID -> Player ID mapping
     HashTable<int, int> clientToPlayer;  // hash of clientId -> playerId
     
+    // Player ID -> client ID, for pushing matches made by the tick threads
+    HashTable<int, std::string> playerToClient;
+    std::mutex clientsMutex;  // Guards playerToClient (taken last, held briefly)
+    
+    MatchmakingTicker ticker;
+    
     int nextPlayerId;
     static const int BOT_ID_START = 1000;
     
@@ -186,43 +282,120 @@ private:
         return hash < 0 ? -hash : hash;
     }
     
+    // Tell each human player's client about a new match (tick thread, shard lock held)
+    static void onMatchCreated(const Match& match, void* context) {
+        MatchmakingEngine* engine = static_cast<MatchmakingEngine*>(context);
+        // Party matches: every member, facing the other team's leader
+        for (int i = 0; i < match.teamSize; i++) {
+            engine->publishMatch(match.team1[i], match.player2Id, match);
+            engine->publishMatch(match.team2[i], match.player1Id, match);
+        }
+    }
+    
+    void publishMatch(int playerId, int opponentId, const Match& match) {
+        std::string clientId;
+        {
+            std::lock_guard<std::mutex> guard(clientsMutex);
+            std::string* found = playerToClient.get(playerId);
+            if (!found) return;
+            clientId = *found;
+        }
+        int opponent = playerStore.indexOf(opponentId);
+        if (opponent == PlayerStore::NO_PLAYER) return;
+        
+        const char* game = gameRegistry.getName(match.gameId);
+        outputLog("Match created: " + std::to_string(match.matchId) + " - player " +
+                  std::to_string(playerId) + " vs " + std::string(playerStore.getName(opponent)));
+        outputMatched(clientId, match.matchId, playerStore.getEscapedName(opponent),
+                      playerStore.getEscapedNameLength(opponent), playerStore.getElo(opponent, match.gameId),
+                      game ? game : "");
+    }
+    
 public:
     MatchmakingEngine() 
-        : rankingService(&playerStorage),
-          matchmaker(&playerStorage, &rankingService, &historyService),
-          nextPlayerId(1) {}
+        : rankingService(&playerStore, &gameRegistry),
+          matchmaker(&playerStore, &rankingService, &historyService, &gameRegistry),
+          ticker(&matchmaker, &gameRegistry),
+          nextPlayerId(1) {
+        // stdout carries the protocol; matches are logged by publishMatch()
+        matchmaker.setLogging(false);
+        matchmaker.setMatchListener(&MatchmakingEngine::onMatchCreated, this);
+    }
+    
+    // Start background matchmaking; tickNanos <= 0 keeps the default
+    void startMatchmaking(long long tickNanos) {
+        if (tickNanos > 0) ticker.setTickNanos(tickNanos);
+        ticker.start();
+        outputLog("Matchmaking tick: " + std::to_string(ticker.getTickNanos() / Clock::NANOS_PER_MILLI) + " ms (" +
+                  std::to_string(ticker.getThreadCount()) + " shard threads)");
+    }
+    
+    void stopMatchmaking() {
+        ticker.stop();
+    }
+    
+    // "glicko2" switches to Glicko-2 rating periods of periodSeconds (0 = default)
+    void configureRatings(const char* system, long long periodSeconds) {
+        if (strcmp(system, "glicko2") != 0) return;
+        rankingService.setRatingSystem(RankingService::GLICKO2);
+        if (periodSeconds > 0) matchmaker.setRatingPeriodNanos(periodSeconds * Clock::NANOS_PER_SECOND);
+        outputLog("Rating: Glicko-2, " + std::to_string(matchmaker.getRatingPeriodNanos() / Clock::NANOS_PER_SECOND) +
+                  " s rating periods");
+    }
+    
+    // Replace the game list (comma-separated); must run before initializeBots()
+    void configureGames(const char* gameList) {
+        if (gameRegistry.configure(gameList) == 0) {
+            gameRegistry.configure(GameRegistry::defaultGames());
+        }
+    }
     
     void initializeBots() {
-        srand(static_cast<unsigned>(time(NULL)));
+        playerStore.setGameCount(gameRegistry.size());  // One rating column per game
         
-        const char* games[] = {"pingpong", "snake", "tank"};
-        const int BOTS_PER_GAME = 5;
+        // ARENA_SEED fixes the bot ratings for reproducible runs (default: time)
+        Random rng(Random::seedFromEnvironment("ARENA_SEED"));
         
+        // Bots per game (ARENA_BOTS_PER_GAME overrides; pools have no size cap)
+        const char* botsOverride = getenv("ARENA_BOTS_PER_GAME");
+        const int BOTS_PER_GAME = botsOverride && atoi(botsOverride) > 0 ? atoi(botsOverride) : 5;
+        
+        // Bots are created first; each game's bot pool and ranking tree is
+        // then built in one pass, games in parallel
+        BulkLoader loader(&playerStore, &rankingService, &matchmaker, &gameRegistry);
         int botId = BOT_ID_START;
         
-        for (int g = 0; g < 3; g++) {
-            const char* game = games[g];
+        for (int game = 0; game < gameRegistry.size(); game++) {
+            int lowest = 0, highest = 0;
             
             for (int i = 0; i < BOTS_PER_GAME; i++) {
-                int elo = 800 + (rand() % 801);
+                int elo = rng.between(800, 1600);
                 
                 char botName[50];
                 snprintf(botName, sizeof(botName), "BOT_%d", botId - BOT_ID_START + 1);
                 
-                Player bot(botId, botName, elo, true);
-                bot.setPreferredGame(game);
-                playerStorage.insert(botId, bot);
-                
-                matchmaker.registerBot(botId, game);
-                rankingService.addPlayerToRanking(botId, game);
-                
-                outputLog(std::string("Created ") + botName + " (ELO: " + std::to_string(elo) + ") for " + game);
+                loader.addBot(botId, botName, elo, game);
+                if (i == 0 || elo < lowest) lowest = elo;
+                if (i == 0 || elo > highest) highest = elo;
                 botId++;
             }
+            outputLog("Created " + std::to_string(BOTS_PER_GAME) + " bots (ELO " + std::to_string(lowest) + "-" +
+                      std::to_string(highest) + ") for " + gameRegistry.getName(game));
         }
+        loader.build();
         
         nextPlayerId = botId + 1;
-        outputLog("Total bots created: " + std::to_string(botId - BOT_ID_START));
+        const BulkLoader::Report& report = loader.getReport();
+        char summary[160];
+        snprintf(summary, sizeof(summary), "Total bots created: %d (pools and ranking trees built on %d threads, ready in %.1f ms)",
+                 report.bots, report.threads, report.readyNanos() / 1e6);
+        outputLog(summary);
+    }
+    
+    // Remember which client to push a player's matches to
+    void bindClient(int playerId, const std::string& clientId) {
+        std::lock_guard<std::mutex> guard(clientsMutex);
+        playerToClient.insert(playerId, clientId);
     }
     
     // ========== COMMAND HANDLERS ==========
@@ -233,128 +406,132 @@ public:
         int* existingId = clientToPlayer.get(clientHash);
         if (existingId) {
             // Return existing player
-            Player* p = playerStorage.get(*existingId);
-            if (p) {
+            if (playerStore.contains(*existingId)) {
+                bindClient(*existingId, clientId);
                 outputOk(clientId, *existingId);
                 return;
             }
         }
         
-        // Check if username exists
-        int existingKeys[2000];
-        size_t keyCount;
-        playerStorage.getAllKeys(existingKeys, keyCount);
-        
-        for (size_t i = 0; i < keyCount; i++) {
-            Player* existing = playerStorage.get(existingKeys[i]);
-            if (existing && strcmp(existing->username, username.c_str()) == 0) {
-                clientToPlayer.insert(clientHash, existing->id);
-                outputOk(clientId, existing->id);
-                return;
-            }
+        // Check if username exists (interned name lookup)
+        int existing = playerStore.findByName(username.c_str());
+        if (existing != PlayerStore::NO_PLAYER) {
+            int existingId = playerStore.getId(existing);
+            clientToPlayer.insert(clientHash, existingId);
+            bindClient(existingId, clientId);
+            outputOk(clientId, existingId);
+            return;
         }
         
-        // Create new player
+        // Create new player (player indexes are shared by every shard thread)
         int playerId = nextPlayerId++;
-        Player player(playerId, username.c_str(), elo, false);
-        playerStorage.insert(playerId, player);
+        {
+            Matchmaker::ExclusiveLock exclusive(matchmaker);
+            playerStore.create(playerId, username.c_str(), elo, false);
+        }
         clientToPlayer.insert(clientHash, playerId);
+        bindClient(playerId, clientId);
         
         outputLog("Player joined: " + username + " (ID: " + std::to_string(playerId) + ")");
         outputOk(clientId, playerId);
     }
     
-    void handleQueue(const std::string& clientId, int playerId, const std::string& game) {
-        Player* player = playerStorage.get(playerId);
-        if (!player) {
+    void handleQueue(const std::string& clientId, int playerId, const std::string& game,
+                     const MatchAttributes& attributes) {
+        int index = playerStore.indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) {
             outputError(clientId, "Player not found");
             return;
         }
         
-        if (player->isInQueue) {
+        if (playerStore.isInQueue(index)) {
             outputError(clientId, "Already in queue");
             return;
         }
         
-        if (player->isInMatch) {
+        if (playerStore.isInMatch(index)) {
             outputError(clientId, "Already in match");
             return;
         }
         
-        if (!matchmaker.joinQueue(playerId, game.c_str())) {
-            outputError(clientId, "Failed to join queue");
+        int gameId = gameRegistry.getId(game.c_str());
+        if (gameId == GameRegistry::NO_GAME) {
+            outputError(clientId, "Unknown game");
             return;
         }
         
-        // Refresh player pointer (may have changed)
-        player = playerStorage.get(playerId);
-        
-        int position = static_cast<int>(matchmaker.getQueueSize(game.c_str()));
-        outputLog("Player " + std::to_string(playerId) + " queued for " + game + " (position: " + std::to_string(position) + ")");
-        
-        // Try to create a match immediately
-        Match match;
-        int matchId = matchmaker.tryCreateMatch(game.c_str());
+        // Bind first so the game's tick can push MATCHED to this client;
+        // QUEUED is written under the shard lock, so it always comes first
+        bindClient(playerId, clientId);
+        bool queued = matchmaker.joinQueue(playerId, gameId, attributes, [&](size_t queueSize) {
+            int position = static_cast<int>(queueSize);
+            outputLog("Player " + std::to_string(playerId) + " queued for " + game + " (position: " + std::to_string(position) + ")");
+            outputQueued(clientId, position);
+        });
+        if (!queued) {
+            outputError(clientId, "Failed to join queue");
+        }
+    }
+    
+    void handleQueueParty(const std::string& clientId, const int* memberIds, int count, const std::string& game) {
+        if (count < 2 || count > Party::MAX_SIZE) {
+            outputError(clientId, "Party needs 2-4 players");
+            return;
+        }
         
-        if (matchId != -1) {
-            Match* m = matchmaker.getMatch(matchId);
-            if (m) {
-                int opponentId = (m->player1Id == playerId) ? m->player2Id : m->player1Id;
-                Player* opponent = playerStorage.get(opponentId);
-                
-                if (opponent) {
-                    outputLog("Match created: " + std::to_string(matchId) + " - " + 
-                              std::string(player->username) + " vs " + std::string(opponent->username));
-                    outputMatched(clientId, matchId, opponent->username, opponent->elo, game);
-                    return;
-                }
-            }
+        int gameId = gameRegistry.getId(game.c_str());
+        if (gameId == GameRegistry::NO_GAME) {
+            outputError(clientId, "Unknown game");
+            return;
+        }
+        if (count != gameRegistry.getTeamSize(gameId)) {
+            outputError(clientId, "Party size must equal the game's team size (" +
+                        std::to_string(gameRegistry.getTeamSize(gameId)) + ")");
+            return;
         }
         
-        // No immediate match - still queued
-        outputQueued(clientId, position);
+        // Members are already bound to their own clients by JOIN
+        bool queued = matchmaker.joinPartyQueue(memberIds, count, gameId, [&](size_t queueSize) {
+            int position = static_cast<int>(queueSize);
+            outputLog("Party of " + std::to_string(count) + " led by " + std::to_string(memberIds[0]) +
+                      " queued for " + game + " (position: " + std::to_string(position) + ")");
+            outputQueued(clientId, position);
+        });
+        if (!queued) {
+            outputError(clientId, "Failed to queue party");
+        }
     }
     
     void handleLeave(const std::string& clientId, int playerId) {
-        Player* player = playerStorage.get(playerId);
-        if (!player) {
+        int index = playerStore.indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) {
             outputError(clientId, "Player not found");
             return;
         }
         
-        if (!player->isInQueue) {
+        if (!playerStore.isInQueue(index)) {
             outputError(clientId, "Not in queue");
             return;
         }
         
-        // Leave all queues
-        const char* games[] = {"pingpong", "snake", "tank"};
-        bool left = false;
-        for (int i = 0; i < 3; i++) {
-            if (matchmaker.leaveQueue(playerId, games[i])) {
-                left = true;
-                break;
-            }
-        }
-        
-        if (left) {
+        // Leave whichever queue the player is in
+        if (matchmaker.leaveCurrentQueue(playerId)) {
             outputLog("Player " + std::to_string(playerId) + " left queue");
-            std::cout << "{\"type\":\"OK\",\"clientId\":\"" << clientId << "\"}" << std::endl;
-            std::cout.flush();
+            outputJson("{\"type\":\"OK\",\"clientId\":\"" + clientId + "\"}");
         } else {
             outputError(clientId, "Failed to leave queue");
         }
     }
     
     void handleStatus(const std::string& clientId, int playerId) {
-        Player* player = playerStorage.get(playerId);
-        if (!player) {
+        int index = playerStore.indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) {
             outputError(clientId, "Player not found");
             return;
         }
         
         int activeMatchId = matchmaker.getPlayerActiveMatch(playerId);
-        outputStatus(clientId, player->isInQueue, player->isInMatch, activeMatchId);
+        outputStatus(clientId, playerStore.isInQueue(index), playerStore.isInMatch(index), activeMatchId);
     }
     
     void handleResult(const std::string& clientId, int matchId, int winnerId) {
@@ -363,8 +540,10 @@ public:
             return;
         }
         
-        Player* winner = playerStorage.get(winnerId);
-        int newElo = winner ? winner->elo : 0;
+        // New rating in the game the match was played in
+        int winner = playerStore.indexOf(winnerId);
+        int gameId = MatchmakingShard::shardOfMatch(matchId);
+        int newElo = winner != PlayerStore::NO_PLAYER ? playerStore.getElo(winner, gameId) : 0;
         
         outputLog("Match " + std::to_string(matchId) + " result: Winner ID " + std::to_string(winnerId));
         outputResult(clientId, newElo);
@@ -373,15 +552,38 @@ public:
     void handleLeaderboard(const std::string& clientId, const std::string& game) {
         int playerIds[20], elos[20];
         const char* names[20];
+        size_t nameLengths[20];
         
-        int count = rankingService.getLeaderboard(game.c_str(), playerIds, elos, 20);
+        int gameId = gameRegistry.getId(game.c_str());
+        int count;
+        {
+            // The game's ranking tree belongs to its shard
+            Matchmaker::ShardLock lock(matchmaker, gameId);
+            count = rankingService.getLeaderboard(gameId, playerIds, elos, 20);
+        }
         
         for (int i = 0; i < count; i++) {
-            Player* p = playerStorage.get(playerIds[i]);
-            names[i] = p ? p->username : "Unknown";
+            int p = playerStore.indexOf(playerIds[i]);
+            names[i] = p != PlayerStore::NO_PLAYER ? playerStore.getEscapedName(p) : "Unknown";
+            nameLengths[i] = p != PlayerStore::NO_PLAYER ? playerStore.getEscapedNameLength(p) : 7;
         }
         
-        outputLeaderboard(clientId, game, playerIds, elos, names, count);
+        outputLeaderboard(clientId, game, playerIds, elos, names, nameLengths, count);
+    }
+    
+    void handleStats(const std::string& clientId) {
+        outputStats(clientId, playerStore.size(), matchmaker.getActiveMatchCount(),
+                    matchmaker.getRetiringMatchCount());
+    }
+    
+    // Match-quality histograms per game (lock-free reads)
+    void handleMetrics(const std::string& clientId) {
+        std::string gamesJson;
+        for (int game = 0; game < gameRegistry.size(); game++) {
+            if (game > 0) gamesJson += ",";
+            gamesJson += matchmaker.getTelemetry(game)->toJson(gameRegistry.getName(game));
+        }
+        outputMetrics(clientId, gamesJson);
     }
     
     void handleDisconnect(const std::string& clientId) {
@@ -389,17 +591,10 @@ public:
         int* playerId = clientToPlayer.get(clientHash);
         
         if (playerId) {
-            // Leave all queues
-            const char* games[] = {"pingpong", "snake", "tank"};
-            for (int i = 0; i < 3; i++) {
-                matchmaker.leaveQueue(*playerId, games[i]);
-            }
-            
-            Player* p = playerStorage.get(*playerId);
-            if (p) {
-                p->isInQueue = false;
-                playerStorage.update(*playerId, *p);
-            }
+            // Leave whichever queue the player is in - O(1) state read
+            matchmaker.leaveCurrentQueue(*playerId);
+            std::lock_guard<std::mutex> guard(clientsMutex);
+            playerToClient.remove(*playerId);
             
             outputLog("Client disconnected: " + clientId + " (player: " + std::to_string(*playerId) + ")");
         }
@@ -415,11 +610,28 @@ int main() {
     std::cout.tie(nullptr);
     
     outputLog("Matchmaking Engine starting...");
+    long long startupAt = Clock::monotonicNanos();
     
     MatchmakingEngine engine;
+    const char* gameList = getenv("ARENA_GAMES");
+    if (gameList) {
+        engine.configureGames(gameList);
+    }
     engine.initializeBots();
     
-    outputLog("Ready - listening for commands on stdin");
+    const char* ratingSystem = getenv("ARENA_RATING");
+    if (ratingSystem) {
+        const char* periodSeconds = getenv("ARENA_RATING_PERIOD_SECONDS");
+        engine.configureRatings(ratingSystem, periodSeconds ? atoll(periodSeconds) : 0);
+    }
+    
+    const char* tickMillis = getenv("ARENA_TICK_MS");
+    engine.startMatchmaking(tickMillis ? atoll(tickMillis) * Clock::NANOS_PER_MILLI : 0);
+    
+    char ready[96];
+    snprintf(ready, sizeof(ready), "Ready in %.1f ms - listening for commands on stdin",
+             (Clock::monotonicNanos() - startupAt) / 1e6);
+    outputLog(ready);
     
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -434,6 +646,7 @@ int main() {
             continue;
         }
         
+        
         // Route to handler
         if (cmd == "JOIN") {
             std::string username = getJsonString(line, "username");
@@ -444,7 +657,15 @@ int main() {
         else if (cmd == "QUEUE") {
             int playerId = getJsonInt(line, "playerId");
             std::string game = getJsonString(line, "game");
-            engine.handleQueue(clientId, playerId, game);
+            MatchAttributes attributes(MatchAttributes::bucketForPing(getJsonInt(line, "pingMs")),
+                                       MatchAttributes::deviceFromName(getJsonString(line, "device").c_str()));
+            engine.handleQueue(clientId, playerId, game, attributes);
+        }
+        else if (cmd == "QUEUE_PARTY") {
+            int memberIds[Party::MAX_SIZE];
+            int count = getJsonIntArray(line, "playerIds", memberIds, Party::MAX_SIZE);
+            std::string game = getJsonString(line, "game");
+            engine.handleQueueParty(clientId, memberIds, count, game);
         }
         else if (cmd == "LEAVE") {
             int playerId = getJsonInt(line, "playerId");
@@ -463,6 +684,12 @@ int main() {
             std::string game = getJsonString(line, "game");
             engine.handleLeaderboard(clientId, game);
         }
+        else if (cmd == "METRICS") {
+            engine.handleMetrics(clientId);
+        }
+        else if (cmd == "STATS") {
+            engine.handleStats(clientId);
+        }
         else if (cmd == "DISCONNECT") {
             engine.handleDisconnect(clientId);
         }
@@ -471,6 +698,7 @@ int main() {
         }
     }
     
+    engine.stopMatchmaking();
     outputLog("Engine shutting down");
     return 0;
 }
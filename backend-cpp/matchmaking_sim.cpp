@@ -0,0 +1,365 @@
+/**
+ * Matchmaking Simulation - Seeded, virtual-time runs of the real Matchmaker
+ *
+ * PURPOSE:
+ * Drives Matchmaker end to end on a VirtualClock, so a run is fully
+ * determined by its seed and takes seconds instead of hours. Every
+ * random draw comes from one Random stream:
+ *   - arrivals: a Poisson process (exponential gaps) of new players, each
+ *     with a hidden true skill ~ N(1000, 200), a game, a ping region and
+ *     an input device; every player starts at ELO 1000
+ *   - queueing: Matchmaker::joinQueue with those attributes; one batch
+ *     tick per game every TICK_NANOS of virtual time, exactly as
+ *     MatchmakingTicker does it (bot fallback included)
+ *   - matches: a length ~ N(MATCH_MEAN, MATCH_DEVIATION) seconds; the
+ *     winner is drawn from the Elo win probability of the true skills
+ *     (team averages for team games) and submitted as the result
+ *   - ratings: ELO per result, or Glicko-2 with the rating period closed
+ *     every RATING_PERIOD_SECONDS of virtual time (as the tick threads do)
+ *   - sessions: after each match a player queues again after an idle gap
+ *     (exponential) with probability REQUEUE_PERCENT, otherwise leaves
+ * Timed events (match ends, re-queues) sit in a timing wheel of per-tick
+ * queues, so the driver itself costs O(1) per event.
+ *
+ * REPORTS:
+ *   throughput: players, matches, virtual vs. wall time, matches/sec
+ *   per game:   queue wait and ELO gap percentiles, bot fallback rate
+ *               (MatchTelemetry)
+ *   ratings:    how often the higher-rated side won, correlation and mean
+ *               error of final ELO against true skill (players with at
+ *               least SETTLED_MATCHES matches)
+ *   checksum:   same seed and arguments -> same checksum
+ *
+ * BUILD:
+ *   g++ -std=c++11 -O2 -pthread -o matchmaking_sim matchmaking_sim.cpp
+ *
+ * USAGE:
+ *   ./matchmaking_sim [players] [seed] [arrivalsPerSecond] [games] [elo|glicko2]
+ *   (default 1000000 players, seed 42, 5000 arrivals/sec,
+ *    games "pingpong,snake,tank"; "name:N" makes a team game; elo)
+ */
+
+#include "models/Match.h"
+#include "models/MatchAttributes.h"
+#include "ds/Queue.h"
+#include "services/PlayerStore.h"
+#include "services/GameRegistry.h"
+#include "services/RankingService.h"
+#include "services/HistoryService.h"
+#include "services/Matchmaker.h"
+#include "services/Clock.h"
+#include "services/VirtualClock.h"
+#include "services/Random.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const long long TICK_NANOS = 100 * Clock::NANOS_PER_MILLI;
+static const int WHEEL_TICKS = 1 << 13;               // ~13.6 virtual minutes ahead
+static const int BOTS_PER_GAME = 200;
+static const double SKILL_MEAN = 1000.0;
+static const double SKILL_DEVIATION = 200.0;
+static const double MATCH_MEAN_SECONDS = 90.0;
+static const double MATCH_DEVIATION_SECONDS = 30.0;
+static const double MATCH_MIN_SECONDS = 20.0;
+static const double IDLE_MEAN_SECONDS = 20.0;
+static const int REQUEUE_PERCENT = 75;                // Mean session: 4 matches
+static const int SETTLED_MATCHES = 10;
+static const long long RATING_PERIOD_SECONDS = 60;
+static const int STALLED_TICKS = 600;                 // 60 s with nothing happening
+static const int REGION_PING_MS[4] = {20, 70, 130, 220};
+
+struct SimEvent {
+    enum Kind { MATCH_END, REQUEUE };
+    int kind;
+    int id;  // Match ID or player ID
+
+    SimEvent() : kind(MATCH_END), id(0) {}
+    SimEvent(int k, int i) : kind(k), id(i) {}
+    bool operator==(const SimEvent& other) const { return kind == other.kind && id == other.id; }
+};
+
+struct Simulation {
+    GameRegistry games;
+    PlayerStore store;
+    RankingService ranking;
+    HistoryService history;
+    Matchmaker matchmaker;
+    VirtualClock clock;
+    Random rng;
+
+    int playerCount;
+    int botBase;            // Bots are IDs botBase+1 .. botBase+bots
+    double* skill;          // True skill by player ID
+    int* gameOf;            // Game each human plays
+    unsigned char* attributesOf;
+
+    Queue<SimEvent> wheel[WHEEL_TICKS];
+    long long tick;
+    long long pendingEvents;
+
+    long long matchesCreated;
+    long long matchesFinished;
+    long long favouriteWins;
+    long long evenMatches;  // Equal rated sides (no favourite)
+
+    Simulation(int players, unsigned long long seed)
+        : ranking(&store, &games), matchmaker(&store, &ranking, &history, &games), rng(seed),
+          playerCount(players), botBase(players), tick(0), pendingEvents(0),
+          matchesCreated(0), matchesFinished(0), favouriteWins(0), evenMatches(0) {
+        skill = nullptr;
+        gameOf = nullptr;
+        attributesOf = nullptr;
+    }
+
+    ~Simulation() {
+        delete[] skill;
+        delete[] gameOf;
+        delete[] attributesOf;
+    }
+
+    // Schedule an event delaySeconds of virtual time from now (at least next tick)
+    void schedule(const SimEvent& event, double delaySeconds) {
+        long long ticks = static_cast<long long>(delaySeconds * Clock::NANOS_PER_SECOND / TICK_NANOS);
+        if (ticks < 1) ticks = 1;
+        if (ticks >= WHEEL_TICKS) ticks = WHEEL_TICKS - 1;
+        wheel[(tick + ticks) % WHEEL_TICKS].enqueue(event);
+        pendingEvents++;
+    }
+
+    static void onMatchCreated(const Match& match, void* context) {
+        Simulation* sim = static_cast<Simulation*>(context);
+        sim->matchesCreated++;
+        double seconds = sim->rng.normal(MATCH_MEAN_SECONDS, MATCH_DEVIATION_SECONDS);
+        sim->schedule(SimEvent(SimEvent::MATCH_END, match.matchId),
+                      seconds < MATCH_MIN_SECONDS ? MATCH_MIN_SECONDS : seconds);
+    }
+
+    void setup(const char* gameList, bool glicko) {
+        if (games.configure(gameList) == 0) games.configure(GameRegistry::defaultGames());
+        if (glicko) ranking.setRatingSystem(RankingService::GLICKO2);
+        store.setGameCount(games.size());
+        int totalIds = playerCount + games.size() * BOTS_PER_GAME + 1;
+        skill = new double[totalIds];
+        gameOf = new int[playerCount + 1];
+        attributesOf = new unsigned char[playerCount + 1];
+
+        matchmaker.setLogging(false);
+        matchmaker.setTimeSource(&clock);
+        matchmaker.setRatingPeriodNanos(RATING_PERIOD_SECONDS * Clock::NANOS_PER_SECOND);
+        matchmaker.setCompletedMatchGrace(0);
+        matchmaker.setMatchListener(&Simulation::onMatchCreated, this);
+
+        char name[32];
+        int botId = botBase;
+        for (int g = 0; g < games.size(); g++) {
+            for (int i = 0; i < BOTS_PER_GAME; i++) {
+                botId++;
+                int elo = rng.between(800, 1600);
+                snprintf(name, sizeof(name), "BOT_%d", botId - botBase);
+                store.create(botId, name, elo, true);
+                matchmaker.registerBot(botId, g);
+                ranking.addPlayerToRanking(botId, g);
+                skill[botId] = elo;  // Bots play at their rating
+            }
+        }
+    }
+
+    // A new player arrives and queues
+    void arrive(int playerId) {
+        char name[32];
+        snprintf(name, sizeof(name), "sim_%d", playerId);
+        store.create(playerId, name, 1000);
+        skill[playerId] = rng.normal(SKILL_MEAN, SKILL_DEVIATION);
+        gameOf[playerId] = rng.nextInt(games.size());
+
+        int ping = REGION_PING_MS[rng.nextInt(4)] + rng.nextInt(40);
+        int roll = rng.nextInt(100);
+        int device = roll < 60 ? MatchAttributes::KEYBOARD_MOUSE
+                   : roll < 90 ? MatchAttributes::CONTROLLER : MatchAttributes::TOUCH;
+        attributesOf[playerId] = MatchAttributes(MatchAttributes::bucketForPing(ping), device).pack();
+        queue(playerId);
+    }
+
+    void queue(int playerId) {
+        matchmaker.joinQueue(playerId, gameOf[playerId], MatchAttributes::unpack(attributesOf[playerId]));
+    }
+
+    // Mean true skill and mean current rating (in the match's game) of one side
+    void sideStrength(const int* team, int size, int gameId, double& trueSkill, double& rating) {
+        trueSkill = 0.0;
+        rating = 0.0;
+        for (int i = 0; i < size; i++) {
+            trueSkill += skill[team[i]];
+            rating += store.getElo(store.indexOf(team[i]), gameId);
+        }
+        trueSkill /= size;
+        rating /= size;
+    }
+
+    void finishMatch(int matchId) {
+        Match match;
+        if (!matchmaker.getMatch(matchId, match)) return;
+
+        double skill1, skill2, rating1, rating2;
+        sideStrength(match.team1, match.teamSize, match.gameId, skill1, rating1);
+        sideStrength(match.team2, match.teamSize, match.gameId, skill2, rating2);
+        double pTeam1 = 1.0 / (1.0 + std::pow(10.0, (skill2 - skill1) / 400.0));
+        bool team1Won = rng.nextDouble() < pTeam1;
+
+        if (rating1 == rating2) evenMatches++;
+        else if ((rating1 > rating2) == team1Won) favouriteWins++;
+
+        matchmaker.submitMatchResult(matchId, team1Won ? match.player1Id : match.player2Id);
+        matchesFinished++;
+
+        for (int side = 0; side < 2; side++) {
+            const int* team = side == 0 ? match.team1 : match.team2;
+            for (int i = 0; i < match.teamSize; i++) {
+                if (team[i] > botBase) continue;
+                if (rng.nextInt(100) < REQUEUE_PERCENT) {
+                    schedule(SimEvent(SimEvent::REQUEUE, team[i]), rng.exponential(IDLE_MEAN_SECONDS));
+                }
+            }
+        }
+    }
+
+    /**
+     * Run until every player has arrived and played out their session
+     *
+     * Players still queued at the end normally get a bot within
+     * BOT_FALLBACK_WAIT_NANOS; those who never can (e.g. the tail of a team
+     * game) are left once STALLED_TICKS pass with nothing happening.
+     */
+    void run(double arrivalsPerSecond) {
+        double meanGap = 1.0 / arrivalsPerSecond;
+        double nextArrival = rng.exponential(meanGap);
+        int arrived = 0;
+        long long quietTicks = 0;  // Ticks since the last event or match
+
+        while (true) {
+            double now = static_cast<double>(clock.monotonicNanos()) / Clock::NANOS_PER_SECOND;
+            while (arrived < playerCount && nextArrival <= now) {
+                arrive(++arrived);
+                nextArrival += rng.exponential(meanGap);
+            }
+
+            Queue<SimEvent>& due = wheel[tick % WHEEL_TICKS];
+            SimEvent event;
+            long long before = matchesCreated;
+            bool active = arrived < playerCount || !due.isEmpty();
+            while (due.dequeue(event)) {
+                pendingEvents--;
+                if (event.kind == SimEvent::MATCH_END) finishMatch(event.id);
+                else queue(event.id);
+            }
+
+            for (int g = 0; g < games.size(); g++) {
+                matchmaker.processMatchmaking(g);
+            }
+            matchmaker.closeRatingPeriodIfDue();
+
+            quietTicks = active || matchesCreated != before ? 0 : quietTicks + 1;
+            if (arrived == playerCount && pendingEvents == 0 &&
+                (quietTicks >= STALLED_TICKS || queuedLeft() == 0)) {
+                break;
+            }
+            clock.advance(TICK_NANOS);
+            tick++;
+        }
+    }
+
+    size_t queuedLeft() {
+        size_t total = 0;
+        for (int g = 0; g < games.size(); g++) total += matchmaker.getQueueSize(g);
+        return total;
+    }
+};
+
+// "p50/p90/p99" of a histogram, scaled by 1/divisor
+static void printPercentiles(const Histogram& histogram, double divisor) {
+    printf("%8.1f %8.1f %8.1f", histogram.percentile(50) / divisor,
+           histogram.percentile(90) / divisor, histogram.percentile(99) / divisor);
+}
+
+static void report(Simulation& sim, double wallSeconds) {
+    double virtualSeconds = static_cast<double>(sim.clock.monotonicNanos()) / Clock::NANOS_PER_SECOND;
+    printf("throughput: %d players, %lld matches in %.0f virtual s, %.2f wall s  (%.0f matches/sec, %.0fx real time)\n",
+           sim.playerCount, sim.matchesFinished, virtualSeconds, wallSeconds,
+           wallSeconds > 0 ? sim.matchesFinished / wallSeconds : 0.0,
+           wallSeconds > 0 ? virtualSeconds / wallSeconds : 0.0);
+    if (sim.queuedLeft() > 0) {
+        printf("            %zu players left unmatched in queue at the end\n", sim.queuedLeft());
+    }
+
+    printf("%-10s %8s %8s   %-26s   %-26s\n", "game", "matches", "bot %", "wait ms p50/p90/p99", "elo gap p50/p90/p99");
+    for (int g = 0; g < sim.games.size(); g++) {
+        const MatchTelemetry* telemetry = sim.matchmaker.getTelemetry(g);
+        long long humans = telemetry->getMatchCount(MatchTelemetry::HUMAN_VS_HUMAN);
+        long long bots = telemetry->getMatchCount(MatchTelemetry::HUMAN_VS_BOT);
+        printf("%-10s %8lld %7.2f%%   ", sim.games.getName(g), humans + bots,
+               humans + bots > 0 ? 100.0 * bots / (humans + bots) : 0.0);
+        printPercentiles(telemetry->getWaitMicros(MatchTelemetry::HUMAN_VS_HUMAN), 1000.0);
+        printf("   ");
+        printPercentiles(telemetry->getEloGap(MatchTelemetry::HUMAN_VS_HUMAN), 1.0);
+        printf("\n");
+    }
+
+    // Final ratings against true skill
+    double sumSkill = 0, sumElo = 0, sumSkill2 = 0, sumElo2 = 0, sumProduct = 0, sumError = 0;
+    long long settled = 0;
+    long long checksum = sim.matchesFinished;
+    for (int id = 1; id <= sim.playerCount; id++) {
+        int index = sim.store.indexOf(id);
+        const Player& player = sim.store.getProfile(index);
+        int elo = sim.store.getElo(index, sim.gameOf[id]);
+        checksum = checksum * 31 + elo;
+        if (player.wins + player.losses < SETTLED_MATCHES) continue;
+        double s = sim.skill[id];
+        settled++;
+        sumSkill += s;
+        sumElo += elo;
+        sumSkill2 += s * s;
+        sumElo2 += static_cast<double>(elo) * elo;
+        sumProduct += s * elo;
+        sumError += std::fabs(elo - s);
+    }
+    double correlation = 0.0;
+    if (settled > 1) {
+        double covariance = sumProduct - sumSkill * sumElo / settled;
+        double varianceSkill = sumSkill2 - sumSkill * sumSkill / settled;
+        double varianceElo = sumElo2 - sumElo * sumElo / settled;
+        if (varianceSkill > 0 && varianceElo > 0) correlation = covariance / std::sqrt(varianceSkill * varianceElo);
+    }
+    long long decided = sim.matchesFinished - sim.evenMatches;
+    printf("ratings:    favourite won %.2f%% of %lld rated matches   skill/ELO correlation %.3f   mean |ELO - skill| %.1f  (%lld players with %d+ matches)\n",
+           decided > 0 ? 100.0 * sim.favouriteWins / decided : 0.0, decided, correlation,
+           settled > 0 ? sumError / settled : 0.0, settled, SETTLED_MATCHES);
+    printf("checksum:   %016llx\n", static_cast<unsigned long long>(checksum));
+}
+
+int main(int argc, char** argv) {
+    int players = argc > 1 ? atoi(argv[1]) : 1000000;
+    unsigned long long seed = argc > 2 ? strtoull(argv[2], nullptr, 10) : 42ULL;
+    double arrivalsPerSecond = argc > 3 ? atof(argv[3]) : 5000.0;
+    const char* gameList = argc > 4 ? argv[4] : GameRegistry::defaultGames();
+    bool glicko = argc > 5 && strcmp(argv[5], "glicko2") == 0;
+    if (players < 1) players = 1;
+    if (arrivalsPerSecond <= 0) arrivalsPerSecond = 5000.0;
+
+    Simulation* sim = new Simulation(players, seed);
+    sim->setup(gameList, glicko);
+
+    printf("Matchmaking simulation: %d players, seed %llu, %.0f arrivals/sec, games %s, %s ratings\n",
+           players, seed, arrivalsPerSecond, gameList, glicko ? "glicko2" : "elo");
+    long long start = Clock::monotonicNanos();
+    sim->run(arrivalsPerSecond);
+    sim->matchmaker.closeRatingPeriod();  // Apply the last partial period
+    double wallSeconds = static_cast<double>(Clock::monotonicNanos() - start) / Clock::NANOS_PER_SECOND;
+    report(*sim, wallSeconds);
+
+    delete sim;
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef GLICKO_RATING_H
+#define GLICKO_RATING_H
+
+/**
+ * GlickoRating - A player's Glicko-2 state in one game, kept beside
+ * their ELO in that game
+ *
+ * rating is on the ELO scale (a new player starts at their ELO) and kept
+ * unrounded between rating periods; the game's ELO column holds it rounded, so
+ * matchmaking and leaderboards read one integer either way.
+ *
+ *   - deviation: rating deviation (RD), how unsure the rating is; grows
+ *     while the player sits out rating periods, shrinks as they play
+ *   - volatility: expected fluctuation of the player's strength
+ *   - ratedPeriod: last rating period the player had results in
+ *     (NEVER_RATED until the first)
+ */
+struct GlickoRating {
+    static const int NEVER_RATED = -1;
+
+    double rating;
+    float deviation;
+    float volatility;
+    int ratedPeriod;
+
+    GlickoRating() : rating(1000.0), deviation(350.0f), volatility(0.06f), ratedPeriod(NEVER_RATED) {}
+    explicit GlickoRating(int elo)
+        : rating(elo), deviation(350.0f), volatility(0.06f), ratedPeriod(NEVER_RATED) {}
+};
+
+#endif // GLICKO_RATING_H
@@ -1,42 +1,73 @@
 #ifndef MATCH_H
 #define MATCH_H
 
-#include <cstring>
-#include <ctime>
-
 /**
  * Match - Represents a completed or ongoing match
  * 
  * Stored in LinkedList<Match> for player match history
+ * 
+ * A match is one-on-one (teamSize 1) or between two teams of teamSize
+ * players. player1Id/player2Id are always the first member of each team,
+ * so one-on-one code paths read them directly; winnerId is any member of
+ * the winning team.
+ * 
+ * Timestamps are integer Unix epoch milliseconds (see Clock); they are
+ * only formatted as text when a response is serialized. Games are stored
+ * as GameRegistry IDs and resolved to names the same way.
  */
 struct Match {
+    static const int MAX_TEAM_SIZE = 8;
+    
     int matchId;
     int player1Id;
     int player2Id;
-    char gameName[20];  // "pingpong", "snake", "tank"
+    int gameId;         // GameRegistry ID
     int winnerId;       // 0 if match not finished
-    char timestamp[30];
+    long long createdAt;  // Epoch milliseconds
     bool isCompleted;
+    int teamSize;                 // Players per side (1 = one-on-one)
+    int team1[MAX_TEAM_SIZE];     // team1[0] == player1Id
+    int team2[MAX_TEAM_SIZE];     // team2[0] == player2Id
     
     // Default constructor
-    Match() : matchId(0), player1Id(0), player2Id(0), winnerId(0), isCompleted(false) {
-        gameName[0] = '\0';
-        timestamp[0] = '\0';
+    Match() : matchId(0), player1Id(0), player2Id(0), gameId(-1), winnerId(0), createdAt(0),
+              isCompleted(false), teamSize(0) {
+        for (int i = 0; i < MAX_TEAM_SIZE; i++) {
+            team1[i] = 0;
+            team2[i] = 0;
+        }
     }
     
-    // Parameterized constructor
-    Match(int id, int p1, int p2, const char* game) 
-        : matchId(id), player1Id(p1), player2Id(p2), winnerId(0), isCompleted(false) {
-        strncpy(gameName, game, 19);
-        gameName[19] = '\0';
-        setCurrentTimestamp();
+    // Parameterized constructor (one-on-one)
+    Match(int id, int p1, int p2, int game, long long createdAtMillis) 
+        : matchId(id), player1Id(p1), player2Id(p2), gameId(game), winnerId(0), 
+          createdAt(createdAtMillis), isCompleted(false), teamSize(1) {
+        for (int i = 0; i < MAX_TEAM_SIZE; i++) {
+            team1[i] = 0;
+            team2[i] = 0;
+        }
+        team1[0] = p1;
+        team2[0] = p2;
     }
     
-    // Set current timestamp
-    void setCurrentTimestamp() {
-        time_t now = time(nullptr);
-        struct tm* localTime = localtime(&now);
-        strftime(timestamp, 30, "%Y-%m-%d %H:%M:%S", localTime);
+    // Turn into a team match (size <= MAX_TEAM_SIZE; first members become player1/2)
+    void setTeams(const int* first, const int* second, int size) {
+        teamSize = size;
+        for (int i = 0; i < MAX_TEAM_SIZE; i++) {
+            team1[i] = i < size ? first[i] : 0;
+            team2[i] = i < size ? second[i] : 0;
+        }
+        player1Id = team1[0];
+        player2Id = team2[0];
+    }
+    
+    // Team of a player: 1, 2, or 0 if not in the match
+    int getTeam(int playerId) const {
+        for (int i = 0; i < teamSize; i++) {
+            if (team1[i] == playerId) return 1;
+            if (team2[i] == playerId) return 2;
+        }
+        return 0;
     }
     
     // Set winner and complete the match
@@ -45,16 +76,17 @@ struct Match {
         isCompleted = true;
     }
     
-    // Get the opponent ID for a given player
+    // Get the opponent ID for a given player (the other team's first member)
     int getOpponentId(int playerId) const {
-        if (playerId == player1Id) return player2Id;
-        if (playerId == player2Id) return player1Id;
+        int team = getTeam(playerId);
+        if (team == 1) return player2Id;
+        if (team == 2) return player1Id;
         return 0;
     }
     
-    // Check if player won
+    // Check if player won (their team won)
     bool didPlayerWin(int playerId) const {
-        return winnerId == playerId;
+        return winnerId != 0 && getTeam(playerId) != 0 && getTeam(playerId) == getTeam(winnerId);
     }
     
     // Comparison for LinkedList operations
@@ -69,23 +101,18 @@ struct Match {
 struct MatchHistoryEntry {
     int matchId;
     int opponentId;
-    char gameName[20];
+    int gameId;
     bool won;
-    char timestamp[30];
+    long long timestamp;  // Epoch milliseconds
     
-    MatchHistoryEntry() : matchId(0), opponentId(0), won(false) {
-        gameName[0] = '\0';
-        timestamp[0] = '\0';
-    }
+    MatchHistoryEntry() : matchId(0), opponentId(0), gameId(-1), won(false), timestamp(0) {}
     
     MatchHistoryEntry(const Match& match, int forPlayerId) {
         matchId = match.matchId;
         opponentId = match.getOpponentId(forPlayerId);
-        strncpy(gameName, match.gameName, 19);
-        gameName[19] = '\0';
+        gameId = match.gameId;
         won = match.didPlayerWin(forPlayerId);
-        strncpy(timestamp, match.timestamp, 29);
-        timestamp[29] = '\0';
+        timestamp = match.createdAt;
     }
     
     bool operator==(const MatchHistoryEntry& other) const {
@@ -0,0 +1,61 @@
+#ifndef MATCH_ATTRIBUTES_H
+#define MATCH_ATTRIBUTES_H
+
+#include <cstring>
+
+/**
+ * MatchAttributes - Non-rating matchmaking dimensions of a queued player
+ *
+ *   - latencyBucket: coarse network position (region / ping band), 0 being
+ *     the lowest; distance between buckets stands in for added latency
+ *   - device: input device; touch players only meet touch players, other
+ *     devices may cross-play at a cost
+ *
+ * Packed into one byte for PlayerStore's attribute column (low nibble
+ * bucket, high nibble device). Players who never report attributes are
+ * bucket 0 on KEYBOARD_MOUSE, so they all share one candidate cell.
+ */
+struct MatchAttributes {
+    static const int LATENCY_BUCKETS = 8;
+    static const int LATENCY_BUCKET_MS = 40;   // Ping band per bucket
+
+    enum Device {
+        KEYBOARD_MOUSE = 0,
+        CONTROLLER = 1,
+        TOUCH = 2,
+        DEVICE_COUNT = 3
+    };
+
+    unsigned char latencyBucket;
+    unsigned char device;
+
+    MatchAttributes() : latencyBucket(0), device(KEYBOARD_MOUSE) {}
+
+    // Out-of-range values are clamped to the last bucket / KEYBOARD_MOUSE
+    MatchAttributes(int bucket, int dev)
+        : latencyBucket(static_cast<unsigned char>(bucket < 0 ? 0 : bucket >= LATENCY_BUCKETS ? LATENCY_BUCKETS - 1 : bucket)),
+          device(static_cast<unsigned char>(dev >= 0 && dev < DEVICE_COUNT ? dev : KEYBOARD_MOUSE)) {}
+
+    // Bucket for a measured ping
+    static int bucketForPing(int pingMillis) {
+        int bucket = pingMillis / LATENCY_BUCKET_MS;
+        return bucket < 0 ? 0 : bucket >= LATENCY_BUCKETS ? LATENCY_BUCKETS - 1 : bucket;
+    }
+
+    // Device by name ("keyboard", "controller", "touch"); KEYBOARD_MOUSE if unknown
+    static int deviceFromName(const char* name) {
+        if (strcmp(name, "controller") == 0) return CONTROLLER;
+        if (strcmp(name, "touch") == 0) return TOUCH;
+        return KEYBOARD_MOUSE;
+    }
+
+    unsigned char pack() const {
+        return static_cast<unsigned char>(latencyBucket | (device << 4));
+    }
+
+    static MatchAttributes unpack(unsigned char packed) {
+        return MatchAttributes(packed & 0x0F, packed >> 4);
+    }
+};
+
+#endif // MATCH_ATTRIBUTES_H
@@ -0,0 +1,50 @@
+#ifndef PARTY_H
+#define PARTY_H
+
+/**
+ * Party - A group of players queued together and matched as one unit
+ *
+ * A party is one queue entry and one ranking-index key, so pairing two
+ * parties costs the same as pairing two solo players. It is only matched
+ * against a party of the same size; the two parties become the two teams.
+ *
+ * The party's rating key blends its average and its strongest member:
+ *
+ *   matchElo = averageElo + (maxElo - averageElo) / 2
+ *
+ * so one strong player cannot pull weaker friends into a bracket they
+ * cannot play in, and an even party is matched on its plain average.
+ */
+struct Party {
+    static const int MAX_SIZE = 4;
+
+    int leaderId;               // First member; the party's queue entry key
+    int memberIds[MAX_SIZE];    // memberIds[0] == leaderId
+    int size;
+    int averageElo;
+    int maxElo;
+
+    Party() : leaderId(0), size(0), averageElo(0), maxElo(0) {
+        for (int i = 0; i < MAX_SIZE; i++) {
+            memberIds[i] = 0;
+        }
+    }
+
+    // Rating key used for queue pairing and the party index
+    int matchElo() const {
+        return averageElo + (maxElo - averageElo) / 2;
+    }
+
+    bool contains(int playerId) const {
+        for (int i = 0; i < size; i++) {
+            if (memberIds[i] == playerId) return true;
+        }
+        return false;
+    }
+
+    bool operator==(const Party& other) const {
+        return leaderId == other.leaderId;
+    }
+};
+
+#endif // PARTY_H
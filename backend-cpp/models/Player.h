@@ -5,21 +5,19 @@
 #include <cstdio>
 
 /**
- * Player - Represents a player profile in the system
+ * Player - Cold profile record for a player in the system
  * 
- * Stored in HashTable<int, Player> with PlayerID as key
- * Also used in AVL tree for ranking (via PlayerELO wrapper)
+ * Stored in PlayerStore's cold table, addressed by dense player index.
+ * The username is interned in PlayerStore's StringPool and referenced by ID.
+ * Hot matchmaking fields (ELO, queue/match/bot flags) are NOT kept here -
+ * they live in PlayerStore's parallel columns so scans stay cache friendly.
  */
 struct Player {
     int id;
-    char username[50];
-    int elo;
+    int nameId;  // Interned username (StringPool ID)
     int wins;
     int losses;
-    char preferredGame[20];  // "pingpong", "snake", "tank"
-    bool isInQueue;
-    bool isInMatch;
-    bool isBot;  // Flag to identify bot players
+    int preferredGame;  // GameRegistry ID, -1 if none
     
     // Recent opponent tracking for matchmaking rotation
     static const int MAX_RECENT_OPPONENTS = 3;
@@ -27,21 +25,15 @@ struct Player {
     int recentOpponentCount;
     
     // Default constructor
-    Player() : id(0), elo(1000), wins(0), losses(0), isInQueue(false), isInMatch(false), isBot(false), recentOpponentCount(0) {
-        username[0] = '\0';
-        preferredGame[0] = '\0';
+    Player() : id(0), nameId(-1), wins(0), losses(0), preferredGame(-1), recentOpponentCount(0) {
         for (int i = 0; i < MAX_RECENT_OPPONENTS; i++) {
             recentOpponents[i] = -1;
         }
     }
     
     // Parameterized constructor
-    Player(int playerId, const char* name, int startingElo = 1000, bool bot = false) 
-        : id(playerId), elo(startingElo), wins(0), losses(0), 
-          isInQueue(false), isInMatch(false), isBot(bot), recentOpponentCount(0) {
-        strncpy(username, name, 49);
-        username[49] = '\0';
-        preferredGame[0] = '\0';
+    Player(int playerId, int usernameId) 
+        : id(playerId), nameId(usernameId), wins(0), losses(0), preferredGame(-1), recentOpponentCount(0) {
         for (int i = 0; i < MAX_RECENT_OPPONENTS; i++) {
             recentOpponents[i] = -1;
         }
@@ -81,9 +73,8 @@ struct Player {
     }
     
     // Set preferred game
-    void setPreferredGame(const char* game) {
-        strncpy(preferredGame, game, 19);
-        preferredGame[19] = '\0';
+    void setPreferredGame(int gameId) {
+        preferredGame = gameId;
     }
     
     // Comparison operators for hashing
@@ -129,14 +120,17 @@ struct PlayerELO {
 };
 
 /**
- * QueueEntry - Entry in matchmaking queue
+ * QueueEntry - Entry in matchmaking queue (one player or one party)
  */
 struct QueueEntry {
-    int playerId;
-    long long joinTime;  // Timestamp when joined queue
-    
-    QueueEntry() : playerId(0), joinTime(0) {}
-    QueueEntry(int id, long long time) : playerId(id), joinTime(time) {}
+    int playerId;        // Solo player, or a party's leader
+    long long joinTime;  // Monotonic nanoseconds when joined queue (Clock::monotonicNanos)
+    unsigned int handle; // PlayerState queue handle at enqueue time
+    int partySize;       // 1 for a solo player
+    
+    QueueEntry() : playerId(0), joinTime(0), handle(0), partySize(1) {}
+    QueueEntry(int id, long long time, unsigned int queueHandle = 0, int size = 1) 
+        : playerId(id), joinTime(time), handle(queueHandle), partySize(size) {}
     
     bool operator==(const QueueEntry& other) const {
         return playerId == other.playerId;
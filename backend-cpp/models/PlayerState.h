@@ -0,0 +1,74 @@
+#ifndef PLAYER_STATE_H
+#define PLAYER_STATE_H
+
+/**
+ * PlayerState - Packed per-player matchmaking state word
+ *
+ * A player's whole matchmaking status fits in one 64-bit word, so it can be
+ * read with a single load and changed with a single compare-and-swap:
+ *
+ *   bits  0-3   status       IDLE / QUEUED / IN_MATCH
+ *   bits  4-11  game ID      game the player is queued for / playing
+ *   bits 12-31  queue handle bumped on every enqueue; a queue entry is live
+ *                            only while its handle matches this field
+ *   bits 32-63  match ID     active match while IN_MATCH
+ *
+ * The queue handle lets the matchmaker drop players from a queue in O(1):
+ * leaving just flips the status, and the stale queue entry is skipped when
+ * it reaches the front because its handle no longer matches.
+ */
+struct PlayerState {
+    typedef unsigned long long Word;
+
+    enum Status {
+        IDLE = 0,
+        QUEUED = 1,
+        IN_MATCH = 2
+    };
+
+    static const int NO_GAME = 0xFF;
+    static const unsigned int HANDLE_MASK = 0xFFFFF;  // 20 bits
+
+    static Word pack(Status status, int gameId, unsigned int handle, int matchId) {
+        return static_cast<Word>(status & 0xF)
+             | (static_cast<Word>(gameId & 0xFF) << 4)
+             | (static_cast<Word>(handle & HANDLE_MASK) << 12)
+             | (static_cast<Word>(static_cast<unsigned int>(matchId)) << 32);
+    }
+
+    static Status status(Word word) {
+        return static_cast<Status>(word & 0xF);
+    }
+
+    static int gameId(Word word) {
+        return static_cast<int>((word >> 4) & 0xFF);
+    }
+
+    static unsigned int handle(Word word) {
+        return static_cast<unsigned int>((word >> 12) & HANDLE_MASK);
+    }
+
+    static int matchId(Word word) {
+        return static_cast<int>(static_cast<unsigned int>(word >> 32));
+    }
+
+    // Initial state for a new player
+    static Word initial() {
+        return pack(IDLE, NO_GAME, 0, 0);
+    }
+
+    // Transitions (the queue handle is carried across so it keeps increasing)
+    static Word queued(Word from, int gameId) {
+        return pack(QUEUED, gameId, (handle(from) + 1) & HANDLE_MASK, 0);
+    }
+
+    static Word inMatch(Word from, int gameId, int matchId) {
+        return pack(IN_MATCH, gameId, handle(from), matchId);
+    }
+
+    static Word idle(Word from) {
+        return pack(IDLE, NO_GAME, handle(from), 0);
+    }
+};
+
+#endif // PLAYER_STATE_H
@@ -12,68 +12,92 @@
 #include "ds/LinkedList.h"
 #include "models/Player.h"
 #include "models/Match.h"
+#include "models/Party.h"
+#include "services/PlayerStore.h"
+#include "services/GameRegistry.h"
 #include "services/RankingService.h"
 #include "services/HistoryService.h"
 #include "services/Matchmaker.h"
+#include "services/MatchmakingTicker.h"
+#include "services/Clock.h"
+#include "services/Random.h"
+#include "services/LeaderboardCache.h"
+#include "services/StateLog.h"
+#include "services/Persistence.h"
+#include "services/BulkLoader.h"
 #include <cstdio>
 #include <cstring>
 #include <string>
 #include <cstdlib>
+#include <cerrno>
+#include <climits>
 #include <ctime>
 
 // Global data storage
-HashTable<int, Player> playerStorage;
-RankingService rankingService(&playerStorage);
+GameRegistry gameRegistry;
+PlayerStore playerStore;
+RankingService rankingService(&playerStore, &gameRegistry);
 HistoryService historyService;
-Matchmaker matchmaker(&playerStorage, &rankingService, &historyService);
+Matchmaker matchmaker(&playerStore, &rankingService, &historyService, &gameRegistry);
 int nextPlayerId = 1;
 
+// One tick thread per game shard
+MatchmakingTicker matchmakingTicker(&matchmaker, &gameRegistry);
+
+// Rendered leaderboards, rebuilt only after their game's ranking changes
+LeaderboardCache leaderboardCache;
+
+// Write-ahead log and snapshots (only when ARENA_DATA_DIR is set)
+StateLog stateLog;
+Persistence persistence(&playerStore, &rankingService, &historyService, &matchmaker, &gameRegistry, &stateLog);
+bool persistent = false;
+
 // Bot ID range (1000+)
 const int BOT_ID_START = 1000;
 
 /**
  * Initialize bot players at server startup
- * Creates 5 bots per game with randomized ELO (800-1600)
+ * Creates 5 bots per game (ARENA_BOTS_PER_GAME) with randomized ELO (800-1600)
  */
 void initializeBots() {
-    srand(static_cast<unsigned>(time(nullptr)));
+    // ARENA_SEED fixes the bot ratings for reproducible runs (default: time)
+    Random rng(Random::seedFromEnvironment("ARENA_SEED"));
     
-    const char* games[] = {"pingpong", "snake", "tank"};
-    const int BOTS_PER_GAME = 5;
+    // Bots per game (ARENA_BOTS_PER_GAME overrides; pools have no size cap)
+    const char* botsOverride = getenv("ARENA_BOTS_PER_GAME");
+    const int BOTS_PER_GAME = botsOverride && atoi(botsOverride) > 0 ? atoi(botsOverride) : 5;
     
+    // Bots are created first; each game's bot pool and ranking tree is then
+    // built in one pass, games in parallel
+    BulkLoader loader(&playerStore, &rankingService, &matchmaker, &gameRegistry);
     int botId = BOT_ID_START;
     
-    for (int g = 0; g < 3; g++) {
-        const char* game = games[g];
+    for (int game = 0; game < gameRegistry.size(); game++) {
+        int lowest = 0, highest = 0;
         
         for (int i = 0; i < BOTS_PER_GAME; i++) {
             // Generate random ELO between 800-1600
-            int elo = 800 + (rand() % 801);
+            int elo = rng.between(800, 1600);
             
             // Create bot name like "BOT_1", "BOT_2", etc.
             char botName[50];
             snprintf(botName, sizeof(botName), "BOT_%d", botId - BOT_ID_START + 1);
             
-            // Create bot player (isBot = true)
-            Player bot(botId, botName, elo, true);
-            bot.setPreferredGame(game);
-            playerStorage.insert(botId, bot);
-            
-            // Register bot with matchmaker for this game
-            matchmaker.registerBot(botId, game);
-            
-            // Add to ranking tree for this game
-            rankingService.addPlayerToRanking(botId, game);
-            
-            printf("  Created %s (ELO: %d) for %s\n", botName, elo, game);
+            loader.addBot(botId, botName, elo, game);
+            if (i == 0 || elo < lowest) lowest = elo;
+            if (i == 0 || elo > highest) highest = elo;
             botId++;
         }
+        printf("  Created %d bots (ELO %d-%d) for %s\n", BOTS_PER_GAME, lowest, highest, gameRegistry.getName(game));
     }
+    loader.build();
     
     // Ensure human player IDs start after bots
     nextPlayerId = botId + 1;
     
-    printf("\nTotal bots created: %d\n\n", botId - BOT_ID_START);
+    const BulkLoader::Report& report = loader.getReport();
+    printf("\nTotal bots created: %d (pools and ranking trees built on %d threads, ready in %.1f ms)\n\n",
+           report.bots, report.threads, report.readyNanos() / 1e6);
 }
 
 // Simple JSON helpers
@@ -81,6 +105,28 @@ std::string jsonString(const char* key, const char* value) {
     return "\"" + std::string(key) + "\":\"" + std::string(value) + "\"";
 }
 
+// Username field - copies the pre-escaped bytes interned in PlayerStore
+std::string jsonName(const char* key, int playerIndex) {
+    std::string out;
+    out.reserve(strlen(key) + 8 + (playerIndex != PlayerStore::NO_PLAYER ? playerStore.getEscapedNameLength(playerIndex) : 7));
+    out += '"';
+    out += key;
+    out += "\":\"";
+    if (playerIndex != PlayerStore::NO_PLAYER) {
+        out.append(playerStore.getEscapedName(playerIndex), playerStore.getEscapedNameLength(playerIndex));
+    } else {
+        out += "Unknown";
+    }
+    out += '"';
+    return out;
+}
+
+// Game field - resolves a GameRegistry ID to its name
+std::string jsonGame(const char* key, int gameId) {
+    const char* name = gameRegistry.getName(gameId);
+    return jsonString(key, name ? name : "");
+}
+
 std::string jsonInt(const char* key, int value) {
     return "\"" + std::string(key) + "\":" + std::to_string(value);
 }
@@ -95,6 +141,60 @@ std::string jsonFloat(const char* key, float value) {
     return "\"" + std::string(key) + "\":" + std::string(buf);
 }
 
+// Headline rating - the player's ELO in the game they last queued for
+// (the first game until they have queued)
+int displayElo(int playerIndex) {
+    int game = playerStore.getProfile(playerIndex).preferredGame;
+    return playerStore.getElo(playerIndex, gameRegistry.isValid(game) ? game : 0);
+}
+
+// Per-game ratings object - {"pingpong":1000,"snake":1000,...}
+std::string jsonRatings(const char* key, int playerIndex) {
+    std::string out = "\"" + std::string(key) + "\":{";
+    for (int game = 0; game < gameRegistry.size(); game++) {
+        if (game > 0) out += ",";
+        out += jsonInt(gameRegistry.getName(game), playerStore.getElo(playerIndex, game));
+    }
+    out += "}";
+    return out;
+}
+
+/**
+ * Leaderboard body for a game (top 100 by ELO) - caller holds the shard lock
+ *
+ * Rendered into one pre-sized buffer from the tree entries and interned,
+ * pre-escaped names; served from leaderboardCache until the game's
+ * leaderboard version moves.
+ */
+std::string renderLeaderboard(int gameId) {
+    int playerIds[100];
+    int elos[100];
+    int count = rankingService.getLeaderboard(gameId, playerIds, elos, 100);
+    
+    std::string out;
+    out.reserve(64 + count * 112);
+    out += "{\"game\":\"";
+    out += gameRegistry.getName(gameId);
+    out += "\",\"leaderboard\":[";
+    
+    char buf[96];
+    int rank = 0;
+    for (int i = 0; i < count; i++) {
+        int index = playerStore.indexOf(playerIds[i]);
+        if (index == PlayerStore::NO_PLAYER) continue;
+        const Player& player = playerStore.getProfile(index);
+        if (rank > 0) out += ",";
+        snprintf(buf, sizeof(buf), "{\"rank\":%d,\"playerId\":%d,\"username\":\"", ++rank, player.id);
+        out += buf;
+        out.append(playerStore.getEscapedName(index), playerStore.getEscapedNameLength(index));
+        snprintf(buf, sizeof(buf), "\",\"elo\":%d,\"wins\":%d,\"losses\":%d}", elos[i], player.wins, player.losses);
+        out += buf;
+    }
+    
+    out += "]}";
+    return out;
+}
+
 // Parse simple JSON
 std::string getJsonValue(const std::string& json, const std::string& key) {
     std::string searchKey = "\"" + key + "\"";
@@ -126,6 +226,43 @@ std::string getJsonValue(const std::string& json, const std::string& key) {
     }
 }
 
+// Parse a flat integer array ("key":[1,2,3]) into out - returns count, or -1
+int getJsonIntArray(const std::string& json, const std::string& key, int* out, int maxCount) {
+    std::string searchKey = "\"" + key + "\"";
+    size_t keyPos = json.find(searchKey);
+    if (keyPos == std::string::npos) return -1;
+    
+    size_t open = json.find('[', keyPos);
+    size_t close = json.find(']', keyPos);
+    if (open == std::string::npos || close == std::string::npos || close < open) return -1;
+    
+    int count = 0;
+    size_t pos = open + 1;
+    while (pos < close) {
+        while (pos < close && (json[pos] == ' ' || json[pos] == ',' || json[pos] == '\t')) pos++;
+        if (pos >= close) break;
+        if (count == maxCount) return -1;
+        char* end = nullptr;
+        long value = strtol(json.c_str() + pos, &end, 10);
+        size_t next = end - json.c_str();
+        if (next == pos) return -1;
+        out[count++] = static_cast<int>(value);
+        pos = next;
+    }
+    return count;
+}
+
+// Parse a whole string as a decimal int - false if it is not one or is out of range
+bool parseInt(const std::string& text, int& out) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    long value = strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) return false;
+    out = static_cast<int>(value);
+    return true;
+}
+
 int main() {
     http::Server svr;
     
@@ -141,43 +278,46 @@ int main() {
             return;
         }
         
-        // Check if username already exists (iterate through all players)
-        int existingKeys[2000];
-        size_t keyCount;
-        playerStorage.getAllKeys(existingKeys, keyCount);
-        
-        for (size_t i = 0; i < keyCount; i++) {
-            Player* existing = playerStorage.get(existingKeys[i]);
-            if (existing && strcmp(existing->username, username.c_str()) == 0) {
-                // Username already taken - return the existing player instead
-                std::string response = "{" +
-                    jsonInt("id", existing->id) + "," +
-                    jsonString("username", existing->username) + "," +
-                    jsonInt("elo", existing->elo) + "," +
-                    jsonInt("wins", existing->wins) + "," +
-                    jsonInt("losses", existing->losses) + "," +
-                    jsonBool("isBot", existing->isBot) + "," +
-                    jsonString("message", "Welcome back!") +
-                "}";
-                res.set_content(response, "application/json");
-                printf("[Server] Player '%s' logged back in (ID: %d)\n", existing->username, existing->id);
-                return;
-            }
+        // Check if username already exists (interned name lookup)
+        int existingIndex = playerStore.findByName(username.c_str());
+        if (existingIndex != PlayerStore::NO_PLAYER) {
+            const Player& existing = playerStore.getProfile(existingIndex);
+            // Username already taken - return the existing player instead
+            std::string response = "{" +
+                jsonInt("id", existing.id) + "," +
+                jsonName("username", existingIndex) + "," +
+                jsonInt("elo", displayElo(existingIndex)) + "," +
+                jsonRatings("ratings", existingIndex) + "," +
+                jsonInt("wins", existing.wins) + "," +
+                jsonInt("losses", existing.losses) + "," +
+                jsonBool("isBot", playerStore.isBot(existingIndex)) + "," +
+                jsonString("message", "Welcome back!") +
+            "}";
+            res.set_content(response, "application/json");
+            printf("[Server] Player '%s' logged back in (ID: %d)\n", playerStore.getName(existingIndex), existing.id);
+            return;
         }
         
         // Username is available - create new player
         int elo = eloStr.empty() ? 1000 : std::stoi(eloStr);
         int playerId = nextPlayerId++;
         
-        Player player(playerId, username.c_str(), elo);
-        playerStorage.insert(playerId, player);
+        int index;
+        {
+            // Player indexes are shared by every shard's tick thread
+            Matchmaker::ExclusiveLock exclusive(matchmaker);
+            index = playerStore.create(playerId, username.c_str(), elo);
+            stateLog.playerCreated(playerId, username.c_str(), elo, false);
+        }
+        stateLog.sync();  // Acknowledged only once logged
         
         printf("[Server] New player '%s' registered (ID: %d)\n", username.c_str(), playerId);
         
         std::string response = "{" +
             jsonInt("id", playerId) + "," +
-            jsonString("username", player.username) + "," +
-            jsonInt("elo", player.elo) + "," +
+            jsonName("username", index) + "," +
+            jsonInt("elo", displayElo(index)) + "," +
+            jsonRatings("ratings", index) + "," +
             jsonInt("wins", 0) + "," +
             jsonInt("losses", 0) +
         "}";
@@ -187,24 +327,36 @@ int main() {
     
     svr.Get("/api/players/(\\d+)", [](const http::Request& req, http::Response& res) {
         int playerId = std::stoi(req.matches[1]);
-        Player* player = playerStorage.get(playerId);
+        int index = playerStore.indexOf(playerId);
         
-        if (!player) {
+        if (index == PlayerStore::NO_PLAYER) {
             res.status = 404;
             res.set_content("{\"error\":\"Player not found\"}", "application/json");
             return;
         }
         
+        const Player& player = playerStore.getProfile(index);
+        
+        // "Top X%" badge in the headline game - O(log R) on its distribution
+        int game = gameRegistry.isValid(player.preferredGame) ? player.preferredGame : 0;
+        double topPercent;
+        {
+            Matchmaker::ShardLock lock(matchmaker, game);
+            topPercent = rankingService.getTopPercent(game, playerStore.getElo(index, game));
+        }
+        
         std::string response = "{" +
-            jsonInt("id", player->id) + "," +
-            jsonString("username", player->username) + "," +
-            jsonInt("elo", player->elo) + "," +
-            jsonInt("wins", player->wins) + "," +
-            jsonInt("losses", player->losses) + "," +
-            jsonFloat("winRate", player->getWinRate()) + "," +
-            jsonBool("isInQueue", player->isInQueue) + "," +
-            jsonBool("isInMatch", player->isInMatch) + "," +
-            jsonBool("isBot", player->isBot) +
+            jsonInt("id", player.id) + "," +
+            jsonName("username", index) + "," +
+            jsonInt("elo", displayElo(index)) + "," +
+            jsonRatings("ratings", index) + "," +
+            jsonFloat("topPercent", static_cast<float>(topPercent)) + "," +
+            jsonInt("wins", player.wins) + "," +
+            jsonInt("losses", player.losses) + "," +
+            jsonFloat("winRate", player.getWinRate()) + "," +
+            jsonBool("isInQueue", playerStore.isInQueue(index)) + "," +
+            jsonBool("isInMatch", playerStore.isInMatch(index)) + "," +
+            jsonBool("isBot", playerStore.isBot(index)) +
         "}";
         
         res.set_content(response, "application/json");
@@ -223,52 +375,102 @@ int main() {
         }
         
         int playerId = std::stoi(playerIdStr);
+        int gameId = gameRegistry.getId(gameName.c_str());
+        if (gameId == GameRegistry::NO_GAME) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+            return;
+        }
+        
+        // Optional latency / input device for compatibility-aware matching
+        std::string pingStr = getJsonValue(req.body, "pingMs");
+        std::string deviceName = getJsonValue(req.body, "device");
+        int pingMs = 0;
+        if (!pingStr.empty() && !parseInt(pingStr, pingMs)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"pingMs must be an integer\"}", "application/json");
+            return;
+        }
         
         // Fix: Force reset stale player state if they try to join again
-        Player* player = playerStorage.get(playerId);
-        if (player) {
-            if (player->isInQueue) {
+        // (queued game and active match are O(1) reads of the state word)
+        int index = playerStore.indexOf(playerId);
+        if (index != PlayerStore::NO_PLAYER) {
+            if (playerStore.isInQueue(index)) {
                 printf("[Server] Resetting stale queue state for player %d\n", playerId);
-                matchmaker.leaveQueue(playerId, gameName.c_str());
-                player->isInQueue = false;
-                playerStorage.update(playerId, *player);
+                matchmaker.leaveCurrentQueue(playerId);
             }
             
-            if (player->isInMatch) {
+            int activeMatchId = matchmaker.getPlayerActiveMatch(playerId);
+            if (activeMatchId != -1) {
                 printf("[Server] Force-ending stale match for player %d\n", playerId);
-                // Find and end the stale match to free up the opponent (bot/human)
-                int activeMatchId = matchmaker.getPlayerActiveMatch(playerId);
-                if (activeMatchId != -1) {
-                    // Give win to this player to close it out simply
-                    matchmaker.submitMatchResult(activeMatchId, playerId);
-                }
-                player->isInMatch = false;
-                playerStorage.update(playerId, *player);
+                // End the stale match to free up the opponent (bot/human)
+                // Give win to this player to close it out simply
+                matchmaker.submitMatchResult(activeMatchId, playerId);
             }
         }
 
-        if (matchmaker.joinQueue(playerId, gameName.c_str())) {
-            int matchId = matchmaker.tryCreateMatch(gameName.c_str());
-            
-            if (matchId != -1) {
-                Match* match = matchmaker.getMatch(matchId);
-                std::string response = "{" +
-                    jsonBool("queued", false) + "," +
-                    jsonBool("matched", true) + "," +
-                    jsonInt("matchId", matchId) + "," +
-                    jsonInt("player1Id", match->player1Id) + "," +
-                    jsonInt("player2Id", match->player2Id) + "," +
-                    jsonString("game", match->gameName) +
-                "}";
-                res.set_content(response, "application/json");
-            } else {
-                std::string response = "{" +
-                    jsonBool("queued", true) + "," +
-                    jsonBool("matched", false) + "," +
-                    jsonInt("queuePosition", static_cast<int>(matchmaker.getQueueSize(gameName.c_str()))) +
-                "}";
-                res.set_content(response, "application/json");
-            }
+        bool joined;
+        if (!pingStr.empty() || !deviceName.empty()) {
+            MatchAttributes attributes(MatchAttributes::bucketForPing(pingMs),
+                                       MatchAttributes::deviceFromName(deviceName.c_str()));
+            joined = matchmaker.joinQueue(playerId, gameId, attributes);
+        } else {
+            joined = matchmaker.joinQueue(playerId, gameId);
+        }
+        
+        stateLog.sync();
+        
+        // Matching happens on the next tick; the client polls status for it
+        if (joined) {
+            std::string response = "{" +
+                jsonBool("queued", true) + "," +
+                jsonBool("matched", false) + "," +
+                jsonInt("queuePosition", static_cast<int>(matchmaker.getQueueSize(gameId))) +
+            "}";
+            res.set_content(response, "application/json");
+        } else {
+            res.status = 400;
+            res.set_content("{\"error\":\"Failed to join queue\"}", "application/json");
+        }
+    });
+    
+    // Queue a pre-formed party: {"playerIds":[leader, ...], "game":"..."}
+    svr.Post("/api/matchmaking/join-party", [](const http::Request& req, http::Response& res) {
+        int memberIds[Party::MAX_SIZE];
+        int count = getJsonIntArray(req.body, "playerIds", memberIds, Party::MAX_SIZE);
+        std::string gameName = getJsonValue(req.body, "game");
+        
+        if (count < 2 || gameName.empty()) {
+            res.status = 400;
+            res.set_content("{\"error\":\"playerIds (2-4 players) and game required\"}", "application/json");
+            return;
+        }
+        
+        int gameId = gameRegistry.getId(gameName.c_str());
+        if (gameId == GameRegistry::NO_GAME) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+            return;
+        }
+        if (count != gameRegistry.getTeamSize(gameId)) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Party size must equal the game's team size (" +
+                            std::to_string(gameRegistry.getTeamSize(gameId)) + ")\"}", "application/json");
+            return;
+        }
+        
+        // Every member must be idle; the party is matched on the next tick
+        bool joined = matchmaker.joinPartyQueue(memberIds, count, gameId);
+        stateLog.sync();
+        if (joined) {
+            std::string response = "{" +
+                jsonBool("queued", true) + "," +
+                jsonBool("matched", false) + "," +
+                jsonInt("partySize", count) + "," +
+                jsonInt("queuePosition", static_cast<int>(matchmaker.getQueueSize(gameId))) +
+            "}";
+            res.set_content(response, "application/json");
         } else {
             res.status = 400;
             res.set_content("{\"error\":\"Failed to join queue\"}", "application/json");
@@ -286,8 +488,11 @@ int main() {
         }
         
         int playerId = std::stoi(playerIdStr);
+        int gameId = gameRegistry.getId(gameName.c_str());
         
-        if (matchmaker.leaveQueue(playerId, gameName.c_str())) {
+        bool left = matchmaker.leaveQueue(playerId, gameId);
+        stateLog.sync();
+        if (left) {
             res.set_content("{\"success\":true}", "application/json");
         } else {
             res.status = 400;
@@ -295,29 +500,43 @@ int main() {
         }
     });
     
+    // Run one batch matchmaking pass for a game now (outside the tick)
+    svr.Post("/api/matchmaking/process", [](const http::Request& req, http::Response& res) {
+        std::string gameName = getJsonValue(req.body, "game");
+        int gameId = gameRegistry.getId(gameName.c_str());
+        
+        if (gameId == GameRegistry::NO_GAME) {
+            res.status = 400;
+            res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+            return;
+        }
+        
+        int matchesCreated = matchmaker.processMatchmaking(gameId);
+        
+        std::string response = "{" +
+            jsonGame("game", gameId) + "," +
+            jsonInt("matchesCreated", matchesCreated) + "," +
+            jsonInt("queueSize", static_cast<int>(matchmaker.getQueueSize(gameId))) +
+        "}";
+        res.set_content(response, "application/json");
+    });
+    
     svr.Get("/api/matchmaking/status/(\\d+)", [](const http::Request& req, http::Response& res) {
         int playerId = std::stoi(req.matches[1]);
-        Player* player = playerStorage.get(playerId);
+        int index = playerStore.indexOf(playerId);
         
-        if (!player) {
+        if (index == PlayerStore::NO_PLAYER) {
             res.status = 404;
             res.set_content("{\"error\":\"Player not found\"}", "application/json");
             return;
         }
         
-        // Try to create a match if player is in queue (handles bot timeout)
-        if (player->isInQueue) {
-            // Try matching for all games since we don't track which game they queued for
-            matchmaker.tryCreateMatch("pingpong");
-            matchmaker.tryCreateMatch("snake");
-            matchmaker.tryCreateMatch("tank");
-        }
-        
+        // Read-only - matches are made by the background tick
         int activeMatchId = matchmaker.getPlayerActiveMatch(playerId);
         
         std::string response = "{" +
-            jsonBool("isInQueue", player->isInQueue) + "," +
-            jsonBool("isInMatch", player->isInMatch) + "," +
+            jsonBool("isInQueue", playerStore.isInQueue(index)) + "," +
+            jsonBool("isInMatch", playerStore.isInMatch(index)) + "," +
             jsonInt("activeMatchId", activeMatchId) +
         "}";
         
@@ -328,27 +547,42 @@ int main() {
     
     svr.Get("/api/matches/(\\d+)", [](const http::Request& req, http::Response& res) {
         int matchId = std::stoi(req.matches[1]);
-        Match* match = matchmaker.getMatch(matchId);
+        Match match;
         
-        if (!match) {
+        if (!matchmaker.getMatch(matchId, match)) {
             res.status = 404;
             res.set_content("{\"error\":\"Match not found\"}", "application/json");
             return;
         }
         
-        Player* p1 = playerStorage.get(match->player1Id);
-        Player* p2 = playerStorage.get(match->player2Id);
+        int p1 = playerStore.indexOf(match.player1Id);
+        int p2 = playerStore.indexOf(match.player2Id);
         
         std::string response = "{" +
-            jsonInt("matchId", match->matchId) + "," +
-            jsonInt("player1Id", match->player1Id) + "," +
-            jsonString("player1Name", p1 ? p1->username : "Unknown") + "," +
-            jsonInt("player2Id", match->player2Id) + "," +
-            jsonString("player2Name", p2 ? p2->username : "Unknown") + "," +
-            jsonString("game", match->gameName) + "," +
-            jsonBool("isCompleted", match->isCompleted) + "," +
-            jsonInt("winnerId", match->winnerId) +
-        "}";
+            jsonInt("matchId", match.matchId) + "," +
+            jsonInt("player1Id", match.player1Id) + "," +
+            jsonName("player1Name", p1) + "," +
+            jsonInt("player2Id", match.player2Id) + "," +
+            jsonName("player2Name", p2) + "," +
+            jsonGame("game", match.gameId) + "," +
+            jsonBool("isCompleted", match.isCompleted) + "," +
+            jsonInt("winnerId", match.winnerId);
+        
+        // Party matches also list both teams
+        if (match.teamSize > 1) {
+            response += "," + jsonInt("teamSize", match.teamSize);
+            const char* keys[2] = {"team1", "team2"};
+            const int* teams[2] = {match.team1, match.team2};
+            for (int t = 0; t < 2; t++) {
+                response += ",\"" + std::string(keys[t]) + "\":[";
+                for (int i = 0; i < match.teamSize; i++) {
+                    if (i > 0) response += ",";
+                    response += std::to_string(teams[t][i]);
+                }
+                response += "]";
+            }
+        }
+        response += "}";
         
         res.set_content(response, "application/json");
     });
@@ -366,16 +600,21 @@ int main() {
         int matchId = std::stoi(matchIdStr);
         int winnerId = std::stoi(winnerIdStr);
         
-        if (matchmaker.submitMatchResult(matchId, winnerId)) {
-            Match* match = matchmaker.getMatch(matchId);
-            Player* winner = playerStorage.get(winnerId);
-            int loserId = (winnerId == match->player1Id) ? match->player2Id : match->player1Id;
-            Player* loser = playerStorage.get(loserId);
+        // Read the players and game before submitting; the match may be evicted later
+        Match match;
+        int loserId = matchmaker.getMatch(matchId, match) ? match.getOpponentId(winnerId) : 0;
+        
+        bool submitted = matchmaker.submitMatchResult(matchId, winnerId);
+        stateLog.sync();
+        if (submitted) {
+            int winner = playerStore.indexOf(winnerId);
+            int loser = playerStore.indexOf(loserId);
             
+            // New ratings in the game that was played
             std::string response = "{" +
                 jsonBool("success", true) + "," +
-                jsonInt("winnerNewElo", winner ? winner->elo : 0) + "," +
-                jsonInt("loserNewElo", loser ? loser->elo : 0) +
+                jsonInt("winnerNewElo", winner != PlayerStore::NO_PLAYER ? playerStore.getElo(winner, match.gameId) : 0) + "," +
+                jsonInt("loserNewElo", loser != PlayerStore::NO_PLAYER ? playerStore.getElo(loser, match.gameId) : 0) +
             "}";
             res.set_content(response, "application/json");
         } else {
@@ -389,27 +628,145 @@ int main() {
     svr.Get("/api/leaderboard/(\\w+)", [](const http::Request& req, http::Response& res) {
         std::string gameName = req.matches[1];
         
-        int playerIds[100];
-        int elos[100];
-        int count = rankingService.getLeaderboard(gameName.c_str(), playerIds, elos, 100);
+        int gameId = gameRegistry.getId(gameName.c_str());
+        if (!gameRegistry.isValid(gameId)) {
+            res.set_content("{\"game\":\"" + gameName + "\",\"leaderboard\":[]}", "application/json");
+            return;
+        }
         
-        std::string response = "{\"game\":\"" + gameName + "\",\"leaderboard\":[";
+        // Unchanged since the client's copy: answered from the version alone
+        long long version = rankingService.getLeaderboardVersion(gameId);
+        if (leaderboardCache.isCurrent(req.get_header_value("If-None-Match"), gameId, version)) {
+            res.status = 304;
+            res.set_header("ETag", leaderboardCache.etagFor(gameId, version));
+            return;
+        }
         
-        for (int i = 0; i < count; i++) {
-            Player* player = playerStorage.get(playerIds[i]);
-            if (player) {
-                if (i > 0) response += ",";
-                response += "{" +
-                    jsonInt("rank", i + 1) + "," +
-                    jsonInt("playerId", player->id) + "," +
-                    jsonString("username", player->username) + "," +
-                    jsonInt("elo", player->elo) + "," +
-                    jsonInt("wins", player->wins) + "," +
-                    jsonInt("losses", player->losses) +
-                "}";
+        std::string response;
+        if (!leaderboardCache.lookup(gameId, version, response)) {
+            // The game's ranking tree (and its version) belong to its shard
+            Matchmaker::ShardLock lock(matchmaker, gameId);
+            version = rankingService.getLeaderboardVersion(gameId);
+            response = renderLeaderboard(gameId);
+            leaderboardCache.store(gameId, version, response);
+        }
+        
+        res.set_header("ETag", leaderboardCache.etagFor(gameId, version));
+        res.set_content(response, "application/json");
+    });
+    
+    // Rating distribution of a game's ranked players: percentiles and a
+    // histogram in 50-point buckets, from prefix sums (no tree walk)
+    svr.Get("/api/distribution/(\\w+)", [](const http::Request& req, http::Response& res) {
+        std::string gameName = req.matches[1];
+        int gameId = gameRegistry.getId(gameName.c_str());
+        if (!gameRegistry.isValid(gameId)) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+            return;
+        }
+        
+        const int BUCKET_WIDTH = 50;
+        const int MAX_BUCKETS = RankingService::RATING_RANGE / BUCKET_WIDTH + 2;
+        static const int PERCENTILES[] = {10, 25, 50, 75, 90, 99};
+        int eloAt[6];
+        long long counts[MAX_BUCKETS];
+        size_t ranked;
+        int from, buckets;
+        {
+            Matchmaker::ShardLock lock(matchmaker, gameId);
+            ranked = rankingService.getRankingCount(gameId);
+            for (int i = 0; i < 6; i++) eloAt[i] = rankingService.getEloAtPercentile(gameId, PERCENTILES[i]);
+            int lowest = rankingService.getEloAtPercentile(gameId, 0);
+            int highest = rankingService.getEloAtPercentile(gameId, 100);
+            from = lowest - lowest % BUCKET_WIDTH;
+            buckets = ranked > 0 ? (highest - from) / BUCKET_WIDTH + 1 : 0;
+            if (buckets > MAX_BUCKETS) buckets = MAX_BUCKETS;
+            rankingService.getHistogram(gameId, from, BUCKET_WIDTH, buckets, counts);
+        }
+        
+        std::string response = "{" + jsonGame("game", gameId) + "," +
+            jsonInt("players", static_cast<int>(ranked)) + ",\"percentiles\":{";
+        for (int i = 0; i < 6; i++) {
+            if (i > 0) response += ",";
+            response += jsonInt(("p" + std::to_string(PERCENTILES[i])).c_str(), ranked > 0 ? eloAt[i] : 0);
+        }
+        response += "}," + jsonInt("bucketWidth", BUCKET_WIDTH) + ",\"histogram\":[";
+        for (int i = 0; i < buckets; i++) {
+            if (i > 0) response += ",";
+            response += "{" + jsonInt("from", from + i * BUCKET_WIDTH) + "," +
+                jsonInt("count", static_cast<int>(counts[i])) + "}";
+        }
+        response += "]}";
+        res.set_content(response, "application/json");
+    });
+    
+    // Seasons of a game: list of archived seasons, or one season's final
+    // standings by rank (?season=N&from=RANK&limit=COUNT, at most 100)
+    svr.Get("/api/seasons/(\\w+)", [](const http::Request& req, http::Response& res) {
+        std::string gameName = req.matches[1];
+        int gameId = gameRegistry.getId(gameName.c_str());
+        if (!gameRegistry.isValid(gameId)) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+            return;
+        }
+        
+        std::string seasonStr = req.get_param_value("season");
+        std::string fromStr = req.get_param_value("from");
+        std::string limitStr = req.get_param_value("limit");
+        int season = 0;
+        int from = 1;
+        int limit = 100;
+        if ((!seasonStr.empty() && !parseInt(seasonStr, season)) ||
+            (!fromStr.empty() && !parseInt(fromStr, from)) ||
+            (!limitStr.empty() && !parseInt(limitStr, limit))) {
+            res.status = 400;
+            res.set_content("{\"error\":\"season, from and limit must be integers\"}", "application/json");
+            return;
+        }
+        if (from < 1 || limit <= 0) {
+            res.status = 400;
+            res.set_content("{\"error\":\"from must be at least 1 and limit positive\"}", "application/json");
+            return;
+        }
+        if (limit > 100) limit = 100;
+        std::string response = "{" + jsonGame("game", gameId) + ",";
+        
+        // Archives are added with every shard locked
+        Matchmaker::ShardLock lock(matchmaker, gameId);
+        if (seasonStr.empty()) {
+            response += jsonInt("currentSeason", rankingService.getSeason(gameId)) + ",\"archived\":[";
+            for (int archived = 1; archived <= rankingService.getArchivedSeasonCount(gameId); archived++) {
+                if (archived > 1) response += ",";
+                response += "{" + jsonInt("season", archived) + "," +
+                    jsonInt("players", rankingService.getArchivedSeason(gameId, archived)->size()) + "}";
             }
+            response += "]}";
+            res.set_content(response, "application/json");
+            return;
         }
         
+        const SeasonArchive* archive = rankingService.getArchivedSeason(gameId, season);
+        if (!archive) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Season not archived\"}", "application/json");
+            return;
+        }
+        int playerIds[100];
+        int elos[100];
+        int count = archive->getPage(from, limit, playerIds, elos);
+        response += jsonInt("season", archive->getSeason()) + "," +
+            jsonInt("players", archive->size()) + ",\"leaderboard\":[";
+        for (int i = 0; i < count; i++) {
+            if (i > 0) response += ",";
+            response += "{" +
+                jsonInt("rank", from + i) + "," +
+                jsonInt("playerId", playerIds[i]) + "," +
+                jsonName("username", playerStore.indexOf(playerIds[i])) + "," +
+                jsonInt("elo", elos[i]) +
+            "}";
+        }
         response += "]}";
         res.set_content(response, "application/json");
     });
@@ -427,16 +784,19 @@ int main() {
         
         for (int i = 0; i < count; i++) {
             int opponentId = matches[i].getOpponentId(playerId);
-            Player* opponent = playerStorage.get(opponentId);
+            int opponent = playerStore.indexOf(opponentId);
             bool won = matches[i].didPlayerWin(playerId);
+            char playedAt[Clock::TIMESTAMP_BUFFER_SIZE];
+            Clock::formatTimestamp(matches[i].createdAt, playedAt, sizeof(playedAt));
             
             if (i > 0) response += ",";
             response += "{" +
                 jsonInt("matchId", matches[i].matchId) + "," +
                 jsonInt("opponentId", opponentId) + "," +
-                jsonString("opponentName", opponent ? opponent->username : "Unknown") + "," +
-                jsonString("game", matches[i].gameName) + "," +
-                jsonBool("won", won) +
+                jsonName("opponentName", opponent) + "," +
+                jsonGame("game", matches[i].gameId) + "," +
+                jsonBool("won", won) + "," +
+                jsonString("playedAt", playedAt) +
             "}";
         }
         
@@ -447,11 +807,12 @@ int main() {
     // ==================== UTILITY ENDPOINTS ====================
     
     svr.Get("/api/queues", [](const http::Request&, http::Response& res) {
-        std::string response = "{" +
-            jsonInt("pingpong", static_cast<int>(matchmaker.getQueueSize("pingpong"))) + "," +
-            jsonInt("snake", static_cast<int>(matchmaker.getQueueSize("snake"))) + "," +
-            jsonInt("tank", static_cast<int>(matchmaker.getQueueSize("tank"))) +
-        "}";
+        std::string response = "{";
+        for (int game = 0; game < gameRegistry.size(); game++) {
+            if (game > 0) response += ",";
+            response += jsonInt(gameRegistry.getName(game), static_cast<int>(matchmaker.getQueueSize(game)));
+        }
+        response += "}";
         res.set_content(response, "application/json");
     });
     
@@ -459,6 +820,83 @@ int main() {
         res.set_content("{\"status\":\"ok\"}", "application/json");
     });
     
+    // Gauges
+    svr.Get("/api/stats", [](const http::Request&, http::Response& res) {
+        std::string response = "{" +
+            jsonInt("players", playerStore.size()) + "," +
+            jsonInt("activeMatches", static_cast<int>(matchmaker.getActiveMatchCount())) + "," +
+            jsonInt("retiringMatches", static_cast<int>(matchmaker.getRetiringMatchCount())) + "," +
+            jsonInt("tickMs", static_cast<int>(matchmakingTicker.getTickNanos() / Clock::NANOS_PER_MILLI)) + "," +
+            jsonInt("tickThreads", matchmakingTicker.getThreadCount()) + "," +
+            "\"ticks\":" + std::to_string(matchmakingTicker.getTickCount()) + "," +
+            "\"tickMatches\":" + std::to_string(matchmakingTicker.getMatchesCreated()) + "," +
+            "\"lastTickMicros\":" + std::to_string(matchmakingTicker.getLastTickNanos() / 1000) +
+        "}";
+        res.set_content(response, "application/json");
+    });
+    
+    // Admin: match-quality histograms per game (queue wait, ELO gap, human vs bot)
+    // and leaderboard cache hit rate
+    svr.Get("/api/admin/matchmaking", [](const http::Request&, http::Response& res) {
+        std::string response = "{\"games\":[";
+        for (int game = 0; game < gameRegistry.size(); game++) {
+            if (game > 0) response += ",";
+            response += matchmaker.getTelemetry(game)->toJson(gameRegistry.getName(game));
+        }
+        response += "],\"leaderboardCache\":" + leaderboardCache.toJson();
+        if (persistent) response += ",\"persistence\":" + persistence.toJson();
+        response += "}";
+        res.set_content(response, "application/json");
+    });
+    
+    // Admin: end a game's season (every game if "game" is omitted) and
+    // soft-reset its ratings toward "target" keeping "keepPercent" of
+    // each rating's distance (defaults 1000 and 50)
+    svr.Post("/api/admin/season", [](const http::Request& req, http::Response& res) {
+        std::string gameName = getJsonValue(req.body, "game");
+        std::string targetStr = getJsonValue(req.body, "target");
+        std::string keepStr = getJsonValue(req.body, "keepPercent");
+        RankingService::SeasonRules defaults;
+        int target = defaults.target;
+        int keepPercent = defaults.keepPercent;
+        if ((!targetStr.empty() && !parseInt(targetStr, target)) ||
+            (!keepStr.empty() && !parseInt(keepStr, keepPercent))) {
+            res.status = 400;
+            res.set_content("{\"error\":\"target and keepPercent must be integers\"}", "application/json");
+            return;
+        }
+        if (target < RankingService::MIN_RATING || target >= RankingService::MIN_RATING + RankingService::RATING_RANGE) {
+            res.status = 400;
+            res.set_content("{\"error\":\"target out of rating range\"}", "application/json");
+            return;
+        }
+        RankingService::SeasonRules rules(target, keepPercent);
+        
+        int only = GameRegistry::NO_GAME;
+        if (!gameName.empty()) {
+            only = gameRegistry.getId(gameName.c_str());
+            if (!gameRegistry.isValid(only)) {
+                res.status = 404;
+                res.set_content("{\"error\":\"Unknown game\"}", "application/json");
+                return;
+            }
+        }
+        
+        std::string response = "{\"games\":[";
+        bool first = true;
+        for (int game = 0; game < gameRegistry.size(); game++) {
+            if (only != GameRegistry::NO_GAME && game != only) continue;
+            int season = matchmaker.startSeason(game, rules);
+            if (!first) response += ",";
+            first = false;
+            response += "{" + jsonGame("game", game) + "," + jsonInt("season", season) + "}";
+            printf("[Server] %s season %d started\n", gameRegistry.getName(game), season);
+        }
+        response += "]}";
+        stateLog.sync();
+        res.set_content(response, "application/json");
+    });
+    
     // Logout endpoint - removes player from queue and clears session
     svr.Post("/api/logout", [](const http::Request& req, http::Response& res) {
         std::string playerIdStr = getJsonValue(req.body, "playerId");
@@ -470,23 +908,17 @@ int main() {
         }
         
         int playerId = std::stoi(playerIdStr);
-        Player* player = playerStorage.get(playerId);
+        int index = playerStore.indexOf(playerId);
         
-        if (!player) {
+        if (index == PlayerStore::NO_PLAYER) {
             res.status = 404;
             res.set_content("{\"error\":\"Player not found\"}", "application/json");
             return;
         }
         
-        // Leave any queues
-        const char* games[] = {"pingpong", "snake", "tank"};
-        for (int i = 0; i < 3; i++) {
-            matchmaker.leaveQueue(playerId, games[i]);
-        }
-        
-        // Update player state
-        player->isInQueue = false;
-        playerStorage.update(playerId, *player);
+        // Leave whichever queue the player is in
+        matchmaker.leaveCurrentQueue(playerId);
+        stateLog.sync();
         
         res.set_content("{\"success\":true}", "application/json");
     });
@@ -494,12 +926,88 @@ int main() {
     printf("======================================\n");
     printf("  Multiplayer Game System Backend\n");
     printf("======================================\n");
-    printf("\nInitializing bot players...\n");
-    initializeBots();
+    long long startupAt = Clock::monotonicNanos();
+    // Game list is configuration (comma-separated, e.g. ARENA_GAMES=pingpong,snake,tank)
+    const char* gameList = getenv("ARENA_GAMES");
+    if (gameList && gameRegistry.configure(gameList) == 0) {
+        gameRegistry.configure(GameRegistry::defaultGames());
+    }
+    printf("Games: %d\n", gameRegistry.size());
+    playerStore.setGameCount(gameRegistry.size());  // One rating column per game
+    
+    // Completed matches stay readable by ID for this long (default 30s)
+    const char* graceSeconds = getenv("ARENA_MATCH_GRACE_SECONDS");
+    if (graceSeconds) {
+        matchmaker.setCompletedMatchGrace(atoll(graceSeconds) * Clock::NANOS_PER_SECOND);
+    }
+    
+    // ARENA_RATING=glicko2: Glicko-2 applied once per rating period
+    // (ARENA_RATING_PERIOD_SECONDS, default 60) instead of ELO per result
+    const char* ratingSystem = getenv("ARENA_RATING");
+    if (ratingSystem && strcmp(ratingSystem, "glicko2") == 0) {
+        rankingService.setRatingSystem(RankingService::GLICKO2);
+        const char* periodSeconds = getenv("ARENA_RATING_PERIOD_SECONDS");
+        if (periodSeconds && atoll(periodSeconds) > 0) {
+            matchmaker.setRatingPeriodNanos(atoll(periodSeconds) * Clock::NANOS_PER_SECOND);
+        }
+        printf("Rating: Glicko-2, %lld s rating periods\n", matchmaker.getRatingPeriodNanos() / Clock::NANOS_PER_SECOND);
+    }
+    
+    // ARENA_DATA_DIR: keep all state across restarts - a snapshot plus a
+    // write-ahead log, restored here before matchmaking starts
+    const char* dataDir = getenv("ARENA_DATA_DIR");
+    if (dataDir && *dataDir) {
+        persistent = persistence.restore(dataDir);
+        if (persistent) {
+            const Persistence::RestoreStats& restored = persistence.getRestoreStats();
+            printf("Restored %d players from %s (player image %.1f MB mapped in %.1f ms, snapshot %.1f MB in %.0f ms "
+                   "with pools and ranking trees built on %d threads in %.0f ms, %lld logged operations in %.0f ms)\n",
+                   restored.players, dataDir, restored.imageBytes / 1048576.0, restored.playersNanos / 1e6,
+                   restored.snapshotBytes / 1048576.0, restored.snapshotNanos / 1e6, restored.buildThreads,
+                   restored.buildNanos / 1e6, restored.records, restored.replayNanos / 1e6);
+            if (restored.failedRecords > 0) {
+                printf("  %d logged operations no longer applied\n", restored.failedRecords);
+            }
+        } else {
+            printf("Persistence off: %s could not be restored (left untouched)\n", dataDir);
+        }
+    }
+    
+    if (playerStore.size() > 0) {
+        // Restored: bots are already registered; new IDs follow the highest in use
+        for (int index = 0; index < playerStore.size(); index++) {
+            if (playerStore.getId(index) >= nextPlayerId) nextPlayerId = playerStore.getId(index) + 1;
+        }
+    } else {
+        printf("\nInitializing bot players...\n");
+        initializeBots();
+    }
+    
+    if (persistent) {
+        // Snapshot every ARENA_SNAPSHOT_SECONDS (default 300) if anything changed
+        const char* snapshotSeconds = getenv("ARENA_SNAPSHOT_SECONDS");
+        if (snapshotSeconds && atoll(snapshotSeconds) > 0) {
+            persistence.setSnapshotIntervalNanos(atoll(snapshotSeconds) * Clock::NANOS_PER_SECOND);
+        }
+        persistent = persistence.start();
+        printf("Persistence: %s (%s)\n", dataDir, persistent ? "snapshot + write-ahead log" : "failed to start, off");
+    }
+    
+    // Each game is matched on its own thread every ARENA_TICK_MS (default 100ms)
+    const char* tickMillis = getenv("ARENA_TICK_MS");
+    if (tickMillis && atoll(tickMillis) > 0) {
+        matchmakingTicker.setTickNanos(atoll(tickMillis) * Clock::NANOS_PER_MILLI);
+    }
+    matchmakingTicker.start();
+    printf("Matchmaking tick: %lld ms (%d shard threads)\n",
+           matchmakingTicker.getTickNanos() / Clock::NANOS_PER_MILLI, matchmakingTicker.getThreadCount());
+    
+    printf("Ready in %.1f ms\n", (Clock::monotonicNanos() - startupAt) / 1e6);
     printf("Server starting on http://localhost:8080\n");
     printf("Press Ctrl+C to stop\n\n");
     
     svr.listen("0.0.0.0", 8080);
     
+    matchmakingTicker.stop();
     return 0;
 }
@@ -0,0 +1,247 @@
+#ifndef BATCH_MATCHER_H
+#define BATCH_MATCHER_H
+
+#include "../ds/Sort.h"
+
+/**
+ * BatchMatcher - Minimum-cost pairing of a queue snapshot
+ *
+ * Given every player waiting in one game's queue, choose which pairs to
+ * match so that the total ELO gap over all pairs, plus a penalty for each
+ * player left waiting, is as small as possible:
+ *
+ *   cost = sum |elo(a) - elo(b)| over matched pairs
+ *        + sum skipCost(p)       over unmatched players
+ *
+ * The caller sets skipCost from wait time, so players who have waited
+ * longer are more expensive to leave behind and get paired first, at the
+ * price of a wider gap.
+ *
+ * ALGORITHM:
+ * 1. Sort candidates by ELO (stable, so equal ELOs keep queue order)
+ * 2. In an optimal pairing, matched pairs never cross or nest in ELO
+ *    order, so each pair is an interval whose interior players are
+ *    skipped. That gives a linear DP over the sorted order:
+ *      best[p+1] = min( best[p] + skip(p),
+ *                       min over q<p of best[q] + e[p] - e[q] + skips(q+1..p-1) )
+ *    The inner min is a running minimum of best[q] - e[q] - prefixSkip[q+1],
+ *    so each step is O(1).
+ * 3. Walk the choices back to recover the pairs
+ *
+ * CELLS (pairAcrossCells):
+ * Candidates may also sit in cells (e.g. latency bucket x input device)
+ * with a fixed penalty between two cells, or none allowed. The pair cost
+ * becomes e[p] - e[q] + penalty(cell p, cell q), and the running minimum
+ * is kept per cell, so each step checks every cell once and incompatible
+ * cells are never paired. Penalties break the no-nesting argument, so the
+ * result is the best pairing without nested pairs rather than the global
+ * optimum; callers pair each cell on its own first (pair(), where it is
+ * exact) and use this for the players left over.
+ *
+ * Time Complexity:
+ *   - pair(): O(n log n) for the sort, O(n) for the DP and backtrack
+ *   - pairAcrossCells(): O(n log n) for the sort, O(n * cells) for the DP
+ *
+ * Scratch buffers are kept between calls and only grow.
+ */
+class BatchMatcher {
+public:
+    static const int NO_PARTNER = -1;
+
+private:
+    int* order;           // Candidate indexes sorted by ELO
+    int* sortScratch;
+    long long* best;      // best[p] = min cost of the first p sorted candidates
+    long long* prefixSkip;
+    int* choice;          // Sorted position paired with p, or NO_PARTNER if skipped
+    int capacity;
+    long long* cellMin;   // Running minimum per cell (pairAcrossCells)
+    int* cellAt;
+    int cellCapacity;
+
+    // Orders candidate indexes by ELO
+    struct ByElo {
+        const int* elos;
+        explicit ByElo(const int* e) : elos(e) {}
+        bool operator()(int a, int b) const { return elos[a] < elos[b]; }
+    };
+
+    void release() {
+        delete[] order;
+        delete[] sortScratch;
+        delete[] best;
+        delete[] prefixSkip;
+        delete[] choice;
+    }
+
+    // Grow the per-cell running minimums to hold count cells
+    void reserveCells(int count) {
+        if (count <= cellCapacity) return;
+        delete[] cellMin;
+        delete[] cellAt;
+        cellMin = new long long[count];
+        cellAt = new int[count];
+        cellCapacity = count;
+    }
+
+    // Sort candidates by ELO and fill prefixSkip
+    void prepare(const int* elos, const long long* skipCosts, int count) {
+        reserve(count);
+        for (int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        mergeSort(order, sortScratch, static_cast<size_t>(count), ByElo(elos));
+
+        prefixSkip[0] = 0;
+        for (int p = 0; p < count; p++) {
+            prefixSkip[p + 1] = prefixSkip[p] + skipCosts[order[p]];
+        }
+    }
+
+    // Recover pairs from the right end
+    int backtrack(int count, int* partner) {
+        int pairs = 0;
+        int p = count - 1;
+        while (p >= 0) {
+            int q = choice[p];
+            if (q == NO_PARTNER) {
+                p--;
+                continue;
+            }
+            partner[order[p]] = order[q];
+            partner[order[q]] = order[p];
+            pairs++;
+            p = q - 1;
+        }
+        return pairs;
+    }
+
+    // Grow scratch buffers to hold count candidates
+    void reserve(int count) {
+        if (count <= capacity) return;
+        int newCapacity = capacity == 0 ? 64 : capacity;
+        while (newCapacity < count) newCapacity *= 2;
+
+        release();
+        order = new int[newCapacity];
+        sortScratch = new int[newCapacity];
+        best = new long long[newCapacity + 1];
+        prefixSkip = new long long[newCapacity + 1];
+        choice = new int[newCapacity];
+        capacity = newCapacity;
+    }
+
+public:
+    BatchMatcher()
+        : order(nullptr), sortScratch(nullptr), best(nullptr),
+          prefixSkip(nullptr), choice(nullptr), capacity(0),
+          cellMin(nullptr), cellAt(nullptr), cellCapacity(0) {}
+
+    ~BatchMatcher() {
+        release();
+        delete[] cellMin;
+        delete[] cellAt;
+    }
+
+    BatchMatcher(const BatchMatcher&) = delete;
+    BatchMatcher& operator=(const BatchMatcher&) = delete;
+
+    /**
+     * Compute the minimum-cost pairing of a snapshot
+     *
+     * @param elos ELO of each candidate (any order)
+     * @param skipCosts Cost of leaving each candidate unmatched, in ELO points
+     * @param count Number of candidates
+     * @param partner Output: partner candidate index, or NO_PARTNER
+     * @return Number of pairs
+     */
+    int pair(const int* elos, const long long* skipCosts, int count, int* partner) {
+        for (int i = 0; i < count; i++) {
+            partner[i] = NO_PARTNER;
+        }
+        if (count < 2) return 0;
+        prepare(elos, skipCosts, count);
+
+        // Running min of best[q] - e[q] - prefixSkip[q + 1] over q < p
+        best[0] = 0;
+        long long openMin = 0;
+        int openAt = NO_PARTNER;
+
+        for (int p = 0; p < count; p++) {
+            long long elo = elos[order[p]];
+
+            best[p + 1] = best[p] + skipCosts[order[p]];
+            choice[p] = NO_PARTNER;
+
+            if (openAt != NO_PARTNER) {
+                long long paired = openMin + elo + prefixSkip[p];
+                if (paired < best[p + 1]) {
+                    best[p + 1] = paired;
+                    choice[p] = openAt;
+                }
+            }
+
+            // p becomes a possible left end for later candidates
+            long long open = best[p] - elo - prefixSkip[p + 1];
+            if (openAt == NO_PARTNER || open < openMin) {
+                openMin = open;
+                openAt = p;
+            }
+        }
+
+        return backtrack(count, partner);
+    }
+
+    /**
+     * Pairing of a snapshot whose candidates sit in cells with a fixed
+     * penalty between cells (see CELLS above)
+     *
+     * @param cells Cell of each candidate, 0..cellCount-1
+     * @param penalty penalty(cellA, cellB) -> ELO points, or a negative
+     *        value if the two cells may not be paired
+     * @return Number of pairs
+     */
+    template <typename Penalty>
+    int pairAcrossCells(const int* elos, const long long* skipCosts, const int* cells, int cellCount,
+                        int count, int* partner, Penalty penalty) {
+        for (int i = 0; i < count; i++) {
+            partner[i] = NO_PARTNER;
+        }
+        if (count < 2) return 0;
+        prepare(elos, skipCosts, count);
+        reserveCells(cellCount);
+        for (int c = 0; c < cellCount; c++) {
+            cellAt[c] = NO_PARTNER;
+        }
+
+        best[0] = 0;
+        for (int p = 0; p < count; p++) {
+            long long elo = elos[order[p]];
+            int cell = cells[order[p]];
+
+            best[p + 1] = best[p] + skipCosts[order[p]];
+            choice[p] = NO_PARTNER;
+
+            for (int c = 0; c < cellCount; c++) {
+                if (cellAt[c] == NO_PARTNER) continue;
+                int fixed = penalty(cell, c);
+                if (fixed < 0) continue;
+                long long paired = cellMin[c] + elo + fixed + prefixSkip[p];
+                if (paired < best[p + 1]) {
+                    best[p + 1] = paired;
+                    choice[p] = cellAt[c];
+                }
+            }
+
+            long long open = best[p] - elo - prefixSkip[p + 1];
+            if (cellAt[cell] == NO_PARTNER || open < cellMin[cell]) {
+                cellMin[cell] = open;
+                cellAt[cell] = p;
+            }
+        }
+
+        return backtrack(count, partner);
+    }
+};
+
+#endif // BATCH_MATCHER_H
@@ -0,0 +1,265 @@
+#ifndef BOT_POOL_H
+#define BOT_POOL_H
+
+#include "../ds/Bitset.h"
+#include "../ds/HashTable.h"
+#include "../ds/Sort.h"
+
+/**
+ * BotPool - One game's bots, sorted by ELO, with an availability bitset
+ *
+ * Bots are kept in an array ordered by (ELO, player index). Bit i of the
+ * availability bitset is set while the bot at position i is free (not in a
+ * match). Finding the closest free bot to an ELO is a binary search for
+ * the insertion point followed by a bitset scan outward in both
+ * directions; bots rejected by the caller (recent opponents) are stepped
+ * over, so the cost stays independent of the pool size.
+ *
+ * Bulk registration appends unsorted and sorts once on first use (addAll()
+ * sizes everything once and sorts immediately). A bot's
+ * ELO change after a match moves it to its new position by shifting its
+ * neighbours - ELO deltas are small, so the move is short.
+ *
+ * Time Complexity:
+ *   - add(): O(1) amortized (sorted lazily, O(n log n) once)
+ *   - addAll(): O(n log n) for the whole pool, one allocation per array
+ *   - findClosest(): O(log n + word scan + rejected bots)
+ *   - setAvailable(): O(1) average
+ *   - updateElo(): O(positions moved)
+ *   - rekeyAll(): O(n) (sorted lazily)
+ */
+class BotPool {
+public:
+    static const int NO_BOT = -1;
+
+private:
+    struct Slot {
+        int elo;
+        int playerIndex;
+        bool available;  // Only used while re-sorting; the bitset is authoritative
+    };
+
+    struct ByEloThenIndex {
+        bool operator()(const Slot& a, const Slot& b) const {
+            if (a.elo != b.elo) return a.elo < b.elo;
+            return a.playerIndex < b.playerIndex;
+        }
+    };
+
+    Slot* slots;
+    Slot* scratch;
+    int count;
+    int capacity;
+    bool sorted;
+
+    Bitset available;
+    HashTable<int, int> positionOf;  // Player index -> position in slots
+
+    void grow(int needed) {
+        int newCapacity = capacity == 0 ? 64 : capacity * 2;
+        while (newCapacity < needed) newCapacity *= 2;
+        Slot* newSlots = new Slot[newCapacity];
+        for (int i = 0; i < count; i++) {
+            newSlots[i] = slots[i];
+        }
+        delete[] slots;
+        delete[] scratch;
+        slots = newSlots;
+        scratch = new Slot[newCapacity];
+        capacity = newCapacity;
+    }
+
+    static bool before(const Slot& a, int elo, int playerIndex) {
+        return a.elo < elo || (a.elo == elo && a.playerIndex < playerIndex);
+    }
+
+    // Sort after bulk adds, carrying availability along with each bot
+    void ensureSorted() {
+        if (sorted) return;
+        for (int i = 0; i < count; i++) {
+            slots[i].available = available.test(i);
+        }
+        mergeSort(slots, scratch, static_cast<size_t>(count), ByEloThenIndex());
+        available.clearAll();
+        for (int i = 0; i < count; i++) {
+            positionOf.insert(slots[i].playerIndex, i);
+            if (slots[i].available) available.set(i);
+        }
+        sorted = true;
+    }
+
+    // First position whose ELO is >= elo - O(log n)
+    int lowerBound(int elo) const {
+        int low = 0, high = count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (slots[mid].elo < elo) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+
+    // Move a slot between positions, keeping bitset and positions in step
+    void place(int position, const Slot& slot, bool isAvailable) {
+        slots[position] = slot;
+        positionOf.insert(slot.playerIndex, position);
+        if (isAvailable) available.set(position);
+        else available.clear(position);
+    }
+
+public:
+    BotPool()
+        : slots(nullptr), scratch(nullptr), count(0), capacity(0), sorted(true) {}
+
+    ~BotPool() {
+        delete[] slots;
+        delete[] scratch;
+    }
+
+    BotPool(const BotPool&) = delete;
+    BotPool& operator=(const BotPool&) = delete;
+
+    /**
+     * Add a bot (available) - no cap on pool size
+     *
+     * @return false if the bot is already in the pool
+     */
+    bool add(int playerIndex, int elo) {
+        if (positionOf.contains(playerIndex)) return false;
+        if (count == capacity) grow(count + 1);
+
+        Slot slot;
+        slot.elo = elo;
+        slot.playerIndex = playerIndex;
+        slot.available = true;
+
+        available.resize(static_cast<size_t>(count) + 1);
+        place(count, slot, true);
+        count++;
+        sorted = false;
+        return true;
+    }
+
+    /**
+     * Add many bots (all available) and sort the pool now
+     *
+     * The slots and the bitset grow once for the whole batch, and
+     * positions are recorded once, by the sort. playerIndexes must be
+     * distinct; bots already in the pool are skipped.
+     */
+    void addAll(const int* playerIndexes, const int* elos, int added) {
+        if (count + added > capacity) grow(count + added);
+        available.resize(static_cast<size_t>(count) + added);
+        for (int i = 0; i < added; i++) {
+            if (positionOf.contains(playerIndexes[i])) continue;
+            slots[count].elo = elos[i];
+            slots[count].playerIndex = playerIndexes[i];
+            slots[count].available = true;
+            available.set(count);
+            count++;
+        }
+        available.resize(static_cast<size_t>(count));
+        sorted = false;
+        ensureSorted();
+    }
+
+    // Mark a bot free / busy - O(1) average
+    void setAvailable(int playerIndex, bool isAvailable) {
+        const int* position = positionOf.get(playerIndex);
+        if (!position) return;
+        if (isAvailable) available.set(*position);
+        else available.clear(*position);
+    }
+
+    /**
+     * Re-position a bot after its ELO changed
+     *
+     * Time Complexity: O(positions moved)
+     */
+    void updateElo(int playerIndex, int newElo) {
+        const int* found = positionOf.get(playerIndex);
+        if (!found) return;
+        int position = *found;
+        if (!sorted) {
+            slots[position].elo = newElo;
+            return;
+        }
+
+        Slot moving = slots[position];
+        bool isAvailable = available.test(position);
+        moving.elo = newElo;
+
+        // Shift neighbours over the gap until the order holds again
+        while (position > 0 && !before(slots[position - 1], newElo, playerIndex)) {
+            place(position, slots[position - 1], available.test(position - 1));
+            position--;
+        }
+        while (position + 1 < count && before(slots[position + 1], newElo, playerIndex)) {
+            place(position, slots[position + 1], available.test(position + 1));
+            position++;
+        }
+        place(position, moving, isAvailable);
+    }
+
+    /**
+     * Re-key every bot at once (e.g. after a season reset)
+     *
+     * eloOf(playerIndex) gives each bot's new ELO; the pool is re-sorted
+     * lazily on next use.
+     *
+     * Time Complexity: O(n), plus the O(n log n) sort on next use
+     */
+    template <typename EloOf>
+    void rekeyAll(EloOf eloOf) {
+        for (int i = 0; i < count; i++) {
+            slots[i].elo = eloOf(slots[i].playerIndex);
+        }
+        if (count > 0) sorted = false;
+    }
+
+    /**
+     * Find the free bot with the closest ELO
+     *
+     * Walks outward from targetElo over free bots only (bitset scan),
+     * stepping over bots for which reject(playerIndex) is true.
+     *
+     * @param reject Functor: true if the bot must be skipped (recent opponent)
+     * @param usedFallback Set to true if every free bot was rejected and the
+     *                     closest free bot is returned anyway
+     * @return Player index of the bot, or NO_BOT if none is free
+     */
+    template <typename Reject>
+    int findClosest(int targetElo, Reject reject, bool& usedFallback) {
+        usedFallback = false;
+        if (count == 0) return NO_BOT;
+        ensureSorted();
+
+        int start = lowerBound(targetElo);
+        long long right = available.findNext(static_cast<size_t>(start));
+        long long left = available.findPrevious(static_cast<long long>(start) - 1);
+        int fallback = NO_BOT;
+
+        while (left != Bitset::NONE || right != Bitset::NONE) {
+            // Take whichever side is closer (ties go to the lower ELO)
+            bool takeLeft = right == Bitset::NONE ||
+                (left != Bitset::NONE && targetElo - slots[left].elo <= slots[right].elo - targetElo);
+            int position = static_cast<int>(takeLeft ? left : right);
+            int playerIndex = slots[position].playerIndex;
+
+            if (fallback == NO_BOT) fallback = playerIndex;
+            if (!reject(playerIndex)) return playerIndex;
+
+            if (takeLeft) left = available.findPrevious(static_cast<long long>(position) - 1);
+            else right = available.findNext(static_cast<size_t>(position) + 1);
+        }
+
+        usedFallback = fallback != NO_BOT;
+        return fallback;
+    }
+
+    int size() const {
+        return count;
+    }
+};
+
+#endif // BOT_POOL_H
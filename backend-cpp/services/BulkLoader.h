@@ -0,0 +1,193 @@
+#ifndef BULK_LOADER_H
+#define BULK_LOADER_H
+
+#include "PlayerStore.h"
+#include "RankingService.h"
+#include "Matchmaker.h"
+#include "GameRegistry.h"
+#include "Clock.h"
+#include <thread>
+
+/**
+ * BulkLoader - Startup construction of bots, bot pools and ranking trees
+ *
+ * Creating bots one at a time costs, per bot, a create(), a registerBot()
+ * (one shard lock and a pool append) and an addPlayerToRanking() (ID
+ * lookup, AVL insert with rotations, version bump). A BulkLoader collects
+ * the work first and builds each structure once:
+ *
+ *   1. addBot() creates the bot in the PlayerStore (single writer) and
+ *      plans it for its game's pool and tree; addPoolBot() / addRanked()
+ *      plan players that already exist (snapshot restore)
+ *   2. build() gives every game with planned work its own thread, which
+ *      registers the game's bots in one batch (BotPool::addAll - one
+ *      allocation, one sort) and fills the game's empty ranking tree and
+ *      distribution in one pass each (RankingService::buildRanking)
+ *
+ * Games share nothing in these structures, so the per-game builds run in
+ * parallel without contention. getReport() gives the time from the first
+ * add to the end of build() (time to ready), summed over builds.
+ *
+ * Use while the services are idle (startup, before ticks or requests).
+ *
+ * Time Complexity:
+ *   - addBot(), addPoolBot(), addRanked(): O(1) amortized
+ *   - build(): per game, O(b log b) for b bots (pool sort) plus O(n + R)
+ *     for n ranked players planned in key order (O(n log n) otherwise),
+ *     games in parallel
+ */
+class BulkLoader {
+public:
+    struct Report {
+        int bots;             // Created by addBot()
+        int pooled;           // Registered in bot pools
+        int ranked;           // Entered into ranking trees
+        int threads;          // Games built in parallel
+        long long addNanos;   // First add to build()
+        long long buildNanos; // build()
+
+        Report() : bots(0), pooled(0), ranked(0), threads(0), addNanos(0), buildNanos(0) {}
+
+        long long readyNanos() const { return addNanos + buildNanos; }
+    };
+
+private:
+    // Growable list of player indexes
+    struct IndexList {
+        int* items;
+        int count;
+        int capacity;
+
+        IndexList() : items(nullptr), count(0), capacity(0) {}
+        ~IndexList() { delete[] items; }
+
+        void add(int value) {
+            if (count == capacity) {
+                int newCapacity = capacity == 0 ? 64 : capacity * 2;
+                int* grown = new int[newCapacity];
+                for (int i = 0; i < count; i++) grown[i] = items[i];
+                delete[] items;
+                items = grown;
+                capacity = newCapacity;
+            }
+            items[count++] = value;
+        }
+
+        void clear() {
+            delete[] items;
+            items = nullptr;
+            count = 0;
+            capacity = 0;
+        }
+    };
+
+    PlayerStore* players;
+    RankingService* rankingService;
+    Matchmaker* matchmaker;
+    const GameRegistry* games;
+
+    // One game's planned work (player indexes)
+    struct GamePlan {
+        IndexList bots;
+        IndexList ranked;
+    };
+
+    GamePlan plans[GameRegistry::MAX_GAMES];
+    long long firstAddAt;  // 0 until something is planned
+    Report report;
+
+    void planned() {
+        if (firstAddAt == 0) firstAddAt = Clock::monotonicNanos();
+    }
+
+    void buildGame(int gameId) {
+        if (!games->isValid(gameId)) return;
+        const GamePlan& plan = plans[gameId];
+        if (plan.bots.count > 0) matchmaker->registerBots(plan.bots.items, plan.bots.count, gameId);
+        if (plan.ranked.count > 0) rankingService->buildRanking(plan.ranked.items, plan.ranked.count, gameId);
+    }
+
+public:
+    BulkLoader(PlayerStore* store, RankingService* ranking, Matchmaker* mm, const GameRegistry* registry)
+        : players(store), rankingService(ranking), matchmaker(mm), games(registry), firstAddAt(0) {}
+
+    BulkLoader(const BulkLoader&) = delete;
+    BulkLoader& operator=(const BulkLoader&) = delete;
+
+    /**
+     * Create a bot for a game and plan it for that game's pool and tree
+     *
+     * @return The bot's player index, or PlayerStore::NO_PLAYER if the ID
+     *         is taken or the game is invalid
+     */
+    int addBot(int playerId, const char* name, int elo, int gameId) {
+        if (!games->isValid(gameId)) return PlayerStore::NO_PLAYER;
+        planned();
+        int index = players->create(playerId, name, elo, true);
+        if (index == PlayerStore::NO_PLAYER) return PlayerStore::NO_PLAYER;
+        players->getProfile(index).setPreferredGame(gameId);
+        plans[gameId].bots.add(index);
+        plans[gameId].ranked.add(index);
+        report.bots++;
+        return index;
+    }
+
+    // Plan an existing bot (by index) for a game's pool
+    void addPoolBot(int index, int gameId) {
+        if (!games->isValid(gameId)) return;
+        planned();
+        plans[gameId].bots.add(index);
+    }
+
+    /**
+     * Plan an existing player (by index) for a game's ranking tree; adding
+     * a game's players in key order (ELO, then ID) skips the sort
+     */
+    void addRanked(int index, int gameId) {
+        if (!games->isValid(gameId)) return;
+        planned();
+        plans[gameId].ranked.add(index);
+    }
+
+    /**
+     * Build every planned pool and tree, one thread per game with work
+     *
+     * The games' ranking trees must still be empty.
+     */
+    void build() {
+        long long start = Clock::monotonicNanos();
+        if (firstAddAt > 0) report.addNanos += start - firstAddAt;
+
+        int busyCount = 0;
+        for (int g = 0; g < games->size(); g++) {
+            if (plans[g].bots.count > 0 || plans[g].ranked.count > 0) busyCount++;
+            report.pooled += plans[g].bots.count;
+            report.ranked += plans[g].ranked.count;
+        }
+
+        // One game builds on this thread; more get a thread each
+        std::thread workers[GameRegistry::MAX_GAMES];
+        for (int g = 0; g < games->size(); g++) {
+            if (plans[g].bots.count == 0 && plans[g].ranked.count == 0) continue;
+            if (busyCount == 1) buildGame(g);
+            else workers[g] = std::thread(&BulkLoader::buildGame, this, g);
+        }
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            if (workers[g].joinable()) workers[g].join();
+        }
+
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            plans[g].bots.clear();
+            plans[g].ranked.clear();
+        }
+        firstAddAt = 0;
+        if (busyCount > report.threads) report.threads = busyCount;
+        report.buildNanos += Clock::monotonicNanos() - start;
+    }
+
+    const Report& getReport() const {
+        return report;
+    }
+};
+
+#endif // BULK_LOADER_H
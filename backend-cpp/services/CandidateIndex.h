@@ -0,0 +1,152 @@
+#ifndef CANDIDATE_INDEX_H
+#define CANDIDATE_INDEX_H
+
+#include "../ds/AVLTree.h"
+#include "../models/Player.h"
+#include "../models/MatchAttributes.h"
+#include <climits>
+
+/**
+ * CandidateIndex - Queued players indexed by ELO, latency bucket and device
+ *
+ * One ranking tree per (latency bucket, device) cell. The distance between
+ * two players folds every dimension into ELO points:
+ *
+ *   cost = |elo gap| + LATENCY_STEP_ELO * |bucket gap| + device penalty
+ *
+ * where the device penalty is 0 for the same device, CROSS_DEVICE_ELO for
+ * keyboard/mouse vs. controller, and touch vs. anything else is not
+ * allowed. Buckets more than MAX_LATENCY_DISTANCE apart are never paired.
+ * A candidate is acceptable when its cost fits inside the searcher's
+ * acceptance window, so latency and cross-play spend the same budget as
+ * the ELO gap.
+ *
+ * SEARCH (findNearest):
+ * Only compatible cells are visited - at most (2 * MAX_LATENCY_DISTANCE + 1)
+ * buckets times the compatible devices - in order of their fixed penalty.
+ * In each, an ELO range query covers what is left of the budget after the
+ * penalty and the best cost found so far, so once a close candidate is
+ * found, farther cells are skipped or narrowed to a few nodes. No queue
+ * scan is involved.
+ *
+ * Time Complexity:
+ *   - insert(), remove(): O(log n)
+ *   - findNearest(): O(C log n + k) for C compatible cells and k
+ *     candidates visited inside the remaining windows
+ */
+class CandidateIndex {
+public:
+    static const int LATENCY_STEP_ELO = 50;
+    static const int MAX_LATENCY_DISTANCE = 2;
+    static const int CROSS_DEVICE_ELO = 100;
+    static const int INCOMPATIBLE = -1;
+
+private:
+    AVLTree<PlayerELO> cells[MatchAttributes::LATENCY_BUCKETS][MatchAttributes::DEVICE_COUNT];
+    size_t count;
+
+public:
+    CandidateIndex() : count(0) {}
+
+    // Penalty between two devices in ELO points, or INCOMPATIBLE
+    static int devicePenalty(int a, int b) {
+        if (a == b) return 0;
+        if (a == MatchAttributes::TOUCH || b == MatchAttributes::TOUCH) return INCOMPATIBLE;
+        return CROSS_DEVICE_ELO;
+    }
+
+    // Fixed (non-ELO) part of the cost between two players, or INCOMPATIBLE
+    static int penalty(const MatchAttributes& a, const MatchAttributes& b) {
+        int distance = a.latencyBucket > b.latencyBucket ? a.latencyBucket - b.latencyBucket
+                                                         : b.latencyBucket - a.latencyBucket;
+        int device = devicePenalty(a.device, b.device);
+        if (distance > MAX_LATENCY_DISTANCE || device == INCOMPATIBLE) return INCOMPATIBLE;
+        return distance * LATENCY_STEP_ELO + device;
+    }
+
+    void insert(int playerId, int elo, const MatchAttributes& attributes) {
+        AVLTree<PlayerELO>& cell = cells[attributes.latencyBucket][attributes.device];
+        size_t before = cell.size();
+        cell.insert(PlayerELO(elo, playerId));
+        count += cell.size() - before;
+    }
+
+    // elo and attributes must be the values the player was inserted with
+    bool remove(int playerId, int elo, const MatchAttributes& attributes) {
+        if (!cells[attributes.latencyBucket][attributes.device].remove(PlayerELO(elo, playerId))) return false;
+        count--;
+        return true;
+    }
+
+    /**
+     * Lowest-cost compatible candidate within a window
+     *
+     * @param playerId Searching player (never returned)
+     * @param window Maximum total cost, in ELO points
+     * @param accept Filter: accept(candidateId) -> bool
+     * @param outCost Cost of the candidate found (optional)
+     * @return Candidate's PlayerID, or -1
+     */
+    template <typename Accept>
+    int findNearest(int playerId, int elo, const MatchAttributes& attributes, int window,
+                    Accept accept, int* outCost = nullptr) const {
+        int bestId = -1;
+        int bestCost = window + 1;
+
+        // Cells in order of penalty: bucket distance 0, 1, 2 (both sides),
+        // same device before cross-play
+        for (int distance = 0; distance <= MAX_LATENCY_DISTANCE; distance++) {
+            for (int side = -1; side <= 1; side += 2) {
+                if (distance == 0 && side == 1) continue;
+                int bucket = attributes.latencyBucket + side * distance;
+                if (bucket < 0 || bucket >= MatchAttributes::LATENCY_BUCKETS) continue;
+
+                for (int pass = 0; pass < 2; pass++) {
+                    for (int device = 0; device < MatchAttributes::DEVICE_COUNT; device++) {
+                        if ((device == attributes.device) != (pass == 0)) continue;
+                        int devicePart = devicePenalty(attributes.device, device);
+                        if (devicePart == INCOMPATIBLE) continue;
+
+                        int fixed = distance * LATENCY_STEP_ELO + devicePart;
+                        int budget = bestCost - 1 - fixed;  // Largest ELO gap that still improves
+                        if (budget < 0) continue;
+
+                        const AVLTree<PlayerELO>& cell = cells[bucket][device];
+                        if (cell.size() == 0) continue;
+                        cell.rangeTraversal(PlayerELO(elo - budget, INT_MIN), PlayerELO(elo + budget, INT_MAX),
+                                            [&](const PlayerELO& entry) {
+                            int gap = entry.elo > elo ? entry.elo - elo : elo - entry.elo;
+                            int cost = gap + fixed;
+                            if (entry.elo > elo && cost >= bestCost) return false;  // Only farther from here on
+                            if (entry.playerId != playerId && cost < bestCost && accept(entry.playerId)) {
+                                bestCost = cost;
+                                bestId = entry.playerId;
+                            }
+                            return true;
+                        });
+                    }
+                }
+            }
+        }
+
+        if (outCost) *outCost = bestId == -1 ? 0 : bestCost;
+        return bestId;
+    }
+
+    // Drop every candidate - O(n)
+    void clear() {
+        for (int bucket = 0; bucket < MatchAttributes::LATENCY_BUCKETS; bucket++) {
+            for (int device = 0; device < MatchAttributes::DEVICE_COUNT; device++) {
+                cells[bucket][device].clear();
+            }
+        }
+        count = 0;
+    }
+
+    // Number of indexed candidates
+    size_t size() const {
+        return count;
+    }
+};
+
+#endif // CANDIDATE_INDEX_H
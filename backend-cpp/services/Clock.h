@@ -0,0 +1,124 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+
+/**
+ * Clock - Cheap time source for matchmaking and match records
+ *
+ * Two clocks, both returned as plain integers:
+ *   - monotonicNanos(): steady clock, used for queue wait times. Never
+ *     jumps when the system time is changed.
+ *   - wallMillis(): Unix epoch milliseconds, derived from the monotonic
+ *     clock plus a cached offset that is re-synced with the system clock
+ *     at most once per WALL_RESYNC_NANOS. One clock read per call.
+ *
+ * Timestamps are stored as integers and only turned into text by
+ * formatTimestamp() at serialization time. The formatter uses the
+ * reentrant localtime_r/localtime_s, so it is safe to call from any thread.
+ *
+ * Code that must also run on simulated time reads a TimeSource (below)
+ * instead; SystemTime forwards to this class.
+ */
+class Clock {
+public:
+    static const long long NANOS_PER_MICRO = 1000LL;
+    static const long long NANOS_PER_MILLI = 1000000LL;
+    static const long long NANOS_PER_SECOND = 1000000000LL;
+    static const long long WALL_RESYNC_NANOS = NANOS_PER_SECOND;
+    static const size_t TIMESTAMP_BUFFER_SIZE = 20;  // "YYYY-MM-DD HH:MM:SS"
+
+private:
+    static long long systemMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // wall - monotonic offset in ms, and when (monotonic ns) to re-sync it
+    static std::atomic<long long>& wallOffsetMillis() {
+        static std::atomic<long long> offset(systemMillis() - monotonicNanos() / NANOS_PER_MILLI);
+        return offset;
+    }
+
+    static std::atomic<long long>& nextResyncNanos() {
+        static std::atomic<long long> next(0);
+        return next;
+    }
+
+public:
+    // Monotonic time in nanoseconds (arbitrary epoch)
+    static long long monotonicNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Coarse wall-clock time in Unix epoch milliseconds
+    static long long wallMillis() {
+        long long now = monotonicNanos();
+        std::atomic<long long>& offset = wallOffsetMillis();
+        std::atomic<long long>& nextResync = nextResyncNanos();
+
+        long long resyncAt = nextResync.load(std::memory_order_relaxed);
+        if (now >= resyncAt &&
+            nextResync.compare_exchange_strong(resyncAt, now + WALL_RESYNC_NANOS,
+                                               std::memory_order_relaxed)) {
+            offset.store(systemMillis() - now / NANOS_PER_MILLI, std::memory_order_relaxed);
+        }
+        return now / NANOS_PER_MILLI + offset.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Format an epoch-millisecond timestamp as local "YYYY-MM-DD HH:MM:SS"
+     *
+     * Thread-safe. Writes an empty string for a zero timestamp.
+     *
+     * @param epochMillis Timestamp from wallMillis()
+     * @param out Output buffer, at least TIMESTAMP_BUFFER_SIZE bytes
+     * @param size Size of out
+     */
+    static void formatTimestamp(long long epochMillis, char* out, size_t size) {
+        if (size == 0) return;
+        out[0] = '\0';
+        if (epochMillis <= 0) return;
+
+        time_t seconds = static_cast<time_t>(epochMillis / 1000);
+        struct tm local;
+#ifdef _WIN32
+        if (localtime_s(&local, &seconds) != 0) return;
+#else
+        if (!localtime_r(&seconds, &local)) return;
+#endif
+        strftime(out, size, "%Y-%m-%d %H:%M:%S", &local);
+    }
+};
+
+/**
+ * TimeSource - Where matchmaking reads the time
+ *
+ * Shards take queue wait times, acceptance windows, bot fallback and match
+ * eviction from a TimeSource instead of calling Clock directly, so the
+ * simulator can swap in a VirtualClock. Same units as Clock.
+ */
+class TimeSource {
+public:
+    virtual ~TimeSource() {}
+    virtual long long monotonicNanos() const = 0;
+    virtual long long wallMillis() const = 0;
+};
+
+// The real clocks (Clock); the default TimeSource everywhere
+class SystemTime : public TimeSource {
+public:
+    long long monotonicNanos() const { return Clock::monotonicNanos(); }
+    long long wallMillis() const { return Clock::wallMillis(); }
+
+    static const SystemTime& instance() {
+        static SystemTime system;
+        return system;
+    }
+};
+
+#endif // CLOCK_H
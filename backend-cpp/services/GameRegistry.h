@@ -0,0 +1,134 @@
+#ifndef GAME_REGISTRY_H
+#define GAME_REGISTRY_H
+
+#include "../ds/HashTable.h"
+#include <cstring>
+
+/**
+ * GameRegistry - Maps game names to dense game IDs
+ *
+ * Game names are resolved to an ID once, at the API boundary (HTTP handler
+ * or engine command). Everything behind it - queues, ranking trees, bot
+ * pools, player state words - is an array indexed by that ID, so the hot
+ * paths never compare strings.
+ *
+ * The game list is configuration: DEFAULT_GAMES, or a comma-separated list
+ * passed to configure() (the servers read it from the ARENA_GAMES
+ * environment variable at startup). A name may carry a team size,
+ * "name:N", for an NvN team game; plain names are one-on-one.
+ *
+ * Time Complexity:
+ *   - getId(): O(name length) average (HashTable<const char*, int>)
+ *   - getName(): O(1)
+ */
+class GameRegistry {
+public:
+    static const int MAX_GAMES = 16;
+    static const int MAX_NAME_LENGTH = 19;
+    static const int NO_GAME = -1;
+    static const int MAX_TEAM_SIZE = 8;
+
+    static const char* defaultGames() { return "pingpong,snake,tank"; }
+
+private:
+    char names[MAX_GAMES][MAX_NAME_LENGTH + 1];
+    int teamSizes[MAX_GAMES];   // Players per side (1 = one-on-one)
+    int gameCount;
+    HashTable<const char*, int> idByName;
+
+public:
+    GameRegistry() : gameCount(0) {
+        configure(defaultGames());
+    }
+
+    // Names are referenced by pointer from idByName - no copying
+    GameRegistry(const GameRegistry&) = delete;
+    GameRegistry& operator=(const GameRegistry&) = delete;
+
+    /**
+     * Register a game
+     *
+     * @param teamSize Players per side, 1..MAX_TEAM_SIZE
+     * @return ID of the game (existing ID if already registered), or
+     *         NO_GAME if the name is empty/too long, the team size is out
+     *         of range or the registry is full
+     */
+    int registerGame(const char* name, int teamSize = 1) {
+        int existing = getId(name);
+        if (existing != NO_GAME) return existing;
+
+        size_t length = strlen(name);
+        if (length == 0 || length > static_cast<size_t>(MAX_NAME_LENGTH) || gameCount == MAX_GAMES ||
+            teamSize < 1 || teamSize > MAX_TEAM_SIZE) {
+            return NO_GAME;
+        }
+
+        int id = gameCount++;
+        memcpy(names[id], name, length + 1);
+        teamSizes[id] = teamSize;
+        idByName.insert(names[id], id);
+        return id;
+    }
+
+    /**
+     * Replace the game list with a comma-separated list of names, each
+     * optionally suffixed ":N" for an NvN team game
+     *
+     * Must be called before any service uses game IDs.
+     *
+     * @return Number of games registered
+     */
+    int configure(const char* gameList) {
+        idByName.clear();
+        gameCount = 0;
+
+        char name[MAX_NAME_LENGTH + 2];
+        size_t length = 0;
+        int teamSize = 0;   // 0 until a ':' is seen
+        for (const char* c = gameList; ; c++) {
+            if (*c == ',' || *c == '\0') {
+                name[length] = '\0';
+                if (length > 0) registerGame(name, teamSize > 0 ? teamSize : 1);
+                length = 0;
+                teamSize = 0;
+                if (*c == '\0') break;
+            } else if (*c == ':') {
+                teamSize = -1;
+            } else if (teamSize != 0) {
+                if (*c < '0' || *c > '9') continue;
+                teamSize = (teamSize < 0 ? 0 : teamSize * 10) + (*c - '0');
+                if (teamSize > MAX_TEAM_SIZE) teamSize = MAX_TEAM_SIZE + 1;  // Rejected by registerGame
+            } else if (*c != ' ' && length <= static_cast<size_t>(MAX_NAME_LENGTH)) {
+                name[length++] = *c;
+            }
+        }
+        return gameCount;
+    }
+
+    // Look up a game ID by name, or NO_GAME
+    int getId(const char* name) const {
+        const int* id = idByName.get(name);
+        return id ? *id : NO_GAME;
+    }
+
+    // Name of a game ID, or nullptr if out of range
+    const char* getName(int id) const {
+        return isValid(id) ? names[id] : nullptr;
+    }
+
+    // Players per side for a game ID (1 = one-on-one), or 0 if out of range
+    int getTeamSize(int id) const {
+        return isValid(id) ? teamSizes[id] : 0;
+    }
+
+    bool isValid(int id) const {
+        return id >= 0 && id < gameCount;
+    }
+
+    // Number of games (valid IDs are 0 .. size()-1)
+    int size() const {
+        return gameCount;
+    }
+};
+
+#endif // GAME_REGISTRY_H
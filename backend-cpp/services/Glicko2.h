@@ -0,0 +1,314 @@
+#ifndef GLICKO2_H
+#define GLICKO2_H
+
+#include "../models/GlickoRating.h"
+#include "PlayerStore.h"
+#include <cmath>
+
+/**
+ * Glicko2 - One game's rating period: buffered results, batch update
+ *
+ * Results are not applied when a match ends. They are appended to this
+ * buffer (player indexes and a weight), and when the rating period closes
+ * every player with results is re-rated at once with Glicko-2
+ * (Glickman, "Example of the Glicko-2 system"):
+ *
+ *   1. Gather: give each affected player a dense slot and load mu, phi
+ *      (grown for periods sat out) and sigma into flat arrays.
+ *   2. Per result: g(phi) and expected score for both sides. A straight
+ *      loop over flat double arrays with no branches, so the compiler can
+ *      vectorize it; no pow() per result.
+ *   3. Scatter: sum each player's variance and improvement terms.
+ *   4. Per player: new volatility (Illinois iteration), deviation and
+ *      rating; write back to the game's PlayerStore columns and report
+ *      the ELO change.
+ *
+ * Opponents are always taken at their pre-period values, as the system
+ * requires, so the order results arrived in does not matter.
+ *
+ * Team results are recorded as every winner against every loser with
+ * weight 1 / team size, so one team match counts as one game per player.
+ *
+ * Players with no results in a period are not touched: their deviation
+ * grows lazily, for all periods missed, the next time they are rated.
+ *
+ * Time Complexity:
+ *   - record(): O(1) amortized
+ *   - close(): O(r + p) for r results and p affected players
+ */
+class Glicko2 {
+public:
+    static constexpr double SCALE = 173.7178;            // Glicko-1 points per Glicko-2 unit
+    static constexpr double TAU = 0.5;                   // Volatility change constraint
+    static constexpr double MAX_DEVIATION = 350.0;
+    static constexpr double CONVERGENCE = 0.000001;
+    static constexpr double PI = 3.14159265358979323846;
+
+private:
+    static const int NO_SLOT = -1;
+
+    // Buffered results (player indexes; winner scored 1)
+    int* winners;
+    int* losers;
+    double* weights;
+    int resultCount;
+    int resultCapacity;
+
+    // Per-result scratch (step 2)
+    double* winnerG;      // g(phi) of the winner, as seen by the loser
+    double* loserG;
+    double* winnerExpected;
+    double* loserExpected;
+
+    // Player index -> slot, NO_SLOT outside close()
+    int* slotOf;
+    int slotOfCapacity;
+
+    // Per-slot scratch (steps 1, 3, 4)
+    int* slotPlayer;
+    double* mu;
+    double* phi;
+    double* sigma;
+    double* varianceInverse;
+    double* improvement;
+    int slotCapacity;
+
+    template <typename T>
+    static void growArray(T*& array, int used, int capacity) {
+        T* grown = new T[capacity];
+        for (int i = 0; i < used; i++) grown[i] = array[i];
+        delete[] array;
+        array = grown;
+    }
+
+    void reserveResults(int count) {
+        if (count <= resultCapacity) return;
+        int capacity = resultCapacity == 0 ? 256 : resultCapacity * 2;
+        while (capacity < count) capacity *= 2;
+        growArray(winners, resultCount, capacity);
+        growArray(losers, resultCount, capacity);
+        growArray(weights, resultCount, capacity);
+        growArray(winnerG, 0, capacity);
+        growArray(loserG, 0, capacity);
+        growArray(winnerExpected, 0, capacity);
+        growArray(loserExpected, 0, capacity);
+        resultCapacity = capacity;
+    }
+
+    void reserveSlots(int count) {
+        if (count <= slotCapacity) return;
+        int capacity = slotCapacity == 0 ? 256 : slotCapacity * 2;
+        while (capacity < count) capacity *= 2;
+        growArray(slotPlayer, 0, capacity);
+        growArray(mu, 0, capacity);
+        growArray(phi, 0, capacity);
+        growArray(sigma, 0, capacity);
+        growArray(varianceInverse, 0, capacity);
+        growArray(improvement, 0, capacity);
+        slotCapacity = capacity;
+    }
+
+    void reserveSlotOf(int playerCount) {
+        if (playerCount <= slotOfCapacity) return;
+        int capacity = slotOfCapacity == 0 ? 1024 : slotOfCapacity * 2;
+        while (capacity < playerCount) capacity *= 2;
+        growArray(slotOf, slotOfCapacity, capacity);
+        for (int i = slotOfCapacity; i < capacity; i++) slotOf[i] = NO_SLOT;
+        slotOfCapacity = capacity;
+    }
+
+    // Slot for a player, loading their pre-period state on first use
+    int slotFor(const PlayerStore* players, int gameId, int index, int period, int& slots) {
+        if (slotOf[index] != NO_SLOT) return slotOf[index];
+        int slot = slots++;
+        slotOf[index] = slot;
+        slotPlayer[slot] = index;
+
+        const GlickoRating& state = players->getGlicko(index, gameId);
+        double rating = state.rating;
+        int elo = players->getElo(index, gameId);
+        if (std::lround(rating) != elo) rating = elo;  // ELO set outside rating periods
+
+        double deviation = state.deviation / SCALE;
+        double volatility = state.volatility;
+        if (state.ratedPeriod != GlickoRating::NEVER_RATED) {
+            int missed = period - state.ratedPeriod - 1;
+            if (missed > 0) deviation = std::sqrt(deviation * deviation + missed * volatility * volatility);
+        }
+        if (deviation > MAX_DEVIATION / SCALE) deviation = MAX_DEVIATION / SCALE;
+
+        mu[slot] = (rating - 1000.0) / SCALE;
+        phi[slot] = deviation;
+        sigma[slot] = volatility;
+        varianceInverse[slot] = 0.0;
+        improvement[slot] = 0.0;
+        return slot;
+    }
+
+    // New volatility (step 5 of the paper, Illinois variant of regula falsi)
+    static double newVolatility(double phiValue, double variance, double delta, double volatility) {
+        double a = std::log(volatility * volatility);
+        double phi2 = phiValue * phiValue;
+        double delta2 = delta * delta;
+        auto f = [&](double x) {
+            double ex = std::exp(x);
+            double denominator = phi2 + variance + ex;
+            return ex * (delta2 - phi2 - variance - ex) / (2.0 * denominator * denominator) - (x - a) / (TAU * TAU);
+        };
+
+        double A = a;
+        double B;
+        if (delta2 > phi2 + variance) {
+            B = std::log(delta2 - phi2 - variance);
+        } else {
+            int k = 1;
+            while (f(a - k * TAU) < 0 && k < 64) k++;
+            B = a - k * TAU;
+        }
+
+        double fA = f(A);
+        double fB = f(B);
+        for (int iteration = 0; iteration < 100 && std::fabs(B - A) > CONVERGENCE; iteration++) {
+            double C = A + (A - B) * fA / (fB - fA);
+            double fC = f(C);
+            if (fC * fB <= 0) {
+                A = B;
+                fA = fB;
+            } else {
+                fA /= 2.0;
+            }
+            B = C;
+            fB = fC;
+        }
+        return std::exp(A / 2.0);
+    }
+
+public:
+    Glicko2()
+        : winners(nullptr), losers(nullptr), weights(nullptr), resultCount(0), resultCapacity(0),
+          winnerG(nullptr), loserG(nullptr), winnerExpected(nullptr), loserExpected(nullptr),
+          slotOf(nullptr), slotOfCapacity(0),
+          slotPlayer(nullptr), mu(nullptr), phi(nullptr), sigma(nullptr),
+          varianceInverse(nullptr), improvement(nullptr), slotCapacity(0) {}
+
+    ~Glicko2() {
+        delete[] winners;
+        delete[] losers;
+        delete[] weights;
+        delete[] winnerG;
+        delete[] loserG;
+        delete[] winnerExpected;
+        delete[] loserExpected;
+        delete[] slotOf;
+        delete[] slotPlayer;
+        delete[] mu;
+        delete[] phi;
+        delete[] sigma;
+        delete[] varianceInverse;
+        delete[] improvement;
+    }
+
+    Glicko2(const Glicko2&) = delete;
+    Glicko2& operator=(const Glicko2&) = delete;
+
+    // Buffer one result for the current period - O(1) amortized
+    void record(int winnerIndex, int loserIndex, double weight = 1.0) {
+        reserveResults(resultCount + 1);
+        winners[resultCount] = winnerIndex;
+        losers[resultCount] = loserIndex;
+        weights[resultCount] = weight;
+        resultCount++;
+    }
+
+    // Results waiting for the period to close
+    int pending() const {
+        return resultCount;
+    }
+
+    // One buffered result, 0 <= i < pending() (snapshots)
+    void getResult(int i, int& winnerIndex, int& loserIndex, double& weight) const {
+        winnerIndex = winners[i];
+        loserIndex = losers[i];
+        weight = weights[i];
+    }
+
+    /**
+     * Close the period: re-rate every player with buffered results
+     *
+     * Writes each player's GlickoRating and ELO in the game's columns,
+     * then calls changed(playerIndex, oldElo) for every player whose ELO
+     * moved.
+     *
+     * @param gameId Game whose results these are
+     * @param period Number of the period being closed
+     * @return Number of players re-rated
+     */
+    template <typename Changed>
+    int close(PlayerStore* players, int gameId, int period, Changed changed) {
+        if (resultCount == 0) return 0;
+        reserveSlotOf(players->size());
+        reserveSlots(2 * resultCount);
+
+        // 1. Gather
+        int slots = 0;
+        for (int r = 0; r < resultCount; r++) {
+            winners[r] = slotFor(players, gameId, winners[r], period, slots);
+            losers[r] = slotFor(players, gameId, losers[r], period, slots);
+        }
+
+        // 2. g(phi) and expected scores - flat, branch-free
+        for (int r = 0; r < resultCount; r++) {
+            double pw = phi[winners[r]];
+            double pl = phi[losers[r]];
+            double gap = mu[winners[r]] - mu[losers[r]];
+            winnerG[r] = 1.0 / std::sqrt(1.0 + 3.0 * pw * pw / (PI * PI));
+            loserG[r] = 1.0 / std::sqrt(1.0 + 3.0 * pl * pl / (PI * PI));
+            winnerExpected[r] = 1.0 / (1.0 + std::exp(-loserG[r] * gap));
+            loserExpected[r] = 1.0 / (1.0 + std::exp(winnerG[r] * gap));
+        }
+
+        // 3. Scatter variance and improvement terms (winner scored 1, loser 0)
+        for (int r = 0; r < resultCount; r++) {
+            int win = winners[r];
+            int lose = losers[r];
+            double w = weights[r];
+            double ew = winnerExpected[r];
+            double el = loserExpected[r];
+            varianceInverse[win] += w * loserG[r] * loserG[r] * ew * (1.0 - ew);
+            improvement[win] += w * loserG[r] * (1.0 - ew);
+            varianceInverse[lose] += w * winnerG[r] * winnerG[r] * el * (1.0 - el);
+            improvement[lose] -= w * winnerG[r] * el;
+        }
+
+        // 4. Per player: volatility, deviation, rating
+        for (int slot = 0; slot < slots; slot++) {
+            int index = slotPlayer[slot];
+            double variance = 1.0 / varianceInverse[slot];
+            double delta = variance * improvement[slot];
+            double volatility = newVolatility(phi[slot], variance, delta, sigma[slot]);
+            double preRating = std::sqrt(phi[slot] * phi[slot] + volatility * volatility);
+            double newPhi = 1.0 / std::sqrt(1.0 / (preRating * preRating) + 1.0 / variance);
+            double newMu = mu[slot] + newPhi * newPhi * improvement[slot];
+            if (newPhi > MAX_DEVIATION / SCALE) newPhi = MAX_DEVIATION / SCALE;
+
+            GlickoRating& state = players->getGlicko(index, gameId);
+            state.rating = 1000.0 + SCALE * newMu;
+            state.deviation = static_cast<float>(SCALE * newPhi);
+            state.volatility = static_cast<float>(volatility);
+            state.ratedPeriod = period;
+
+            int oldElo = players->getElo(index, gameId);
+            int newElo = static_cast<int>(std::lround(state.rating));
+            slotOf[index] = NO_SLOT;
+            if (newElo != oldElo) {
+                players->setElo(index, gameId, newElo);
+                changed(index, oldElo);
+            }
+        }
+
+        resultCount = 0;
+        return slots;
+    }
+};
+
+#endif // GLICKO2_H
@@ -5,6 +5,7 @@
 #include "../ds/LinkedList.h"
 #include "../models/Match.h"
 #include "../models/Player.h"
+#include <mutex>
 
 /**
  * HistoryService - Manages match history for all players
@@ -15,39 +16,60 @@
  * Operations:
  *   - Add match to history: O(1)
  *   - Get last N matches: O(n)
+ *
+ * One instance serves every game: each matchmaking shard records its
+ * results under its own lock only, and request handlers read without any
+ * shard lock, so every method takes this service's own mutex.
  */
 class HistoryService {
 private:
     // Maps playerID -> LinkedList of their matches
     HashTable<int, LinkedList<Match>> playerHistories;
     
+    std::mutex lock;
+    
+    // Append a match to one player's history, creating the list if needed
+    void appendTo(int playerId, const Match& match) {
+        LinkedList<Match>* history = playerHistories.get(playerId);
+        if (!history) {
+            playerHistories.insert(playerId, LinkedList<Match>());
+            history = playerHistories.get(playerId);
+        }
+        history->append(match);
+    }
+    
 public:
     HistoryService() {}
     
+    HistoryService(const HistoryService&) = delete;
+    HistoryService& operator=(const HistoryService&) = delete;
+    
     /**
-     * Record a match for both players
+     * Record a match for every player in it (both players, or both teams)
      */
     void recordMatch(const Match& match) {
-        // Add to player 1's history
-        LinkedList<Match>* p1History = playerHistories.get(match.player1Id);
-        if (!p1History) {
-            playerHistories.insert(match.player1Id, LinkedList<Match>());
-            p1History = playerHistories.get(match.player1Id);
+        std::lock_guard<std::mutex> guard(lock);
+        for (int i = 0; i < match.teamSize; i++) {
+            appendTo(match.team1[i], match);
+            appendTo(match.team2[i], match);
         }
-        p1History->append(match);
-        
-        // Add to player 2's history
-        LinkedList<Match>* p2History = playerHistories.get(match.player2Id);
-        if (!p2History) {
-            playerHistories.insert(match.player2Id, LinkedList<Match>());
-            p2History = playerHistories.get(match.player2Id);
-        }
-        p2History->append(match);
+    }
+    
+    /**
+     * Append one match to one player's history (restoring a snapshot,
+     * where each player's list is stored in order)
+     */
+    void restoreMatch(int playerId, const Match& match) {
+        std::lock_guard<std::mutex> guard(lock);
+        appendTo(playerId, match);
     }
     
     /**
      * Get a player's match history
      * 
+     * Unlocked: the caller must keep writers out, i.e. hold every shard
+     * lock (Matchmaker::ExclusiveLock), as snapshots do.
+     * 
      * @param playerId Player to get history for
      * @return Pointer to their match list, or nullptr if none
      */
@@ -64,6 +86,7 @@ public:
      * @param outCount Number of matches retrieved
      */
     void getLastNMatches(int playerId, int n, Match* outMatches, int& outCount) {
+        std::lock_guard<std::mutex> guard(lock);
         outCount = 0;
         LinkedList<Match>* history = playerHistories.get(playerId);
         if (!history) return;
@@ -78,6 +101,7 @@ public:
      * Get match count for a player
      */
     int getMatchCount(int playerId) {
+        std::lock_guard<std::mutex> guard(lock);
         LinkedList<Match>* history = playerHistories.get(playerId);
         return history ? static_cast<int>(history->size()) : 0;
     }
@@ -86,6 +110,7 @@ public:
      * Clear a player's history
      */
     void clearPlayerHistory(int playerId) {
+        std::lock_guard<std::mutex> guard(lock);
         LinkedList<Match>* history = playerHistories.get(playerId);
         if (history) {
             history->clear();
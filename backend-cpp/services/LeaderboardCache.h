@@ -0,0 +1,123 @@
+#ifndef LEADERBOARD_CACHE_H
+#define LEADERBOARD_CACHE_H
+
+#include "GameRegistry.h"
+#include "Clock.h"
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+/**
+ * LeaderboardCache - Rendered leaderboard per game, keyed by version
+ *
+ * A leaderboard only changes when its game's ranking tree does, and
+ * RankingService counts those changes (getLeaderboardVersion). The cache
+ * keeps each game's last rendered body with the version it was rendered
+ * at:
+ *   - same version: the stored bytes are served, no tree walk or lookups
+ *   - newer version: the caller renders once (under the shard lock) and
+ *     stores the result; nothing is rebuilt until a request needs it
+ *
+ * ETags name the version ("<start>-<game>-<version>", start being the
+ * process start time so tags from an earlier run never match), so a
+ * conditional request (If-None-Match) is answered from the atomic
+ * version alone, without the lock or the cache.
+ *
+ * Hits, rebuilds and not-modified answers are counted for the admin
+ * endpoint.
+ *
+ * Time Complexity:
+ *   - etagFor(), isCurrent(): O(1)
+ *   - lookup(), store(): O(body length) to copy the bytes
+ */
+class LeaderboardCache {
+private:
+    static const long long EMPTY = -1;
+
+    struct Entry {
+        long long version;
+        std::string body;
+
+        Entry() : version(EMPTY) {}
+    };
+
+    Entry entries[GameRegistry::MAX_GAMES];
+    std::mutex lock;
+
+    long long startTag;
+
+    std::atomic<long long> hits;
+    std::atomic<long long> rebuilds;
+    std::atomic<long long> notModified;
+
+public:
+    LeaderboardCache() : startTag(Clock::wallMillis()), hits(0), rebuilds(0), notModified(0) {}
+
+    LeaderboardCache(const LeaderboardCache&) = delete;
+    LeaderboardCache& operator=(const LeaderboardCache&) = delete;
+
+    // Strong ETag for a game's leaderboard at a version (quoted)
+    std::string etagFor(int gameId, long long version) const {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "\"%llx-%d-%lld\"", static_cast<unsigned long long>(startTag), gameId, version);
+        return buf;
+    }
+
+    /**
+     * Conditional request check: true (and counted) if the client's
+     * If-None-Match names the current version
+     */
+    bool isCurrent(const std::string& ifNoneMatch, int gameId, long long version) {
+        if (ifNoneMatch.empty() || ifNoneMatch != etagFor(gameId, version)) return false;
+        notModified++;
+        return true;
+    }
+
+    /**
+     * Copy the stored body if it was rendered at this version
+     *
+     * @return false (a miss) if the game has nothing stored or an older version
+     */
+    bool lookup(int gameId, long long version, std::string& outBody) {
+        if (gameId < 0 || gameId >= GameRegistry::MAX_GAMES) return false;
+        std::lock_guard<std::mutex> guard(lock);
+        const Entry& entry = entries[gameId];
+        if (entry.version != version) return false;
+        outBody = entry.body;
+        hits++;
+        return true;
+    }
+
+    // Store a body rendered at a version (kept unless an older version)
+    void store(int gameId, long long version, const std::string& body) {
+        if (gameId < 0 || gameId >= GameRegistry::MAX_GAMES) return;
+        rebuilds++;
+        std::lock_guard<std::mutex> guard(lock);
+        Entry& entry = entries[gameId];
+        if (version < entry.version) return;
+        entry.version = version;
+        entry.body = body;
+    }
+
+    long long getHits() const { return hits.load(); }
+    long long getRebuilds() const { return rebuilds.load(); }
+    long long getNotModified() const { return notModified.load(); }
+
+    // Requests answered without rendering, over all requests
+    double hitRate() const {
+        long long served = hits.load() + notModified.load();
+        long long total = served + rebuilds.load();
+        return total > 0 ? static_cast<double>(served) / total : 0.0;
+    }
+
+    // {"hits":..,"rebuilds":..,"notModified":..,"hitRate":..}
+    std::string toJson() const {
+        char buf[160];
+        snprintf(buf, sizeof(buf), "{\"hits\":%lld,\"rebuilds\":%lld,\"notModified\":%lld,\"hitRate\":%.4f}",
+                 getHits(), getRebuilds(), getNotModified(), hitRate());
+        return buf;
+    }
+};
+
+#endif // LEADERBOARD_CACHE_H
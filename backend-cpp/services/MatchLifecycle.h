@@ -0,0 +1,125 @@
+#ifndef MATCH_LIFECYCLE_H
+#define MATCH_LIFECYCLE_H
+
+#include "../ds/HashTable.h"
+#include "../ds/Queue.h"
+#include "../models/Match.h"
+#include "Clock.h"
+
+/**
+ * MatchLifecycle - Active match set with eviction of completed matches
+ *
+ * A match lives here from creation until shortly after it completes:
+ *
+ *   created -> active -> completed (recorded in HistoryService by the
+ *              caller) -> kept for the grace window -> evicted
+ *
+ * The grace window lets clients that poll a match by ID still see the
+ * final result for a few seconds; a grace of 0 evicts on the next sweep.
+ * Completed matches wait in a FIFO in completion order, and all of them
+ * share the same grace window, so the ones due for eviction are always at
+ * the front - a sweep costs O(evicted), never a scan of the table.
+ *
+ * The table therefore holds concurrent matches plus those completed in
+ * the last grace window, not every match ever played.
+ *
+ * Time Complexity:
+ *   - add(), get(), complete(): O(1) average
+ *   - evictExpired(): O(matches evicted)
+ *   - forEach(): O(matches held)
+ */
+class MatchLifecycle {
+public:
+    static const long long DEFAULT_GRACE_NANOS = 30 * Clock::NANOS_PER_SECOND;
+
+private:
+    struct Retiring {
+        int matchId;
+        long long evictAt;  // Monotonic ns
+
+        Retiring() : matchId(0), evictAt(0) {}
+        Retiring(int id, long long at) : matchId(id), evictAt(at) {}
+    };
+
+    HashTable<int, Match> matches;
+    Queue<Retiring> retiring;
+    long long graceNanos;
+
+public:
+    MatchLifecycle() : graceNanos(DEFAULT_GRACE_NANOS) {}
+
+    /**
+     * How long completed matches stay readable (0 = evict on next sweep)
+     *
+     * Set at startup; the eviction FIFO assumes one window for all matches.
+     */
+    void setGraceNanos(long long nanos) {
+        graceNanos = nanos < 0 ? 0 : nanos;
+    }
+
+    // Start tracking a new match
+    void add(const Match& match) {
+        matches.insert(match.matchId, match);
+    }
+
+    // Match by ID, or nullptr if unknown or already evicted
+    Match* get(int matchId) {
+        return matches.get(matchId);
+    }
+
+    /**
+     * Schedule a completed match for eviction after the grace window
+     *
+     * The caller marks the match completed and records it in history first.
+     *
+     * @param now Monotonic ns (the shard's TimeSource)
+     */
+    void complete(int matchId, long long now) {
+        retiring.enqueue(Retiring(matchId, now + graceNanos));
+    }
+
+    /**
+     * Drop completed matches whose grace window has passed
+     *
+     * @param now Monotonic ns (the shard's TimeSource)
+     * @return Number of matches evicted
+     */
+    int evictExpired(long long now) {
+        int evicted = 0;
+        Retiring* front = retiring.front();
+        while (front && front->evictAt <= now) {
+            matches.remove(front->matchId);
+            evicted++;
+            Retiring done;
+            retiring.dequeue(done);
+            front = retiring.front();
+        }
+        return evicted;
+    }
+
+    // Call visit(match) for every match held, in no particular order - O(n)
+    template <typename Visit>
+    void forEach(Visit visit) {
+        size_t count = matches.size();
+        int* ids = new int[count > 0 ? count : 1];
+        size_t found = 0;
+        matches.getAllKeys(ids, count, found);
+        for (size_t i = 0; i < found; i++) {
+            const Match* match = matches.get(ids[i]);
+            if (match) visit(*match);
+        }
+        delete[] ids;
+    }
+
+    // Gauge: matches currently held (in progress + completed within grace)
+    size_t size() const {
+        return matches.size();
+    }
+
+    // Gauge: completed matches waiting out their grace window
+    size_t retiringCount() const {
+        return retiring.size();
+    }
+};
+
+#endif // MATCH_LIFECYCLE_H
@@ -0,0 +1,108 @@
+#ifndef MATCH_TELEMETRY_H
+#define MATCH_TELEMETRY_H
+
+#include "../ds/Histogram.h"
+#include "Clock.h"
+#include <cstdio>
+#include <string>
+
+/**
+ * MatchTelemetry - Match-quality distributions for one game
+ *
+ * Recorded by the game's shard at match creation, split by pairing:
+ *   - queue wait of every queued human entering a match (microseconds)
+ *   - ELO gap of the match (team averages for team matches)
+ * for human-vs-human and human-vs-bot matches. The bot-fallback rate is
+ * the human-vs-bot share of matches.
+ *
+ * Every histogram records lock-free, so the admin endpoint and the
+ * engine's METRICS command read it without taking the shard lock.
+ *
+ * Time Complexity:
+ *   - recordWait(), recordMatch(): O(1)
+ *   - toJson(): O(Histogram::BUCKET_COUNT) per histogram
+ */
+class MatchTelemetry {
+public:
+    enum Pairing {
+        HUMAN_VS_HUMAN = 0,
+        HUMAN_VS_BOT = 1,
+        PAIRING_COUNT = 2
+    };
+
+private:
+    Histogram waitMicros[PAIRING_COUNT];
+    Histogram eloGap[PAIRING_COUNT];
+
+    static const char* pairingName(int pairing) {
+        return pairing == HUMAN_VS_BOT ? "humanVsBot" : "humanVsHuman";
+    }
+
+    // {"count":..,"mean":..,"p50":..,"p90":..,"p99":..,"max":..} with values scaled by 1/divisor
+    static void appendSummary(std::string& out, const Histogram& histogram, double divisor) {
+        char buf[192];
+        snprintf(buf, sizeof(buf),
+                 "{\"count\":%lld,\"mean\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f}",
+                 histogram.count(), histogram.mean() / divisor,
+                 histogram.percentile(50) / divisor, histogram.percentile(90) / divisor,
+                 histogram.percentile(99) / divisor, histogram.max() / divisor);
+        out += buf;
+    }
+
+public:
+    MatchTelemetry() {}
+
+    MatchTelemetry(const MatchTelemetry&) = delete;
+    MatchTelemetry& operator=(const MatchTelemetry&) = delete;
+
+    // Queue wait of one human entering a match
+    void recordWait(Pairing pairing, long long waitNanos) {
+        waitMicros[pairing].record(waitNanos / Clock::NANOS_PER_MICRO);
+    }
+
+    // One match created, with its ELO gap
+    void recordMatch(Pairing pairing, int gap) {
+        eloGap[pairing].record(gap < 0 ? -gap : gap);
+    }
+
+    long long getMatchCount(Pairing pairing) const {
+        return eloGap[pairing].count();
+    }
+
+    const Histogram& getWaitMicros(Pairing pairing) const {
+        return waitMicros[pairing];
+    }
+
+    const Histogram& getEloGap(Pairing pairing) const {
+        return eloGap[pairing];
+    }
+
+    /**
+     * Summary object:
+     * {"game":..,"matches":..,"botFallbackRate":..,
+     *  "humanVsHuman":{"waitMs":{..},"eloGap":{..}},"humanVsBot":{..}}
+     */
+    std::string toJson(const char* gameName) const {
+        long long humans = getMatchCount(HUMAN_VS_HUMAN);
+        long long bots = getMatchCount(HUMAN_VS_BOT);
+        long long matches = humans + bots;
+
+        char buf[160];
+        snprintf(buf, sizeof(buf), "{\"game\":\"%s\",\"matches\":%lld,\"botFallbackRate\":%.4f",
+                 gameName, matches, matches > 0 ? static_cast<double>(bots) / matches : 0.0);
+        std::string out(buf);
+        for (int pairing = 0; pairing < PAIRING_COUNT; pairing++) {
+            out += ",\"";
+            out += pairingName(pairing);
+            out += "\":{\"waitMs\":";
+            appendSummary(out, waitMicros[pairing], 1000.0);
+            out += ",\"eloGap\":";
+            appendSummary(out, eloGap[pairing], 1.0);
+            out += "}";
+        }
+        out += "}";
+        return out;
+    }
+};
+
+#endif // MATCH_TELEMETRY_H
@@ -1,531 +1,701 @@
 #ifndef MATCHMAKER_H
 #define MATCHMAKER_H
 
-#include "../ds/Queue.h"
-#include "../ds/HashTable.h"
-#include "../ds/AVLTree.h"
 #include "../models/Player.h"
 #include "../models/Match.h"
+#include "../models/PlayerState.h"
+#include "PlayerStore.h"
 #include "RankingService.h"
 #include "HistoryService.h"
-#include <ctime>
+#include "GameRegistry.h"
+#include "MatchmakingShard.h"
+#include "StateLog.h"
+#include "Clock.h"
+#include <atomic>
+#include <mutex>
 
 /**
  * Matchmaker - Core matchmaking service using DSA
- * 
- * MATCHMAKING ALGORITHM (Closest-Rank based):
- * 1. Player selects a game and enters matchmaking queue
- * 2. Player ID enqueued in that game's queue
- * 3. Backend dequeues player
- * 4. Player profile fetched from HashTable
- * 5. AVL tree searched for closest ELO opponent
- * 6. Match is created between the two players
- * 7. Both players removed from queue
- * 8. Match ID returned to UI
- * 
+ *
+ * MATCHMAKING FLOW:
+ * 1. joinQueue() claims the player for a game (state word IDLE -> QUEUED)
+ *    and appends an entry to that game's shard queue
+ * 2. Every tick, the game's MatchmakingTicker thread runs
+ *    processMatchmaking(): the shard snapshots its live queue and pairs it
+ *    in one batch (BATCH MATCHING below; team games form NvN teams)
+ * 3. Each pair becomes a match in one pass: players move to IN_MATCH and
+ *    leave the ranking tree, and the match ID names the shard
+ * 4. Solo players still unpaired after BOT_FALLBACK_WAIT_NANOS get a bot;
+ *    everyone else goes back to the queue in order for the next tick
+ * 5. Clients poll getPlayerMatch() / getMatch() for the match
+ * 6. submitMatchResult() applies ratings, records history and hands the
+ *    players back (IN_MATCH -> IDLE, back in the ranking tree)
+ *
+ * SHARDS:
+ * Each game is a MatchmakingShard owning its queue, bot pool, active
+ * matches and ranking tree, behind its own mutex. This class routes every
+ * call to the right shard (by game ID, or by the game bits of a match ID)
+ * and holds that shard's lock for the call, so ticks for different games
+ * run in parallel (one MatchmakingTicker thread per shard) and a request
+ * for one game never waits on another game's tick. Shards only share
+ * PlayerStore and HistoryService (which has its own lock); who may touch
+ * a player is settled by the state word (see MatchmakingShard). Creating
+ * players changes PlayerStore's indexes, so callers do it under an
+ * ExclusiveLock.
+ *
+ * PLAYER STATE:
+ * Each player's status (idle / queued for game G / in match M) is one packed
+ * word in PlayerStore, changed by compare-and-swap at every transition.
+ * Leaving a queue or being matched only flips that word; the player's queue
+ * entry goes stale (its handle no longer matches) and is skipped when it
+ * reaches the front. Status, stale-state and disconnect checks are O(1).
+ *
+ * ACCEPTANCE WINDOWS:
+ * Each queued player accepts opponents within an ELO window that starts at
+ * INITIAL_WINDOW_ELO and widens by WINDOW_GROWTH_ELO_PER_SECOND of waiting,
+ * up to MAX_WINDOW_ELO. Two players can be paired once their windows
+ * overlap: |elo(a) - elo(b)| < window(a) + window(b).
+ *
+ * BATCH MATCHING (processMatchmaking, run once per tick):
+ * The live queue is snapshotted and paired all at once by BatchMatcher:
+ * sorted by ELO, minimum total ELO gap, with each player's window as the
+ * cost of leaving them unmatched. Under that cost an optimal pairing never
+ * contains a pair whose windows do not overlap (skipping both would be
+ * cheaper), so one sweep matches the overlapping players without a tree
+ * search per player. Solo players are paired inside their latency bucket
+ * and input device cell first, then across compatible cells with the
+ * latency and cross-play penalties added to the gap (see CandidateIndex);
+ * incompatible players are never paired. All matches are committed in one
+ * pass; unmatched players go back to the queue in their original order.
+ * tryCreateMatch() is the older greedy path (front of queue takes the
+ * closest opponent inside its window, via CandidateIndex) and is kept for
+ * comparison.
+ *
  * DEMO MODE:
- * When queue size is 1 (only human), match Human vs Bot using AVL.findClosest()
- * 
+ * A human left unmatched for BOT_FALLBACK_WAIT_NANOS is paired with the
+ * closest-ELO free bot. Each game's bots live in a BotPool (sorted by ELO,
+ * availability bitset), so bot selection is a binary search plus a short
+ * bitset scan however many bots are registered.
+ *
+ * RATING PERIODS:
+ * With RankingService in GLICKO2 mode, results are buffered and applied
+ * once per rating period. closeRatingPeriod() takes every shard lock,
+ * re-rates each game's buffered results in one batch, and re-keys the
+ * players whose ELO moved in that game's shard. The tick
+ * threads call closeRatingPeriodIfDue() after every tick; exactly one of
+ * them closes each period.
+ *
+ * SEASONS:
+ * startSeason() archives a game's standings and soft-resets its ratings
+ * (pulled toward a target) with every shard locked; RankingService
+ * rebuilds the tree in place and the shard re-keys its indexes, so a
+ * rollover costs linear passes rather than per-player tree operations.
+ *
+ * PERSISTENCE:
+ * With a StateLog attached (setStateLog), every queue join/leave, match,
+ * result, rating period and season is appended to the write-ahead log by
+ * the shard (or under the ExclusiveLock) that made the change, so the log
+ * holds them in an order they really happened in. Persistence replays it
+ * through the same calls, plus restoreMatch() for the pairings ticks made.
+ *
+ * GAMES:
+ * Games are addressed by their GameRegistry ID; names are resolved by the
+ * caller. A game registered with a team size N > 1 is played NvN: its
+ * tick forms balanced teams from the queue (see MatchmakingShard).
+ *
  * Data Structures Used:
- *   - Queue<int>: FIFO matchmaking lobby per game
- *   - AVLTree<PlayerELO>: Rankings for O(log n) closest-match search
- *   - HashTable<int, Player>: Player profile storage
+ *   - Queue<QueueEntry>: FIFO matchmaking lobby per game
+ *   - AVLTree<PlayerELO>: Per-game rankings (leaderboards, percentiles)
+ *   - BatchMatcher: Minimum-cost pairing of each tick's queue snapshot
+ *   - PlayerStore: Hot/cold split player storage (SoA columns + profiles)
  *   - LinkedList<Match>: Match history storage
+ *   - MatchLifecycle: active matches; completed ones are evicted after a
+ *     grace window (their record lives on in HistoryService)
  */
 class Matchmaker {
+public:
+    typedef MatchmakingShard::MatchListener MatchListener;
+
+    static const long long DEFAULT_RATING_PERIOD_NANOS = 60 * Clock::NANOS_PER_SECOND;
+
+    /**
+     * Holds one game's shard lock - for reading that game's services
+     * (e.g. its ranking tree) directly
+     */
+    class ShardLock {
+    private:
+        std::unique_lock<std::mutex> guard;  // Empty for an invalid game ID
+    public:
+        ShardLock(Matchmaker& matchmaker, int gameId) {
+            MatchmakingShard* shard = matchmaker.getShard(gameId);
+            if (shard) guard = std::unique_lock<std::mutex>(shard->mutex());
+        }
+    };
+
+    /**
+     * Holds every shard lock (in game ID order) - for changes to shared
+     * player storage, such as creating players, while ticks are running
+     */
+    class ExclusiveLock {
+    private:
+        Matchmaker& matchmaker;
+    public:
+        explicit ExclusiveLock(Matchmaker& mm) : matchmaker(mm) {
+            for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+                matchmaker.shards[g].mutex().lock();
+            }
+        }
+        ~ExclusiveLock() {
+            for (int g = GameRegistry::MAX_GAMES - 1; g >= 0; g--) {
+                matchmaker.shards[g].mutex().unlock();
+            }
+        }
+
+        // A shard, read or changed directly while every lock is held (snapshots)
+        MatchmakingShard& shard(int gameId) {
+            return matchmaker.shards[gameId];
+        }
+        ExclusiveLock(const ExclusiveLock&) = delete;
+        ExclusiveLock& operator=(const ExclusiveLock&) = delete;
+    };
+
 private:
-    // One queue per game
-    Queue<QueueEntry> pingpongQueue;
-    Queue<QueueEntry> snakeQueue;
-    Queue<QueueEntry> tankQueue;
-    
-    // Player storage and services
-    HashTable<int, Player>* playerStorage;
+    // One shard per game, indexed by game ID
+    MatchmakingShard shards[GameRegistry::MAX_GAMES];
+
+    // Player storage, ratings and game registry
+    const GameRegistry* games;
+    PlayerStore* players;
     RankingService* rankingService;
-    HistoryService* historyService;
-    
-    // Match tracking
-    HashTable<int, Match> activeMatches;
-    int nextMatchId;
-    
-    // Bot player IDs (per game)
-    static const int MAX_BOTS_PER_GAME = 20;
-    int pingpongBots[MAX_BOTS_PER_GAME];
-    int snakeBots[MAX_BOTS_PER_GAME];
-    int tankBots[MAX_BOTS_PER_GAME];
-    int pingpongBotCount;
-    int snakeBotCount;
-    int tankBotCount;
-    
-    // Get queue for a specific game
-    Queue<QueueEntry>* getQueueForGame(const char* gameName) {
-        if (strcmp(gameName, "pingpong") == 0) return &pingpongQueue;
-        if (strcmp(gameName, "snake") == 0) return &snakeQueue;
-        if (strcmp(gameName, "tank") == 0) return &tankQueue;
-        return nullptr;
-    }
-    
-    // Get bot array for a specific game
-    int* getBotsForGame(const char* gameName, int& count) {
-        if (strcmp(gameName, "pingpong") == 0) { count = pingpongBotCount; return pingpongBots; }
-        if (strcmp(gameName, "snake") == 0) { count = snakeBotCount; return snakeBots; }
-        if (strcmp(gameName, "tank") == 0) { count = tankBotCount; return tankBots; }
-        count = 0;
-        return nullptr;
-    }
-    
-    // Get current timestamp in milliseconds
-    long long getCurrentTime() {
-        return static_cast<long long>(time(nullptr));
+
+    // Clock shared with the shards, and the rating period schedule
+    const TimeSource* timeSource;
+    long long ratingPeriodNanos;
+    std::atomic<long long> nextRatingPeriodAt;
+
+    // Write-ahead log (nullptr unless persistence is on)
+    StateLog* stateLog;
+
+    // Shard for a game, or nullptr
+    MatchmakingShard* getShard(int gameId) {
+        return games->isValid(gameId) ? &shards[gameId] : nullptr;
+    }
+
+    // Shard that created a match, or nullptr
+    MatchmakingShard* getShardForMatch(int matchId) {
+        return matchId > 0 ? getShard(MatchmakingShard::shardOfMatch(matchId)) : nullptr;
     }
 
 public:
-    Matchmaker(HashTable<int, Player>* storage, RankingService* ranking, HistoryService* history)
-        : playerStorage(storage), rankingService(ranking), 
-          historyService(history), nextMatchId(1),
-          pingpongBotCount(0), snakeBotCount(0), tankBotCount(0) {}
-    
-    /**
-     * Register a bot for a specific game
-     */
-    void registerBot(int botId, const char* gameName) {
-        if (strcmp(gameName, "pingpong") == 0 && pingpongBotCount < MAX_BOTS_PER_GAME) {
-            pingpongBots[pingpongBotCount++] = botId;
-        } else if (strcmp(gameName, "snake") == 0 && snakeBotCount < MAX_BOTS_PER_GAME) {
-            snakeBots[snakeBotCount++] = botId;
-        } else if (strcmp(gameName, "tank") == 0 && tankBotCount < MAX_BOTS_PER_GAME) {
-            tankBots[tankBotCount++] = botId;
+    Matchmaker(PlayerStore* store, RankingService* ranking, HistoryService* history,
+               const GameRegistry* registry)
+        : games(registry), players(store), rankingService(ranking),
+          timeSource(&SystemTime::instance()), ratingPeriodNanos(DEFAULT_RATING_PERIOD_NANOS),
+          nextRatingPeriodAt(Clock::monotonicNanos() + DEFAULT_RATING_PERIOD_NANOS), stateLog(nullptr) {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            shards[g].attach(g, registry, store, ranking, history);
+        }
+    }
+
+    Matchmaker(const Matchmaker&) = delete;
+    Matchmaker& operator=(const Matchmaker&) = delete;
+
+    /**
+     * Enable/disable per-match console logging (off for benchmarks)
+     */
+    void setLogging(bool enabled) {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            shards[g].setLogging(enabled);
+        }
+    }
+
+    /**
+     * Set the listener told about each new match (nullptr to clear)
+     *
+     * Called on the thread that made the match (usually a shard's tick
+     * thread) with that shard's lock held. Used to push matches made by the
+     * background tick to waiting clients.
+     */
+    void setMatchListener(MatchListener listener, void* context) {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            shards[g].setMatchListener(listener, context);
+        }
+    }
+
+    /**
+     * Append every state change to a write-ahead log (nullptr = off)
+     *
+     * Attached after startup state is restored, so replayed operations
+     * are not logged again.
+     */
+    void setStateLog(StateLog* log) {
+        stateLog = log;
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            shards[g].setStateLog(log);
         }
     }
-    
+
+    /**
+     * Re-create a logged match with its original pairing (replay; see
+     * MatchmakingShard::restoreMatch)
+     */
+    bool restoreMatch(const Match& match) {
+        MatchmakingShard* shard = getShardForMatch(match.matchId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->restoreMatch(match);
+    }
+
+    /**
+     * Register a bot for a specific game (no limit on bots per game)
+     */
+    void registerBot(int botId, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        shard->registerBot(botId);
+    }
+
+    /**
+     * Register many bots (by player index) for a game under one lock
+     */
+    void registerBots(const int* botIndexes, int count, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        shard->registerBots(botIndexes, count);
+    }
+
+    /**
+     * Number of bots registered for a game
+     */
+    int getBotCount(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return 0;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->getBotCount();
+    }
+
     /**
      * Add player to matchmaking queue for a game
-     * 
+     *
      * @param playerId Player joining queue
-     * @param gameName Game to queue for
+     * @param gameId ID of the game to queue for
      * @return true if successfully queued
      */
-    bool joinQueue(int playerId, const char* gameName) {
-        Player* player = playerStorage->get(playerId);
-        if (!player) return false;
-        
-        // Check if already in queue or match
-        if (player->isInQueue || player->isInMatch) {
-            return false;
-        }
-        
-        Queue<QueueEntry>* queue = getQueueForGame(gameName);
-        if (!queue) return false;
-        
-        // Add to queue
-        QueueEntry entry(playerId, getCurrentTime());
-        queue->enqueue(entry);
-        
-        // Update player state
-        player->isInQueue = true;
-        player->setPreferredGame(gameName);
-        playerStorage->update(playerId, *player);
-        
-        // Add to ranking tree for this game
-        rankingService->addPlayerToRanking(playerId, gameName);
-        
+    bool joinQueue(int playerId, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->joinQueue(playerId);
+    }
+
+    /**
+     * Add player to a game's queue with their latency bucket and input
+     * device (used by the greedy path's CandidateIndex)
+     */
+    bool joinQueue(int playerId, int gameId, const MatchAttributes& attributes) {
+        return joinQueue(playerId, gameId, attributes, [](size_t) {});
+    }
+
+    // Join with attributes, calling onQueued(queueSize) under the shard lock
+    template <typename OnQueued>
+    bool joinQueue(int playerId, int gameId, const MatchAttributes& attributes, OnQueued onQueued) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        if (!shard->joinQueue(playerId, &attributes)) return false;
+        onQueued(shard->getQueueSize());
         return true;
     }
-    
+
     /**
-     * Remove player from matchmaking queue
+     * Add player to a game's queue, then call onQueued(queueSize) while
+     * still holding the shard lock
      * 
+     * Lets the caller acknowledge the join before the game's tick can
+     * announce a match for the player.
+     */
+    template <typename OnQueued>
+    bool joinQueue(int playerId, int gameId, OnQueued onQueued) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        if (!shard->joinQueue(playerId)) return false;
+        onQueued(shard->getQueueSize());
+        return true;
+    }
+
+    /**
+     * Queue a party for a game as one entry (see MatchmakingShard::joinParty)
+     *
+     * @param memberIds Members, leader first
+     * @param count Party size: the game's team size (2..Party::MAX_SIZE)
+     * @return true if every member was queued
+     */
+    bool joinPartyQueue(const int* memberIds, int count, int gameId) {
+        return joinPartyQueue(memberIds, count, gameId, [](size_t) {});
+    }
+
+    // Party join, calling onQueued(queueSize) under the shard lock
+    template <typename OnQueued>
+    bool joinPartyQueue(const int* memberIds, int count, int gameId, OnQueued onQueued) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        if (!shard->joinParty(memberIds, count)) return false;
+        onQueued(shard->getQueueSize());
+        return true;
+    }
+
+    /**
+     * Remove player from matchmaking queue
+     *
      * @param playerId Player leaving queue
-     * @param gameName Game queue to leave
+     * @param gameId ID of the game queue to leave
      * @return true if successfully removed
      */
-    bool leaveQueue(int playerId, const char* gameName) {
-        Player* player = playerStorage->get(playerId);
-        if (!player || !player->isInQueue) return false;
-        
-        Queue<QueueEntry>* queue = getQueueForGame(gameName);
-        if (!queue) return false;
-        
-        // Remove from queue
-        QueueEntry entry(playerId, 0);
-        if (queue->remove(entry)) {
-            player->isInQueue = false;
-            playerStorage->update(playerId, *player);
-            
-            // Remove from ranking tree
-            rankingService->removePlayerFromRanking(playerId, player->elo, gameName);
-            return true;
-        }
-        
-        return false;
+    bool leaveQueue(int playerId, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->leaveQueue(playerId);
     }
-    
+
     /**
-     * Try to create a match - CORE MATCHMAKING ALGORITHM
-     * 
-     * This is the main matchmaking logic using AVL tree for closest-rank search.
-     * 
-     * WAIT FOR HUMAN FIRST:
-     * - Wait for a human opponent for 10 seconds
-     * - Only fall back to bot if no human joins in time
-     * 
-     * @param gameName Game to match for
+     * Remove player from whichever queue they are in
+     *
+     * The queued game is read from the player's state word - O(1).
+     *
+     * @return true if the player was queued and has been removed
+     */
+    bool leaveCurrentQueue(int playerId) {
+        int gameId = getPlayerQueuedGame(playerId);
+        return gameId != GameRegistry::NO_GAME && leaveQueue(playerId, gameId);
+    }
+
+    /**
+     * Try to create a single match - GREEDY PATH (see MatchmakingShard)
+     *
+     * @param gameId ID of the game to match for
      * @return Match ID if match created, -1 otherwise
      */
-    int tryCreateMatch(const char* gameName) {
-        Queue<QueueEntry>* queue = getQueueForGame(gameName);
-        if (!queue || queue->isEmpty()) return -1;
-        
-        // Get bot count for this game
-        int botCount = 0;
-        int* bots = getBotsForGame(gameName, botCount);
-        
-        // WAIT FOR HUMAN: If only 1 player, check if they've waited long enough (10 seconds)
-        if (queue->size() == 1) {
-            QueueEntry* frontEntry = queue->front();
-            if (frontEntry) {
-                long long waitTime = getCurrentTime() - frontEntry->joinTime;
-                // Wait 5 seconds for a human opponent before matching with bot
-                if (waitTime < 5) {
-                    return -1;  // Keep waiting for human opponent
-                }
-            }
-            // Waited long enough, match with bot
-            return matchHumanWithBot(gameName);
-        }
-        
-        // CASE B: Queue size >= 2 -> Try Human vs Human first
-        QueueEntry entry1;
-        if (!queue->dequeue(entry1)) return -1;
-        
-        Player* player1 = playerStorage->get(entry1.playerId);
-        if (!player1) return -1;
-        
-        // Check if player1 is a bot - if so, skip and try to find humans
-        if (player1->isBot) {
-            // Re-queue the bot and try again
-            queue->enqueue(entry1);
-            return -1;
-        }
-        
-        // CRITICAL: Temporarily remove player1 from AVL tree to avoid self-matching
-        rankingService->removePlayerFromRanking(entry1.playerId, player1->elo, gameName);
-        
-        // Find closest HUMAN opponent using AVL tree
-        int opponentId = findClosestHumanOpponent(entry1.playerId, gameName);
-        
-        if (opponentId == -1) {
-            // No human opponent found - match with bot instead
-            rankingService->addPlayerToRanking(entry1.playerId, gameName);
-            
-            // Find closest bot (pass human player ID for recent opponent check)
-            int botOpponentId = findClosestBotOpponent(entry1.playerId, player1->elo, gameName);
-            if (botOpponentId == -1) {
-                // No bot available - re-queue player
-                queue->enqueue(entry1);
-                return -1;
-            }
-            
-            // Create match with bot
-            return createMatchBetween(entry1.playerId, botOpponentId, gameName);
-        }
-        
-        // Get human opponent
-        Player* player2 = playerStorage->get(opponentId);
-        if (!player2) {
-            rankingService->addPlayerToRanking(entry1.playerId, gameName);
-            queue->enqueue(entry1);
-            return -1;
-        }
-        
-        // Remove opponent from queue and tree
-        QueueEntry opponentEntry(opponentId, 0);
-        queue->remove(opponentEntry);
-        rankingService->removePlayerFromRanking(opponentId, player2->elo, gameName);
-        
-        // Create match
-        return createMatchBetween(entry1.playerId, opponentId, gameName);
+    int tryCreateMatch(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return -1;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->tryCreateMatch();
     }
-    
+
     /**
      * Match a human player with the closest-ELO bot (DEMO MODE)
      */
-    int matchHumanWithBot(const char* gameName) {
-        Queue<QueueEntry>* queue = getQueueForGame(gameName);
-        if (!queue || queue->isEmpty()) return -1;
-        
-        // Dequeue the human player
-        QueueEntry entry;
-        if (!queue->dequeue(entry)) return -1;
-        
-        Player* human = playerStorage->get(entry.playerId);
-        if (!human) return -1;
-        
-        // Bots should never be in queue, but check just in case
-        if (human->isBot) {
-            queue->enqueue(entry);
-            return -1;
-        }
-        
-        // Remove human from ranking tree temporarily
-        rankingService->removePlayerFromRanking(entry.playerId, human->elo, gameName);
-        
-        // Find closest bot (pass human player ID for recent opponent check)
-        int botId = findClosestBotOpponent(entry.playerId, human->elo, gameName);
-        if (botId == -1) {
-            // No bot available - re-add human to queue
-            rankingService->addPlayerToRanking(entry.playerId, gameName);
-            queue->enqueue(entry);
-            return -1;
-        }
-        
-        // Create match
-        return createMatchBetween(entry.playerId, botId, gameName);
-    }
-    
-    /**
-     * Find the closest ELO human opponent (excludes bots)
-     */
-    int findClosestHumanOpponent(int playerId, const char* gameName) {
-        int opponentId = rankingService->findClosestOpponent(playerId, gameName);
-        if (opponentId == -1) return -1;
-        
-        Player* opponent = playerStorage->get(opponentId);
-        if (!opponent) return -1;
-        
-        // Only return human opponents
-        if (!opponent->isBot && opponent->isInQueue) {
-            return opponentId;
-        }
-        return -1;
+    int matchHumanWithBot(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return -1;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->matchHumanWithBot();
     }
-    
+
     /**
-     * Find the closest ELO bot opponent
-     * 
-     * ENHANCED: Skips bots that were recently matched with this player
-     * to ensure opponent rotation and fair matchmaking.
-     * 
-     * Selection criteria (in order):
-     * 1. Bot must not be in a match
-     * 2. Bot must not be in player's recent opponent list
-     * 3. Among eligible bots, select the closest ELO
-     * 4. If all bots are recent, fallback to absolute closest (deadlock prevention)
-     */
-    int findClosestBotOpponent(int humanPlayerId, int targetElo, const char* gameName) {
-        int botCount = 0;
-        int* bots = getBotsForGame(gameName, botCount);
-        if (!bots || botCount == 0) return -1;
-        
-        Player* human = playerStorage->get(humanPlayerId);
-        if (!human) return -1;
-        
-        int bestBotId = -1;
-        int bestEloDiff = 999999;
-        
-        int fallbackBotId = -1;  // Absolute closest for deadlock prevention
-        int fallbackEloDiff = 999999;
-        
-        for (int i = 0; i < botCount; i++) {
-            int botId = bots[i];
-            Player* bot = playerStorage->get(botId);
-            if (!bot || bot->isInMatch) continue;
-            
-            int eloDiff = bot->elo - targetElo;
-            if (eloDiff < 0) eloDiff = -eloDiff;
-            
-            // Track absolute closest for fallback
-            if (eloDiff < fallbackEloDiff) {
-                fallbackEloDiff = eloDiff;
-                fallbackBotId = botId;
-            }
-            
-            // Skip if recently matched (opponent rotation)
-            if (human->wasRecentOpponent(botId)) {
-                continue;  // Don't match with same bot again
-            }
-            
-            // Find best among eligible bots
-            if (eloDiff < bestEloDiff) {
-                bestEloDiff = eloDiff;
-                bestBotId = botId;
-            }
-        }
-        
-        // If no eligible bot found (all recently matched), use fallback
-        if (bestBotId == -1) {
-            printf("[Matchmaker] All bots recently matched with player %d - using fallback\n", humanPlayerId);
-            bestBotId = fallbackBotId;
-        }
-        
-        return bestBotId;
+     * Find the closest ELO human opponent within an ELO window (excludes bots)
+     */
+    int findClosestHumanOpponent(int playerId, int gameId, int window) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return -1;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->findClosestHumanOpponent(playerId, window);
     }
-    
+
+    /**
+     * Find the closest ELO free bot, skipping the human's recent opponents
+     *
+     * Time Complexity: O(log b) binary search + bitset scan for b bots
+     */
+    int findClosestBotOpponent(int humanPlayerId, int targetElo, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return -1;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->findClosestBotOpponent(humanPlayerId, targetElo);
+    }
+
     /**
      * Create a match between two players (human or bot)
-     * 
-     * ENHANCED: Records opponent in recent history for rotation
-     */
-    int createMatchBetween(int player1Id, int player2Id, const char* gameName) {
-        Player* player1 = playerStorage->get(player1Id);
-        Player* player2 = playerStorage->get(player2Id);
-        
-        if (!player1 || !player2) return -1;
-        
-        // Record recent opponents for matchmaking rotation
-        // Only track for human players (bots don't need rotation tracking)
-        if (!player1->isBot) {
-            player1->addRecentOpponent(player2Id);
-            printf("[Matchmaker] Player %s matched with %s (ELO diff: %d)\n", 
-                   player1->username, player2->username, 
-                   player1->elo > player2->elo ? player1->elo - player2->elo : player2->elo - player1->elo);
-        }
-        if (!player2->isBot) {
-            player2->addRecentOpponent(player1Id);
-        }
-        
-        // Create match
-        Match match(nextMatchId++, player1Id, player2Id, gameName);
-        activeMatches.insert(match.matchId, match);
-        
-        // Update player states
-        player1->isInQueue = false;
-        player1->isInMatch = true;
-        playerStorage->update(player1Id, *player1);
-        
-        player2->isInQueue = false;
-        player2->isInMatch = true;
-        playerStorage->update(player2Id, *player2);
-        
-        return match.matchId;
-    }
-    
-    /**
-     * Process matchmaking for a specific game
-     * 
-     * Should be called periodically to create matches.
-     * 
-     * @param gameName Game to process
+     *
+     * Both must be idle or queued for gameId.
+     *
+     * @return Match ID, or -1
+     */
+    int createMatchBetween(int player1Id, int player2Id, int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return -1;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->createMatchBetween(player1Id, player2Id);
+    }
+
+    /**
+     * Process matchmaking for a specific game - BATCH PATH
+     *
+     * Called once per tick for every game by MatchmakingTicker (one thread
+     * per game). Holds only that game's shard lock.
+     *
+     * Time Complexity: O(n log n) for n queued players
+     *
+     * @param gameId ID of the game to process
      * @return Number of matches created
      */
-    int processMatchmaking(const char* gameName) {
-        int matchesCreated = 0;
-        
-        // Try to create matches while queue has 2+ players
-        while (getQueueSize(gameName) >= 2) {
-            int matchId = tryCreateMatch(gameName);
-            if (matchId == -1) break;
-            matchesCreated++;
-        }
-        
-        // Also try to match single player with bot (if they've waited long enough)
-        if (getQueueSize(gameName) == 1) {
-            int matchId = tryCreateMatch(gameName);
-            if (matchId != -1) {
-                matchesCreated++;
-            }
-        }
-        
-        return matchesCreated;
+    int processMatchmaking(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return 0;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->processMatchmaking();
     }
-    
+
     /**
      * Submit match result
-     * 
+     *
      * @param matchId ID of the completed match
      * @param winnerId ID of the winning player
      * @return true if result recorded successfully
      */
     bool submitMatchResult(int matchId, int winnerId) {
-        Match* match = activeMatches.get(matchId);
-        if (!match || match->isCompleted) return false;
-        
-        // Validate winner is part of the match
-        if (winnerId != match->player1Id && winnerId != match->player2Id) {
-            return false;
+        MatchmakingShard* shard = getShardForMatch(matchId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->submitMatchResult(matchId, winnerId);
+    }
+
+    /**
+     * Copy a match by ID (in progress, or completed within the grace window)
+     *
+     * Copied out under the shard lock; the shard's tick may evict it later.
+     *
+     * @return false if unknown or already evicted
+     */
+    bool getMatch(int matchId, Match& outMatch) {
+        MatchmakingShard* shard = getShardForMatch(matchId);
+        if (!shard) return false;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        Match* match = shard->getMatch(matchId);
+        if (!match) return false;
+        outMatch = *match;
+        return true;
+    }
+
+    /**
+     * How long completed matches stay readable by ID (0 = evict on next sweep)
+     */
+    void setCompletedMatchGrace(long long nanos) {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            shards[g].setCompletedMatchGrace(nanos);
         }
-        
-        // Complete the match
-        int loserId = (winnerId == match->player1Id) ? match->player2Id : match->player1Id;
-        match->complete(winnerId);
-        
-        // Update rankings (this handles ELO calculation)
-        rankingService->updateRankings(winnerId, loserId, match->gameName);
-        
-        // Record to history
-        historyService->recordMatch(*match);
-        
-        // Update player states
-        Player* winner = playerStorage->get(winnerId);
-        Player* loser = playerStorage->get(loserId);
-        
-        if (winner) {
-            winner->isInMatch = false;
-            playerStorage->update(winnerId, *winner);
+    }
+
+    /**
+     * Clock every shard reads (nullptr = real time)
+     *
+     * Set before matchmaking starts; a VirtualClock makes runs
+     * deterministic and lets a driver advance time itself.
+     */
+    void setTimeSource(const TimeSource* source) {
+        timeSource = source ? source : &SystemTime::instance();
+        nextRatingPeriodAt.store(timeSource->monotonicNanos() + ratingPeriodNanos, std::memory_order_relaxed);
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            shards[g].setTimeSource(source);
+        }
+    }
+
+    /**
+     * Length of a rating period (GLICKO2); set before matchmaking starts
+     */
+    void setRatingPeriodNanos(long long nanos) {
+        ratingPeriodNanos = nanos < Clock::NANOS_PER_SECOND ? Clock::NANOS_PER_SECOND : nanos;
+        nextRatingPeriodAt.store(timeSource->monotonicNanos() + ratingPeriodNanos, std::memory_order_relaxed);
+    }
+
+    long long getRatingPeriodNanos() const {
+        return ratingPeriodNanos;
+    }
+
+    /**
+     * Close the current rating period now (GLICKO2; no-op under ELO)
+     *
+     * Holds every shard lock. Each game's buffered results are applied in
+     * one batch; every player whose ELO in that game moved is re-keyed in
+     * the game's shard (ratings are per game, so no other shard indexes
+     * them).
+     *
+     * Time Complexity: O(r + p log n) for r results and p players re-rated
+     *
+     * @return Number of players re-rated
+     */
+    int closeRatingPeriod() {
+        if (rankingService->getRatingSystem() != RankingService::GLICKO2) return 0;
+        ExclusiveLock exclusive(*this);
+        int rated = 0;
+        for (int g = 0; g < games->size(); g++) {
+            MatchmakingShard& shard = shards[g];
+            rated += rankingService->closeRatingPeriod(g, [&shard](int index, int oldElo) {
+                shard.ratingChanged(index, oldElo);
+            });
         }
-        
-        if (loser) {
-            loser->isInMatch = false;
-            playerStorage->update(loserId, *loser);
+        rankingService->finishRatingPeriod();
+        if (stateLog) stateLog->ratingPeriodClosed();
+        return rated;
+    }
+
+    /**
+     * End a game's season and start the next with a soft rating reset
+     *
+     * Applies any open rating period first, then, holding every shard
+     * lock (the reset writes a whole rating column), archives the
+     * standings, resets the game's ratings and ranking tree in place
+     * (RankingService::startSeason) and re-keys the game's shard.
+     *
+     * Time Complexity: O(p + n + R) for p players and n ranked players
+     *
+     * @return The new season number, or -1 for an unknown game
+     */
+    int startSeason(int gameId, const RankingService::SeasonRules& rules) {
+        if (!games->isValid(gameId)) return -1;
+        closeRatingPeriod();
+        return rollOverSeason(gameId, rules);
+    }
+
+    /**
+     * The second half of startSeason(): archive and soft-reset without
+     * closing the rating period first (replay, where the period close is
+     * its own logged record)
+     */
+    int rollOverSeason(int gameId, const RankingService::SeasonRules& rules) {
+        if (!games->isValid(gameId)) return -1;
+        ExclusiveLock exclusive(*this);
+        int season = rankingService->startSeason(gameId, rules);
+        if (season > 0) shards[gameId].ratingsReset();
+        if (stateLog) stateLog->seasonStarted(gameId, rules.target, rules.keepPercent);
+        return season;
+    }
+
+    /**
+     * Close the rating period if it has run its length - O(1) when not due
+     *
+     * Called by every tick thread; the compare-and-swap on the deadline
+     * lets exactly one caller close each period.
+     *
+     * @return true if this call closed a period
+     */
+    bool closeRatingPeriodIfDue() {
+        if (rankingService->getRatingSystem() != RankingService::GLICKO2) return false;
+        long long now = timeSource->monotonicNanos();
+        long long due = nextRatingPeriodAt.load(std::memory_order_relaxed);
+        if (now < due) return false;
+        if (!nextRatingPeriodAt.compare_exchange_strong(due, now + ratingPeriodNanos, std::memory_order_relaxed)) {
+            return false;
         }
-        
-        // Re-add players to ranking trees for future matchmaking
-        rankingService->addPlayerToRanking(winnerId, match->gameName);
-        rankingService->addPlayerToRanking(loserId, match->gameName);
-        
+        closeRatingPeriod();
         return true;
     }
-    
+
     /**
-     * Get match by ID
+     * Gauge: matches held in the active sets of all shards
      */
-    Match* getMatch(int matchId) {
-        return activeMatches.get(matchId);
+    size_t getActiveMatchCount() {
+        size_t total = 0;
+        for (int g = 0; g < games->size(); g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            total += shards[g].getActiveMatchCount();
+        }
+        return total;
     }
-    
+
+    /**
+     * Gauge: completed matches still held for result polling
+     */
+    size_t getRetiringMatchCount() {
+        size_t total = 0;
+        for (int g = 0; g < games->size(); g++) {
+            std::lock_guard<std::mutex> guard(shards[g].mutex());
+            total += shards[g].getRetiringMatchCount();
+        }
+        return total;
+    }
+
+    /**
+     * Match-quality histograms for a game (queue wait, ELO gap, human vs
+     * bot), or nullptr for an unknown game
+     *
+     * Lock-free reads; no shard lock is taken.
+     */
+    const MatchTelemetry* getTelemetry(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        return shard ? &shard->getTelemetry() : nullptr;
+    }
+
     /**
      * Get queue size for a game
      */
-    size_t getQueueSize(const char* gameName) {
-        Queue<QueueEntry>* queue = getQueueForGame(gameName);
-        return queue ? queue->size() : 0;
+    size_t getQueueSize(int gameId) {
+        MatchmakingShard* shard = getShard(gameId);
+        if (!shard) return 0;
+        std::lock_guard<std::mutex> guard(shard->mutex());
+        return shard->getQueueSize();
     }
-    
+
     /**
      * Check if player is in queue
      */
     bool isPlayerInQueue(int playerId) {
-        Player* player = playerStorage->get(playerId);
-        return player && player->isInQueue;
+        int index = players->indexOf(playerId);
+        return index != PlayerStore::NO_PLAYER && players->isInQueue(index);
     }
-    
+
     /**
      * Check if player is in active match
      */
     bool isPlayerInMatch(int playerId) {
-        Player* player = playerStorage->get(playerId);
-        return player && player->isInMatch;
+        int index = players->indexOf(playerId);
+        return index != PlayerStore::NO_PLAYER && players->isInMatch(index);
     }
-    
+
+    /**
+     * Get the ID of the game a player is queued for, or GameRegistry::NO_GAME - O(1)
+     */
+    int getPlayerQueuedGame(int playerId) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return GameRegistry::NO_GAME;
+        PlayerState::Word state = players->getState(index);
+        if (PlayerState::status(state) != PlayerState::QUEUED) return GameRegistry::NO_GAME;
+        return PlayerState::gameId(state);
+    }
+
     /**
-     * Get active match for a player
+     * Get active match for a player - O(1) read of the state word
+     *
+     * The match ID bits of each player's state word are the
+     * PlayerID -> active MatchID index: set when a shard creates the match
+     * and cleared when its result is submitted. No match table is scanned.
      */
     int getPlayerActiveMatch(int playerId) {
-        // Search through active matches
-        // Note: This is O(n) - could be optimized with another hash table
-        int keys[1000];
-        size_t keyCount;
-        activeMatches.getAllKeys(keys, keyCount);
-        
-        for (size_t i = 0; i < keyCount; i++) {
-            Match* match = activeMatches.get(keys[i]);
-            if (match && !match->isCompleted) {
-                if (match->player1Id == playerId || match->player2Id == playerId) {
-                    return match->matchId;
-                }
-            }
-        }
-        return -1;
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return -1;
+        PlayerState::Word state = players->getState(index);
+        if (PlayerState::status(state) != PlayerState::IN_MATCH) return -1;
+        return PlayerState::matchId(state);
+    }
+
+    /**
+     * Copy a player's active match record - O(1)
+     *
+     * @return false if the player is not in a match
+     */
+    bool getPlayerMatch(int playerId, Match& outMatch) {
+        int matchId = getPlayerActiveMatch(playerId);
+        return matchId != -1 && getMatch(matchId, outMatch);
     }
 };
 
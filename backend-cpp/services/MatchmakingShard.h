@@ -0,0 +1,1477 @@
+#ifndef MATCHMAKING_SHARD_H
+#define MATCHMAKING_SHARD_H
+
+#include "../ds/Queue.h"
+#include "../ds/HashTable.h"
+#include "../ds/AVLTree.h"
+#include "../models/Player.h"
+#include "../models/Match.h"
+#include "../models/Party.h"
+#include "../models/PlayerState.h"
+#include "PlayerStore.h"
+#include "RankingService.h"
+#include "HistoryService.h"
+#include "GameRegistry.h"
+#include "BatchMatcher.h"
+#include "BotPool.h"
+#include "TeamBalancer.h"
+#include "CandidateIndex.h"
+#include "MatchTelemetry.h"
+#include "MatchLifecycle.h"
+#include "StateLog.h"
+#include "Clock.h"
+#include "../ds/Sort.h"
+#include <cstdio>
+#include <climits>
+#include <mutex>
+
+/**
+ * MatchmakingShard - Everything matchmaking owns for one game
+ *
+ * A shard holds its game's queue, live-entry count, bot pool, active
+ * matches and batch-matching scratch, and is the only writer of its game's
+ * ranking tree. Nothing in one shard is touched by another, so shards can
+ * run their ticks on separate threads. Matchmaker routes each call to a
+ * shard by game ID (or by the game bits of a match ID) and holds the
+ * shard's mutex around it; every method here assumes that lock is held.
+ *
+ * CROSS-SHARD PROTOCOL (PlayerState word):
+ * The only state shards share is PlayerStore (HistoryService is shared
+ * too, but takes its own lock). A player's state word says which shard
+ * owns them:
+ *   - IDLE: no shard. Any thread may claim the player for game G with one
+ *     CAS IDLE -> QUEUED(G); of two concurrent claims exactly one wins.
+ *   - QUEUED(G) / IN_MATCH(G): owned by shard G. Only code holding shard
+ *     G's lock moves the player on (leave, match, result), and the last
+ *     step, IN_MATCH(G) -> IDLE, hands them back.
+ * A shard therefore never reads or writes a player another shard owns, and
+ * no lock is ever held across two shards. Changes to PlayerStore's own
+ * structure (creating players) lock every shard - see
+ * Matchmaker::ExclusiveLock.
+ *
+ * PARTIES:
+ * A party is one whole team: its size must be the game's team size, so
+ * parties only queue for team games (2..Party::MAX_SIZE per side) and a
+ * party match always has the registered number of players per side;
+ * smaller groups queue solo. A party is queued as one entry (keyed by its
+ * leader) with one rating key, Party::matchElo(), and is indexed by that
+ * key in a per-size tree. Each member's state word is claimed QUEUED(G)
+ * individually, all or nothing. Pairing only ever puts a party against
+ * another party (the batch pass pairs each size class separately); the
+ * two parties become the two teams of the match. Any member leaving releases
+ * the whole party in O(party size) - the entry goes stale like a solo
+ * entry. Parties have no bot fallback; they wait for another party.
+ *
+ * TEAM GAMES (GameRegistry team size N > 1):
+ * Solo players are formed into NvN matches by the batch tick only: the
+ * snapshot's solo players are sorted by ELO, each run of 2N neighbours
+ * whose spread fits inside every member's acceptance window is taken, and
+ * TeamBalancer splits the run into the two teams with the closest total
+ * ELO. Solo players in a team game never get a bot or a 1v1 match.
+ *
+ * CANDIDATES:
+ * Queued solo humans are also kept in a CandidateIndex keyed by ELO,
+ * latency bucket and input device, so the greedy path finds the
+ * lowest-cost compatible opponent (ELO gap plus latency and cross-play
+ * penalties, inside the acceptance window) without scanning the queue.
+ * The batch tick applies the same rules: solo players are paired inside
+ * their (latency bucket, device) cell first, then across compatible cells
+ * at CandidateIndex's penalties, and team runs are formed the same way
+ * (pairSolo, formTeamMatches). Incompatible players are never matched.
+ * Parties carry no attributes and are paired on ELO alone.
+ *
+ * TELEMETRY:
+ * Every match created records its ELO gap, and every queued human in it
+ * their queue wait, in the shard's MatchTelemetry (human-vs-human and
+ * human-vs-bot separately). Recording is lock-free, so readers need no
+ * shard lock.
+ *
+ * RATINGS:
+ * Every ELO the shard reads - queue snapshot, candidate index, bot pool,
+ * ranking tree, telemetry - is the player's rating in this game (eloOf,
+ * PlayerStore's column for the game), so results here never move a
+ * player's standing in another game.
+ *
+ * SEASONS:
+ * A new season rewrites every rating in the game at once (soft reset,
+ * see RankingService::startSeason); ratingsReset() then re-keys the bot
+ * pool, candidate index and party index from the new ratings in one pass.
+ *
+ * RATING PERIODS (Glicko-2):
+ * With RankingService in GLICKO2 mode a result changes no ELO when it is
+ * submitted. ELOs move when Matchmaker closes the rating period; each
+ * moved player is re-keyed (ratingChanged) in this game's shard, the only
+ * one that indexes that rating.
+ *
+ * TIME:
+ * Wait times, acceptance windows, bot fallback, match timestamps and
+ * match eviction all read the shard's TimeSource - the real clock unless
+ * a VirtualClock is injected (matchmaking_sim), so whole runs can be
+ * replayed from a seed faster than real time.
+ *
+ * MATCH IDS:
+ * The low MATCH_SHARD_BITS of a match ID are the shard's game ID and the
+ * rest a per-shard sequence, so IDs are unique without a shared counter
+ * and any match can be routed to its shard from the ID alone. Match IDs
+ * are positive ints, so the sequence wraps after MAX_MATCH_SEQUENCE
+ * matches (it survives restarts in snapshots) and then skips IDs still
+ * held by a match in progress or in its grace window.
+ *
+ * SCALING ONE HOT GAME (ELO bands):
+ * A game too busy for one thread splits by ELO instead: band shards own
+ * contiguous ELO ranges of the same game, each with its own queue, tree
+ * slice and bots, and a player is queued in the band containing their
+ * ELO. Everything above carries over with "game" read as "band" (the state
+ * word and match ID name the band). What bands add is the edge: a player
+ * whose acceptance window reaches across a band boundary is invisible to
+ * the neighbouring band. Each tick, a band hands players whose window
+ * crosses its edge to the neighbour with a QUEUED(A) -> QUEUED(B) CAS
+ * (the same ownership move as a claim); the receiving band pairs them in
+ * its next snapshot. Bands are sized by population, not ELO width, so
+ * each carries a similar queue, and boundaries only move between ticks.
+ */
+class MatchmakingShard {
+public:
+    static const int MATCH_SHARD_BITS = 4;
+    static const int MATCH_SHARD_MASK = (1 << MATCH_SHARD_BITS) - 1;
+    static const int MAX_MATCH_SEQUENCE = INT_MAX >> MATCH_SHARD_BITS;
+
+    /**
+     * Called once for every match created, after both players are in it
+     *
+     * Runs on the thread that created the match, with the shard's lock held.
+     */
+    typedef void (*MatchListener)(const Match& match, void* context);
+
+    // How long a lone human waits for another human before a bot is used
+    static const long long BOT_FALLBACK_WAIT_NANOS = 5 * Clock::NANOS_PER_SECOND;
+
+    // Acceptance window (half-width, in ELO points) as a function of wait time
+    static const long long INITIAL_WINDOW_ELO = 100;
+    static const long long WINDOW_GROWTH_ELO_PER_SECOND = 50;
+    static const long long MAX_WINDOW_ELO = 600;
+
+private:
+    static_assert((1 << MATCH_SHARD_BITS) >= GameRegistry::MAX_GAMES,
+                  "match IDs must have room for every game ID");
+    static_assert(Party::MAX_SIZE <= Match::MAX_TEAM_SIZE,
+                  "a party must fit in one team");
+    static_assert(GameRegistry::MAX_TEAM_SIZE <= Match::MAX_TEAM_SIZE &&
+                  GameRegistry::MAX_TEAM_SIZE <= TeamBalancer::MAX_TEAM_SIZE,
+                  "every configurable team size must fit in a match");
+
+    // batchPartners mark for players placed in a team match this tick
+    static const int TEAMED = -2;
+
+    // Candidate cells: latency bucket x input device
+    static const int CELL_COUNT = MatchAttributes::LATENCY_BUCKETS * MatchAttributes::DEVICE_COUNT;
+
+    int gameId;
+    const GameRegistry* games;
+    PlayerStore* players;
+    RankingService* rankingService;
+    HistoryService* historyService;
+
+    std::mutex lock;
+
+    // FIFO lobby and the number of players queued in it (party members count)
+    Queue<QueueEntry> queue;
+    int liveCount;
+
+    // Queued parties: leader -> party, member -> leader, and one index per
+    // party size keyed by (matchElo, leaderId)
+    HashTable<int, Party> queuedParties;
+    HashTable<int, int> partyOf;
+    AVLTree<PlayerELO> partyIndex[Party::MAX_SIZE + 1];
+
+    // Queued solo humans by (latency bucket, device) cell and ELO
+    CandidateIndex candidates;
+
+    // Wait-time and ELO-gap histograms for matches created here
+    MatchTelemetry telemetry;
+
+    // This game's bots (player indexes sorted by ELO, free/busy bitset)
+    BotPool bots;
+
+    // Match tracking (in progress + completed within the grace window)
+    MatchLifecycle activeMatches;
+    int nextMatchSequence;
+
+    // Batch matching snapshot (scratch buffers reused across ticks)
+    BatchMatcher batchMatcher;
+    QueueEntry* batchEntries;
+    int* batchElos;
+    long long* batchSkipCosts;
+    int* batchCells;          // Candidate cell of each solo entry
+    int* batchPartners;
+    int* classMembers;        // Snapshot indexes of one party-size class
+    int* classElos;
+    long long* classSkipCosts;
+    int* classCells;
+    int* classPartners;
+    int* teamOrder;           // Solo snapshot indexes sorted by ELO (team games)
+    int* teamSortScratch;
+    int batchCapacity;
+
+    bool logging;
+    const TimeSource* timeSource;
+    MatchListener matchListener;
+    void* matchListenerContext;
+    StateLog* stateLog;  // nullptr unless persistence is on
+
+    // Grow the snapshot buffers to hold count entries
+    void reserveBatch(int count) {
+        if (count <= batchCapacity) return;
+        int newCapacity = batchCapacity == 0 ? 64 : batchCapacity * 2;
+        while (newCapacity < count) newCapacity *= 2;
+
+        QueueEntry* entries = new QueueEntry[newCapacity];
+        int* elos = new int[newCapacity];
+        long long* skipCosts = new long long[newCapacity];
+        int* cells = new int[newCapacity];
+        for (int i = 0; i < batchCapacity; i++) {
+            entries[i] = batchEntries[i];
+            elos[i] = batchElos[i];
+            skipCosts[i] = batchSkipCosts[i];
+            cells[i] = batchCells[i];
+        }
+        releaseBatch();
+        batchEntries = entries;
+        batchElos = elos;
+        batchSkipCosts = skipCosts;
+        batchCells = cells;
+        batchPartners = new int[newCapacity];
+        classMembers = new int[newCapacity];
+        classElos = new int[newCapacity];
+        classSkipCosts = new long long[newCapacity];
+        classCells = new int[newCapacity];
+        classPartners = new int[newCapacity];
+        teamOrder = new int[newCapacity];
+        teamSortScratch = new int[newCapacity];
+        batchCapacity = newCapacity;
+    }
+
+    void releaseBatch() {
+        delete[] batchEntries;
+        delete[] batchElos;
+        delete[] batchSkipCosts;
+        delete[] batchCells;
+        delete[] batchPartners;
+        delete[] classMembers;
+        delete[] classElos;
+        delete[] classSkipCosts;
+        delete[] classCells;
+        delete[] classPartners;
+        delete[] teamOrder;
+        delete[] teamSortScratch;
+    }
+
+    // Orders snapshot indexes by ELO
+    struct ByBatchElo {
+        const int* elos;
+        explicit ByBatchElo(const int* e) : elos(e) {}
+        bool operator()(int a, int b) const { return elos[a] < elos[b]; }
+    };
+
+    // Orders snapshot indexes by candidate cell, then ELO
+    struct ByBatchCellElo {
+        const int* cells;
+        const int* elos;
+        ByBatchCellElo(const int* c, const int* e) : cells(c), elos(e) {}
+        bool operator()(int a, int b) const {
+            return cells[a] != cells[b] ? cells[a] < cells[b] : elos[a] < elos[b];
+        }
+    };
+
+    // Players per side in this game (1 = one-on-one)
+    int teamSize() const {
+        return games ? games->getTeamSize(gameId) : 1;
+    }
+
+    // A player's rating in this game (PlayerStore's column for the game)
+    int eloOf(int index) const {
+        return players->getElo(index, gameId);
+    }
+
+    static int cellOf(const MatchAttributes& attributes) {
+        return attributes.latencyBucket * MatchAttributes::DEVICE_COUNT + attributes.device;
+    }
+
+    // CandidateIndex's penalty between two cells, or CandidateIndex::INCOMPATIBLE
+    static int cellPenalty(int a, int b) {
+        return CandidateIndex::penalty(
+            MatchAttributes(a / MatchAttributes::DEVICE_COUNT, a % MatchAttributes::DEVICE_COUNT),
+            MatchAttributes(b / MatchAttributes::DEVICE_COUNT, b % MatchAttributes::DEVICE_COUNT));
+    }
+
+    /**
+     * Fixed penalty of a run of players: the largest cell penalty between
+     * any two of them, or CandidateIndex::INCOMPATIBLE if any two may not
+     * meet (sameCell: unless they all share one cell). The run is sorted
+     * by cell when sameCell is set.
+     */
+    int runPenalty(const int* run, int group, bool sameCell) const {
+        if (sameCell) {
+            return batchCells[run[0]] == batchCells[run[group - 1]] ? 0 : CandidateIndex::INCOMPATIBLE;
+        }
+        int largest = 0;
+        for (int a = 0; a < group; a++) {
+            for (int b = a + 1; b < group; b++) {
+                int fixed = cellPenalty(batchCells[run[a]], batchCells[run[b]]);
+                if (fixed == CandidateIndex::INCOMPATIBLE) return fixed;
+                if (fixed > largest) largest = fixed;
+            }
+        }
+        return largest;
+    }
+
+    /**
+     * Team games: form NvN matches from the snapshot's solo players
+     *
+     * Two passes: runs inside one candidate cell (players sorted by cell,
+     * then ELO), then runs of the players left over sorted by ELO alone,
+     * as long as every two members are compatible. A run is taken when
+     * its ELO spread plus its largest cell penalty fits inside the
+     * acceptance window of every member; otherwise the window slides by
+     * one. Players taken are marked TEAMED in batchPartners.
+     *
+     * Time Complexity: O(n log n) sorts + O(n * N^2) scan + one split per
+     * match
+     *
+     * @return Number of matches created
+     */
+    int formTeamMatches(int count, int size) {
+        int solo = 0;
+        for (int i = 0; i < count; i++) {
+            if (batchEntries[i].partySize == 1) teamOrder[solo++] = i;
+        }
+        mergeSort(teamOrder, teamSortScratch, static_cast<size_t>(solo), ByBatchCellElo(batchCells, batchElos));
+        int formed = formTeamRuns(solo, size, true);
+
+        int left = 0;
+        for (int k = 0; k < solo; k++) {
+            if (batchPartners[teamOrder[k]] != TEAMED) teamOrder[left++] = teamOrder[k];
+        }
+        mergeSort(teamOrder, teamSortScratch, static_cast<size_t>(left), ByBatchElo(batchElos));
+        return formed + formTeamRuns(left, size, false);
+    }
+
+    // One pass of formTeamMatches() over the first solo entries of teamOrder
+    int formTeamRuns(int solo, int size, bool sameCell) {
+        int group = 2 * size;
+        int elos[2 * Match::MAX_TEAM_SIZE];
+        int side[2 * Match::MAX_TEAM_SIZE];
+        int teams[2][Match::MAX_TEAM_SIZE];
+        int formed = 0;
+        int first = 0;
+        while (first + group <= solo) {
+            const int* run = teamOrder + first;
+            long long spread = batchElos[run[group - 1]] - batchElos[run[0]];
+            long long narrowest = batchSkipCosts[run[0]];
+            for (int k = 1; k < group; k++) {
+                if (batchSkipCosts[run[k]] < narrowest) narrowest = batchSkipCosts[run[k]];
+            }
+            int fixed = spread <= narrowest ? runPenalty(run, group, sameCell) : CandidateIndex::INCOMPATIBLE;
+            if (fixed == CandidateIndex::INCOMPATIBLE || spread + fixed > narrowest) {
+                first++;
+                continue;
+            }
+
+            for (int k = 0; k < group; k++) {
+                elos[k] = batchElos[run[k]];
+            }
+            TeamBalancer::split(elos, size, side);
+            int filled[2] = {0, 0};
+            for (int k = 0; k < group; k++) {
+                teams[side[k]][filled[side[k]]++] = batchEntries[run[k]].playerId;
+                batchPartners[run[k]] = TEAMED;
+            }
+            startTeamMatch(teams[0], teams[1], size);
+            formed++;
+            first += group;
+        }
+        return formed;
+    }
+
+    // Copy class members' partners back to snapshot indexes
+    void mapClassPartners(const int* members, int count) {
+        for (int m = 0; m < count; m++) {
+            int partner = classPartners[m];
+            batchPartners[members[m]] =
+                partner == BatchMatcher::NO_PARTNER ? BatchMatcher::NO_PARTNER : members[partner];
+        }
+    }
+
+    /**
+     * Pair the snapshot's solo players: each candidate cell on its own
+     * (exact BatchMatcher pairing, no penalty), then the players left over
+     * across compatible cells at CandidateIndex's penalties
+     * (BatchMatcher::pairAcrossCells). Incompatible players are never
+     * paired.
+     *
+     * Time Complexity: O(n log n + n * CELL_COUNT)
+     */
+    void pairSolo(int count) {
+        // Counting sort of the solo entries by cell
+        int cellStart[CELL_COUNT + 1];
+        for (int c = 0; c <= CELL_COUNT; c++) cellStart[c] = 0;
+        for (int i = 0; i < count; i++) {
+            if (batchEntries[i].partySize == 1) cellStart[batchCells[i] + 1]++;
+        }
+        for (int c = 0; c < CELL_COUNT; c++) cellStart[c + 1] += cellStart[c];
+        int filled[CELL_COUNT];
+        for (int c = 0; c < CELL_COUNT; c++) filled[c] = cellStart[c];
+        for (int i = 0; i < count; i++) {
+            if (batchEntries[i].partySize == 1) classMembers[filled[batchCells[i]]++] = i;
+        }
+
+        for (int c = 0; c < CELL_COUNT; c++) {
+            int members = cellStart[c + 1] - cellStart[c];
+            if (members < 2) continue;
+            const int* cell = classMembers + cellStart[c];
+            for (int m = 0; m < members; m++) {
+                classElos[m] = batchElos[cell[m]];
+                classSkipCosts[m] = batchSkipCosts[cell[m]];
+            }
+            batchMatcher.pair(classElos, classSkipCosts, members, classPartners);
+            mapClassPartners(cell, members);
+        }
+
+        // Players still unpaired, across compatible cells
+        int members = 0;
+        for (int i = 0; i < count; i++) {
+            if (batchEntries[i].partySize != 1 || batchPartners[i] != BatchMatcher::NO_PARTNER) continue;
+            classMembers[members] = i;
+            classElos[members] = batchElos[i];
+            classSkipCosts[members] = batchSkipCosts[i];
+            classCells[members] = batchCells[i];
+            members++;
+        }
+        batchMatcher.pairAcrossCells(classElos, classSkipCosts, classCells, CELL_COUNT, members,
+                                     classPartners, &MatchmakingShard::cellPenalty);
+        mapClassPartners(classMembers, members);
+    }
+
+    /**
+     * Pair the snapshot within each party-size class
+     *
+     * Solo players only meet solo players (pairSolo) and a party of k only
+     * meets a party of k. Team games leave the solo class unpaired for
+     * formTeamMatches().
+     */
+    void pairBySize(int count, int largestParty, bool withSolo) {
+        for (int i = 0; i < count; i++) {
+            batchPartners[i] = BatchMatcher::NO_PARTNER;
+        }
+        if (withSolo) pairSolo(count);
+        for (int size = 2; size <= largestParty; size++) {
+            int members = 0;
+            for (int i = 0; i < count; i++) {
+                if (batchEntries[i].partySize != size) continue;
+                classMembers[members] = i;
+                classElos[members] = batchElos[i];
+                classSkipCosts[members] = batchSkipCosts[i];
+                members++;
+            }
+            batchMatcher.pair(classElos, classSkipCosts, members, classPartners);
+            mapClassPartners(classMembers, members);
+        }
+    }
+
+    // Keep a bot's pool entry in step with its match state (no-op for humans)
+    void updateBotAvailability(int index, bool available) {
+        if (!players->isBot(index)) return;
+        bots.setAvailable(index, available);
+        if (available) bots.updateElo(index, eloOf(index));
+    }
+
+    // A queue entry is live while the player is still queued for this game
+    // with the same handle it was enqueued with
+    bool isLiveEntry(const QueueEntry& entry) const {
+        int index = players->indexOf(entry.playerId);
+        if (index == PlayerStore::NO_PLAYER) return false;
+        PlayerState::Word state = players->getState(index);
+        return PlayerState::status(state) == PlayerState::QUEUED &&
+               PlayerState::gameId(state) == gameId &&
+               PlayerState::handle(state) == entry.handle;
+    }
+
+    // Drop stale entries from the front of the queue - O(stale entries)
+    void purgeStaleFront() {
+        QueueEntry* front = queue.front();
+        while (front && !isLiveEntry(*front)) {
+            QueueEntry dropped;
+            queue.dequeue(dropped);
+            front = queue.front();
+        }
+    }
+
+    // Dequeue the first live entry, discarding stale ones
+    bool dequeueLive(QueueEntry& outEntry) {
+        purgeStaleFront();
+        return queue.dequeue(outEntry);
+    }
+
+    // A player this shard may put in a match: idle, or queued here
+    bool isClaimable(int index) const {
+        PlayerState::Word state = players->getState(index);
+        PlayerState::Status status = PlayerState::status(state);
+        return status == PlayerState::IDLE ||
+               (status == PlayerState::QUEUED && PlayerState::gameId(state) == gameId);
+    }
+
+    /**
+     * Move a player into a match, releasing their queue slot if they held one
+     *
+     * @return How long the player was queued (ns), or -1 if they were not
+     */
+    long long enterMatch(int index, int matchId) {
+        PlayerState::Word state = players->getState(index);
+        while (!players->compareAndSetState(index, state, PlayerState::inMatch(state, gameId, matchId))) {
+            // state reloaded by the failed CAS
+        }
+        if (PlayerState::status(state) != PlayerState::QUEUED) return -1;
+
+        liveCount--;
+        candidates.remove(players->getId(index), eloOf(index), players->getAttributes(index));
+        return getCurrentTime() - players->getQueuedAt(index);
+    }
+
+    // Release a queued party: every member back to idle - O(party size)
+    void releaseParty(int leaderId) {
+        Party* party = queuedParties.get(leaderId);
+        if (!party) return;
+        for (int i = 0; i < party->size; i++) {
+            int memberId = party->memberIds[i];
+            int index = players->indexOf(memberId);
+            PlayerState::Word state = players->getState(index);
+            if (PlayerState::status(state) == PlayerState::QUEUED && PlayerState::gameId(state) == gameId &&
+                players->compareAndSetState(index, state, PlayerState::idle(state))) {
+                liveCount--;
+                rankingService->removeRanking(index, gameId);
+            }
+        }
+        forgetParty(leaderId);
+    }
+
+    // Drop a party from the party table, member map and index
+    void forgetParty(int leaderId) {
+        Party* party = queuedParties.get(leaderId);
+        if (!party) return;
+        partyIndex[party->size].remove(PlayerELO(party->matchElo(), leaderId));
+        for (int i = 0; i < party->size; i++) {
+            partyOf.remove(party->memberIds[i]);
+        }
+        queuedParties.remove(leaderId);
+    }
+
+    // Move a player out of the given match back to idle
+    void leaveMatch(int index, int matchId) {
+        PlayerState::Word state = players->getState(index);
+        while (PlayerState::status(state) == PlayerState::IN_MATCH &&
+               PlayerState::matchId(state) == matchId &&
+               !players->compareAndSetState(index, state, PlayerState::idle(state))) {
+            // state reloaded by the failed CAS
+        }
+    }
+
+    /**
+     * Next free match ID: the sequence wraps to 1 after MAX_MATCH_SEQUENCE
+     * and steps over IDs still tracked - O(1) unless the wrapped sequence
+     * runs into matches that are still tracked
+     */
+    int allocateMatchId() {
+        while (true) {
+            if (nextMatchSequence < 1 || nextMatchSequence > MAX_MATCH_SEQUENCE) nextMatchSequence = 1;
+            int matchId = (nextMatchSequence++ << MATCH_SHARD_BITS) | gameId;
+            if (!activeMatches.get(matchId)) return matchId;
+        }
+    }
+
+    // Get current monotonic time in nanoseconds (for queue wait times)
+    long long getCurrentTime() {
+        return timeSource->monotonicNanos();
+    }
+
+    // Acceptance window for a player who has waited waitedNanos - O(1)
+    static long long acceptanceWindow(long long waitedNanos) {
+        if (waitedNanos < 0) waitedNanos = 0;
+        long long window = INITIAL_WINDOW_ELO + waitedNanos * WINDOW_GROWTH_ELO_PER_SECOND / Clock::NANOS_PER_SECOND;
+        return window < MAX_WINDOW_ELO ? window : MAX_WINDOW_ELO;
+    }
+
+public:
+    MatchmakingShard()
+        : gameId(GameRegistry::NO_GAME), games(nullptr), players(nullptr), rankingService(nullptr),
+          historyService(nullptr), liveCount(0), nextMatchSequence(1),
+          batchEntries(nullptr), batchElos(nullptr), batchSkipCosts(nullptr), batchCells(nullptr),
+          batchPartners(nullptr), classMembers(nullptr), classElos(nullptr),
+          classSkipCosts(nullptr), classCells(nullptr), classPartners(nullptr), teamOrder(nullptr),
+          teamSortScratch(nullptr), batchCapacity(0), logging(true),
+          timeSource(&SystemTime::instance()), matchListener(nullptr), matchListenerContext(nullptr),
+          stateLog(nullptr) {}
+
+    ~MatchmakingShard() {
+        releaseBatch();
+    }
+
+    MatchmakingShard(const MatchmakingShard&) = delete;
+    MatchmakingShard& operator=(const MatchmakingShard&) = delete;
+
+    // Bind the shard to its game and the shared services
+    void attach(int game, const GameRegistry* registry, PlayerStore* store,
+                RankingService* ranking, HistoryService* history) {
+        gameId = game;
+        games = registry;
+        players = store;
+        rankingService = ranking;
+        historyService = history;
+    }
+
+    // Game ID encoded in a match ID
+    static int shardOfMatch(int matchId) {
+        return matchId & MATCH_SHARD_MASK;
+    }
+
+    // Held around every call into the shard
+    std::mutex& mutex() {
+        return lock;
+    }
+
+    void setLogging(bool enabled) {
+        logging = enabled;
+    }
+
+    void setMatchListener(MatchListener listener, void* context) {
+        matchListener = listener;
+        matchListenerContext = context;
+    }
+
+    void setCompletedMatchGrace(long long nanos) {
+        activeMatches.setGraceNanos(nanos);
+    }
+
+    // Log every queue, match and result change here (nullptr = off)
+    void setStateLog(StateLog* log) {
+        stateLog = log;
+    }
+
+    // Clock for wait times, windows, bot fallback and match timestamps
+    void setTimeSource(const TimeSource* source) {
+        timeSource = source ? source : &SystemTime::instance();
+    }
+
+    /**
+     * Re-key a player whose ELO in this game a closed rating period changed
+     *
+     * Called with the shard lock held (Matchmaker::closeRatingPeriod).
+     * Fixes the candidate index and bot pool; the ranking tree is moved by
+     * RankingService itself.
+     */
+    void ratingChanged(int index, int oldElo) {
+        if (players->isBot(index)) {
+            bots.updateElo(index, eloOf(index));
+            return;
+        }
+        int playerId = players->getId(index);
+        MatchAttributes attributes = players->getAttributes(index);
+        if (candidates.remove(playerId, oldElo, attributes)) {
+            candidates.insert(playerId, eloOf(index), attributes);
+        }
+    }
+
+    /**
+     * Re-key every ELO-keyed index after a season reset rewrote this
+     * game's ratings (called with the shard lock held)
+     *
+     * Bots are re-keyed in one pass; queued solo humans and parties are
+     * re-inserted at their new ratings by one walk over the queue, which
+     * keeps its order (stale entries are dropped on the way).
+     *
+     * Time Complexity: O(q log q + b) for q queue entries and b bots
+     */
+    void ratingsReset() {
+        bots.rekeyAll([this](int index) { return eloOf(index); });
+        candidates.clear();
+        for (int size = 0; size <= Party::MAX_SIZE; size++) partyIndex[size].clear();
+
+        size_t entries = queue.size();
+        QueueEntry entry;
+        for (size_t i = 0; i < entries && queue.dequeue(entry); i++) {
+            if (!isLiveEntry(entry)) continue;
+            queue.enqueue(entry);
+            if (entry.partySize > 1) {
+                Party* party = queuedParties.get(entry.playerId);
+                if (!party) continue;
+                long long total = 0;
+                for (int m = 0; m < party->size; m++) {
+                    int elo = eloOf(players->indexOf(party->memberIds[m]));
+                    total += elo;
+                    if (m == 0 || elo > party->maxElo) party->maxElo = elo;
+                }
+                party->averageElo = static_cast<int>(total / party->size);
+                partyIndex[party->size].insert(PlayerELO(party->matchElo(), party->leaderId));
+            } else {
+                int index = players->indexOf(entry.playerId);
+                if (!players->isBot(index)) {
+                    candidates.insert(entry.playerId, eloOf(index), players->getAttributes(index));
+                }
+            }
+        }
+    }
+
+    // Add a bot to this game's pool
+    void registerBot(int botId) {
+        int botIndex = players->indexOf(botId);
+        if (botIndex == PlayerStore::NO_PLAYER) return;
+        bots.add(botIndex, eloOf(botIndex));
+    }
+
+    /**
+     * Add many bots (by player index) to this game's pool at once - the
+     * pool is sized and sorted once (BotPool::addAll)
+     */
+    void registerBots(const int* botIndexes, int count) {
+        int* elos = new int[count > 0 ? count : 1];
+        for (int i = 0; i < count; i++) elos[i] = eloOf(botIndexes[i]);
+        bots.addAll(botIndexes, elos, count);
+        delete[] elos;
+    }
+
+    int getBotCount() const {
+        return bots.size();
+    }
+
+    /**
+     * Claim the player for this game and enqueue them
+     *
+     * @return true if queued; false if unknown or not idle
+     */
+    bool joinQueue(int playerId) {
+        return joinQueue(playerId, nullptr);
+    }
+
+    /**
+     * Add a player to the queue with their latency bucket and input device
+     * (nullptr keeps the attributes they last queued with)
+     */
+    bool joinQueue(int playerId, const MatchAttributes* attributes) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return false;
+
+        // Claim the queue slot - fails if already in a queue or match
+        PlayerState::Word state = players->getState(index);
+        if (PlayerState::status(state) != PlayerState::IDLE) return false;
+        PlayerState::Word queued = PlayerState::queued(state, gameId);
+        if (!players->compareAndSetState(index, state, queued)) return false;
+
+        if (attributes) players->setAttributes(index, *attributes);
+        players->setQueuedAt(index, getCurrentTime());
+        if (!players->isBot(index)) {
+            candidates.insert(playerId, eloOf(index), players->getAttributes(index));
+        }
+
+        purgeStaleFront();
+        QueueEntry entry(playerId, getCurrentTime(), PlayerState::handle(queued));
+        queue.enqueue(entry);
+        liveCount++;
+
+        players->getProfile(index).setPreferredGame(gameId);
+        rankingService->insertRanking(index, gameId);
+        if (stateLog) stateLog->queued(playerId, gameId, players->getAttributes(index).pack());
+        return true;
+    }
+
+    /**
+     * Claim every member for this game and enqueue them as one party entry
+     *
+     * All or nothing: if any member is unknown, a bot, listed twice or not
+     * idle, members already claimed are released and nothing is queued.
+     *
+     * @param memberIds Members, leader first (exactly teamSize(), at most
+     *        Party::MAX_SIZE)
+     * @return true if the party was queued
+     */
+    bool joinParty(const int* memberIds, int count) {
+        if (count < 2 || count > Party::MAX_SIZE || count != teamSize()) return false;
+
+        Party party;
+        party.leaderId = memberIds[0];
+        party.size = count;
+        int indexes[Party::MAX_SIZE];
+        PlayerState::Word claimed[Party::MAX_SIZE];
+        long long total = 0;
+        int claimedCount = 0;
+        bool ok = true;
+
+        for (int i = 0; i < count && ok; i++) {
+            int index = players->indexOf(memberIds[i]);
+            ok = index != PlayerStore::NO_PLAYER && !players->isBot(index) && !party.contains(memberIds[i]);
+            if (!ok) break;
+
+            PlayerState::Word state = players->getState(index);
+            PlayerState::Word queued = PlayerState::queued(state, gameId);
+            ok = PlayerState::status(state) == PlayerState::IDLE &&
+                 players->compareAndSetState(index, state, queued);
+            if (!ok) break;
+
+            indexes[i] = index;
+            claimed[i] = queued;
+            claimedCount++;
+            party.memberIds[i] = memberIds[i];
+
+            int elo = eloOf(index);
+            total += elo;
+            if (i == 0 || elo > party.maxElo) party.maxElo = elo;
+        }
+
+        if (!ok) {
+            // Roll back the claims made so far
+            for (int i = 0; i < claimedCount; i++) {
+                PlayerState::Word state = claimed[i];
+                players->compareAndSetState(indexes[i], state, PlayerState::idle(state));
+            }
+            return false;
+        }
+        party.averageElo = static_cast<int>(total / count);
+
+        purgeStaleFront();
+        queuedParties.insert(party.leaderId, party);
+        for (int i = 0; i < count; i++) {
+            partyOf.insert(party.memberIds[i], party.leaderId);
+            players->setQueuedAt(indexes[i], getCurrentTime());
+            players->getProfile(indexes[i]).setPreferredGame(gameId);
+            rankingService->insertRanking(indexes[i], gameId);
+        }
+        partyIndex[count].insert(PlayerELO(party.matchElo(), party.leaderId));
+        queue.enqueue(QueueEntry(party.leaderId, getCurrentTime(), PlayerState::handle(claimed[0]), count));
+        liveCount += count;
+        if (stateLog) stateLog->partyQueued(party.memberIds, count, gameId);
+        return true;
+    }
+
+    /**
+     * Release the player's queue slot - O(1); the queue entry goes stale
+     *
+     * A party member leaving releases the whole party - O(party size).
+     *
+     * @return true if the player was queued for this game
+     */
+    bool leaveQueue(int playerId) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return false;
+
+        PlayerState::Word state = players->getState(index);
+        if (PlayerState::status(state) != PlayerState::QUEUED || PlayerState::gameId(state) != gameId) {
+            return false;
+        }
+        const int* leaderId = partyOf.get(playerId);
+        if (leaderId) {
+            releaseParty(*leaderId);
+            if (stateLog) stateLog->left(playerId, gameId);
+            return true;
+        }
+        if (!players->compareAndSetState(index, state, PlayerState::idle(state))) return false;
+        liveCount--;
+        candidates.remove(playerId, eloOf(index), players->getAttributes(index));
+
+        rankingService->removeRanking(index, gameId);
+        if (stateLog) stateLog->left(playerId, gameId);
+        return true;
+    }
+
+    /**
+     * Try to create a single match - GREEDY PATH
+     *
+     * Dequeues the front player and pairs them with the closest queued
+     * human inside their acceptance window (AVL range query).
+     * processMatchmaking() pairs the whole queue instead.
+     *
+     * WAIT FOR HUMAN FIRST:
+     * - Wait for a human opponent for BOT_FALLBACK_WAIT_NANOS
+     * - Only fall back to bot if no human joins in time
+     *
+     * @return Match ID if match created, -1 otherwise
+     */
+    int tryCreateMatch() {
+        if (liveCount == 0) return -1;
+        if (teamSize() > 1) return -1;  // Team games are formed by the batch tick
+
+        // WAIT FOR HUMAN: If only 1 player, check if they've waited long enough
+        if (liveCount == 1) {
+            purgeStaleFront();
+            QueueEntry* frontEntry = queue.front();
+            if (frontEntry) {
+                long long waitTime = getCurrentTime() - frontEntry->joinTime;
+                // Wait 5 seconds for a human opponent before matching with bot
+                if (waitTime < BOT_FALLBACK_WAIT_NANOS) {
+                    return -1;  // Keep waiting for human opponent
+                }
+            }
+            // Waited long enough, match with bot
+            return matchHumanWithBot();
+        }
+
+        // CASE B: Queue size >= 2 -> Try Human vs Human first
+        QueueEntry entry1;
+        if (!dequeueLive(entry1)) return -1;
+
+        if (entry1.partySize > 1) return tryMatchParty(entry1);
+
+        int player1Index = players->indexOf(entry1.playerId);
+        if (player1Index == PlayerStore::NO_PLAYER) return -1;
+        int player1Elo = eloOf(player1Index);
+
+        // Check if player1 is a bot - if so, skip and try to find humans
+        if (players->isBot(player1Index)) {
+            // Re-queue the bot and try again
+            queue.enqueue(entry1);
+            return -1;
+        }
+
+        // CRITICAL: Temporarily remove player1 from AVL tree to avoid self-matching
+        rankingService->removeRanking(player1Index, gameId);
+
+        // Find closest HUMAN opponent inside player1's window
+        long long waited = getCurrentTime() - entry1.joinTime;
+        int window = static_cast<int>(acceptanceWindow(waited));
+        int opponentId = findClosestHumanOpponent(entry1.playerId, window);
+
+        if (opponentId == -1) {
+            // Keep waiting while the window can still widen
+            if (waited < BOT_FALLBACK_WAIT_NANOS) {
+                rankingService->insertRanking(player1Index, gameId);
+                queue.enqueue(entry1);
+                return -1;
+            }
+
+            // No human opponent found in time - match with bot instead
+            int botOpponentId = findClosestBotOpponent(entry1.playerId, player1Elo);
+            if (botOpponentId == -1) {
+                // No bot available - re-queue player
+                rankingService->insertRanking(player1Index, gameId);
+                queue.enqueue(entry1);
+                return -1;
+            }
+
+            // player1 stays out of the tree while playing, as in matchHumanWithBot()
+            return createMatchBetween(entry1.playerId, botOpponentId);
+        }
+
+        // Get human opponent
+        int player2Index = players->indexOf(opponentId);
+        if (player2Index == PlayerStore::NO_PLAYER) {
+            rankingService->insertRanking(player1Index, gameId);
+            queue.enqueue(entry1);
+            return -1;
+        }
+
+        // Remove opponent from tree (their queue entry goes stale once matched)
+        rankingService->removeRanking(player2Index, gameId);
+
+        return createMatchBetween(entry1.playerId, opponentId);
+    }
+
+    /**
+     * Greedy path for a party at the front: closest same-size party whose
+     * key lies inside the front party's window, else re-queue
+     */
+    int tryMatchParty(const QueueEntry& entry) {
+        long long waited = getCurrentTime() - entry.joinTime;
+        int opponentLeader = findClosestParty(entry.playerId, static_cast<int>(acceptanceWindow(waited)));
+        if (opponentLeader == -1) {
+            queue.enqueue(entry);
+            return -1;
+        }
+        return createPartyMatch(entry.playerId, opponentLeader);
+    }
+
+    /**
+     * Find the closest same-size queued party within an ELO window
+     *
+     * Range query on the party index for that size - O(log p + k).
+     *
+     * @return Leader ID of the other party, or -1
+     */
+    int findClosestParty(int leaderId, int window) {
+        const Party* party = queuedParties.get(leaderId);
+        if (!party) return -1;
+        AVLTree<PlayerELO>& index = partyIndex[party->size];
+        if (index.size() < 2) return -1;
+
+        int elo = party->matchElo();
+        int bestId = -1;
+        int bestDiff = window + 1;
+        index.rangeTraversal(PlayerELO(elo - window, INT_MIN), PlayerELO(elo + window, INT_MAX),
+                             [&](const PlayerELO& key) {
+            int diff = key.elo > elo ? key.elo - elo : elo - key.elo;
+            if (key.elo > elo && diff >= bestDiff) return false;  // Only farther from here on
+            if (key.playerId != leaderId && diff < bestDiff) {
+                bestDiff = diff;
+                bestId = key.playerId;
+            }
+            return true;
+        });
+        return bestId;
+    }
+
+    /**
+     * Match the front human with the closest-ELO bot (DEMO MODE)
+     */
+    int matchHumanWithBot() {
+        if (liveCount == 0) return -1;
+
+        QueueEntry entry;
+        if (!dequeueLive(entry)) return -1;
+        if (entry.partySize > 1 || teamSize() > 1) {
+            queue.enqueue(entry);  // Parties and team games never get bots
+            return -1;
+        }
+
+        int humanIndex = players->indexOf(entry.playerId);
+        if (humanIndex == PlayerStore::NO_PLAYER) return -1;
+        int humanElo = eloOf(humanIndex);
+
+        // Bots should never be in queue, but check just in case
+        if (players->isBot(humanIndex)) {
+            queue.enqueue(entry);
+            return -1;
+        }
+
+        // Remove human from ranking tree temporarily
+        rankingService->removeRanking(humanIndex, gameId);
+
+        int botId = findClosestBotOpponent(entry.playerId, humanElo);
+        if (botId == -1) {
+            // No bot available - re-add human to queue
+            rankingService->insertRanking(humanIndex, gameId);
+            queue.enqueue(entry);
+            return -1;
+        }
+
+        return createMatchBetween(entry.playerId, botId);
+    }
+
+    /**
+     * Find the lowest-cost compatible human opponent within a window
+     *
+     * Cost is the ELO gap plus latency and cross-play penalties (see
+     * CandidateIndex) - O(C log n + k), no queue scan.
+     */
+    int findClosestHumanOpponent(int playerId, int window) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return -1;
+
+        PlayerStore* store = players;
+        int game = gameId;
+        return candidates.findNearest(playerId, eloOf(index), players->getAttributes(index), window,
+                                      [store, game](int candidateId) {
+            // Only solo humans are indexed; they must still be queued here
+            PlayerState::Word state = store->getState(store->indexOf(candidateId));
+            return PlayerState::status(state) == PlayerState::QUEUED &&
+                   PlayerState::gameId(state) == game;
+        });
+    }
+
+    /**
+     * Find the closest ELO free bot, skipping the human's recent opponents
+     *
+     * Selection criteria (in order):
+     * 1. Bot must not be in a match
+     * 2. Bot must not be in player's recent opponent list
+     * 3. Among eligible bots, select the closest ELO
+     * 4. If all bots are recent, fallback to absolute closest (deadlock prevention)
+     *
+     * Time Complexity: O(log b) binary search + bitset scan for b bots
+     */
+    int findClosestBotOpponent(int humanPlayerId, int targetElo) {
+        if (bots.size() == 0) return -1;
+
+        int humanIndex = players->indexOf(humanPlayerId);
+        if (humanIndex == PlayerStore::NO_PLAYER) return -1;
+        const Player& human = players->getProfile(humanIndex);
+        PlayerStore* store = players;
+
+        // Walk outward from targetElo over free bots, stepping over recent opponents
+        bool usedFallback = false;
+        int botIndex = bots.findClosest(targetElo, [&human, store](int candidate) {
+            return human.wasRecentOpponent(store->getId(candidate));
+        }, usedFallback);
+        if (botIndex == BotPool::NO_BOT) return -1;
+
+        if (usedFallback && logging) {
+            printf("[Matchmaker] All bots recently matched with player %d - using fallback\n", humanPlayerId);
+        }
+        return players->getId(botIndex);
+    }
+
+    /**
+     * Create a match between two players (human or bot)
+     *
+     * Both players must be idle or queued for this game; a player owned by
+     * another shard is refused.
+     *
+     * @return Match ID, or -1
+     */
+    int createMatchBetween(int player1Id, int player2Id) {
+        int player1Index = players->indexOf(player1Id);
+        int player2Index = players->indexOf(player2Id);
+
+        if (player1Index == PlayerStore::NO_PLAYER || player2Index == PlayerStore::NO_PLAYER) return -1;
+        if (player1Index == player2Index || !isClaimable(player1Index) || !isClaimable(player2Index)) return -1;
+
+        // Record recent opponents for matchmaking rotation
+        // Only track for human players (bots don't need rotation tracking)
+        if (!players->isBot(player1Index)) {
+            int elo1 = eloOf(player1Index);
+            int elo2 = eloOf(player2Index);
+            players->getProfile(player1Index).addRecentOpponent(player2Id);
+            if (logging) printf("[Matchmaker] Player %s matched with %s (ELO diff: %d)\n",
+                   players->getName(player1Index), players->getName(player2Index),
+                   elo1 > elo2 ? elo1 - elo2 : elo2 - elo1);
+        }
+        if (!players->isBot(player2Index)) {
+            players->getProfile(player2Index).addRecentOpponent(player1Id);
+        }
+
+        int matchId = allocateMatchId();
+        Match match(matchId, player1Id, player2Id, gameId, timeSource->wallMillis());
+        activeMatches.add(match);
+
+        // Update player states (releases their queue slots)
+        long long wait1 = enterMatch(player1Index, matchId);
+        long long wait2 = enterMatch(player2Index, matchId);
+        updateBotAvailability(player1Index, false);
+        updateBotAvailability(player2Index, false);
+
+        MatchTelemetry::Pairing pairing = players->isBot(player1Index) || players->isBot(player2Index)
+            ? MatchTelemetry::HUMAN_VS_BOT : MatchTelemetry::HUMAN_VS_HUMAN;
+        if (wait1 >= 0) telemetry.recordWait(pairing, wait1);
+        if (wait2 >= 0) telemetry.recordWait(pairing, wait2);
+        telemetry.recordMatch(pairing, eloOf(player1Index) - eloOf(player2Index));
+
+        if (stateLog) stateLog->matchCreated(match);
+        if (matchListener) matchListener(match, matchListenerContext);
+
+        return matchId;
+    }
+
+    /**
+     * Create a team match between two queued parties of the same size
+     *
+     * Both parties leave the party table; their members play as the two
+     * teams.
+     *
+     * @return Match ID, or -1
+     */
+    int createPartyMatch(int leaderA, int leaderB) {
+        const Party* a = queuedParties.get(leaderA);
+        const Party* b = queuedParties.get(leaderB);
+        if (!a || !b || leaderA == leaderB || a->size != b->size) return -1;
+
+        if (logging) printf("[Matchmaker] Party of %d led by %d matched with party led by %d\n",
+                            a->size, leaderA, leaderB);
+        int matchId = startTeamMatch(a->memberIds, b->memberIds, a->size);
+        forgetParty(leaderA);
+        forgetParty(leaderB);
+        return matchId;
+    }
+
+    /**
+     * Create a team match between two teams of queued players
+     *
+     * @return Match ID
+     */
+    int startTeamMatch(const int* team1, const int* team2, int size) {
+        int matchId = allocateMatchId();
+        Match match(matchId, team1[0], team2[0], gameId, timeSource->wallMillis());
+        match.setTeams(team1, team2, size);
+        activeMatches.add(match);
+
+        // Members leave the ranking tree while playing, like solo players;
+        // the team result re-inserts them at their new ratings
+        long long total1 = 0;
+        long long total2 = 0;
+        for (int i = 0; i < match.teamSize; i++) {
+            int index1 = players->indexOf(match.team1[i]);
+            int index2 = players->indexOf(match.team2[i]);
+            total1 += eloOf(index1);
+            total2 += eloOf(index2);
+            rankingService->removeRanking(index1, gameId);
+            rankingService->removeRanking(index2, gameId);
+            long long wait1 = enterMatch(index1, matchId);
+            long long wait2 = enterMatch(index2, matchId);
+            if (wait1 >= 0) telemetry.recordWait(MatchTelemetry::HUMAN_VS_HUMAN, wait1);
+            if (wait2 >= 0) telemetry.recordWait(MatchTelemetry::HUMAN_VS_HUMAN, wait2);
+        }
+        telemetry.recordMatch(MatchTelemetry::HUMAN_VS_HUMAN, static_cast<int>((total1 - total2) / size));
+
+        if (stateLog) stateLog->matchCreated(match);
+        if (matchListener) matchListener(match, matchListenerContext);
+
+        return matchId;
+    }
+
+    /**
+     * Process matchmaking for this game - BATCH PATH, once per tick
+     *
+     * 1. Snapshot: drain the queue, keeping live entries in FIFO order
+     * 2. Pair: BatchMatcher computes the minimum-cost pairing within each
+     *    party-size class (ELO gap + acceptance window of each entry left
+     *    unmatched), which only pairs entries whose windows overlap; solo
+     *    players are paired by candidate cell and never with an
+     *    incompatible player (pairSolo). Team games instead form NvN
+     *    matches from the solo players (formTeamMatches)
+     * 3. Commit: create every match in one pass; solo players still
+     *    unmatched after BOT_FALLBACK_WAIT_NANOS get a bot, the rest are
+     *    re-queued in their original order
+     *
+     * Time Complexity: O(n log n + n * CELL_COUNT) for n queued players
+     *
+     * @return Number of matches created
+     */
+    int processMatchmaking() {
+        activeMatches.evictExpired(getCurrentTime());
+        if (liveCount == 0) return 0;
+
+        // 1. Snapshot
+        long long now = getCurrentTime();
+        reserveBatch(liveCount);
+        int count = 0;
+        int largestParty = 1;
+        QueueEntry entry;
+        while (queue.dequeue(entry)) {
+            if (!isLiveEntry(entry)) continue;
+            reserveBatch(count + 1);
+
+            long long waited = now - entry.joinTime;
+            batchEntries[count] = entry;
+            batchCells[count] = 0;
+            if (entry.partySize > 1) {
+                batchElos[count] = queuedParties.get(entry.playerId)->matchElo();
+                if (entry.partySize > largestParty) largestParty = entry.partySize;
+            } else {
+                int index = players->indexOf(entry.playerId);
+                batchElos[count] = eloOf(index);
+                batchCells[count] = cellOf(players->getAttributes(index));
+            }
+            batchSkipCosts[count] = acceptanceWindow(waited);
+            count++;
+        }
+
+        // 2. Pair (team games: solo players are formed into teams)
+        int size = teamSize();
+        pairBySize(count, largestParty, size == 1);
+        int matchesCreated = size > 1 ? formTeamMatches(count, size) : 0;
+
+        // 3. Commit
+        for (int i = 0; i < count; i++) {
+            const QueueEntry& current = batchEntries[i];
+            int partner = batchPartners[i];
+            if (partner == TEAMED) continue;
+
+            if (partner != BatchMatcher::NO_PARTNER) {
+                if (partner < i) continue;  // Created with its partner
+                const QueueEntry& other = batchEntries[partner];
+                if (current.partySize > 1) {
+                    createPartyMatch(current.playerId, other.playerId);
+                    matchesCreated++;
+                    continue;
+                }
+                rankingService->removeRanking(players->indexOf(current.playerId), gameId);
+                rankingService->removeRanking(players->indexOf(other.playerId), gameId);
+                createMatchBetween(current.playerId, other.playerId);
+                matchesCreated++;
+                continue;
+            }
+
+            // Unmatched solo player - fall back to a bot once they have waited long enough
+            if (current.partySize == 1 && size == 1 && now - current.joinTime >= BOT_FALLBACK_WAIT_NANOS) {
+                int botId = findClosestBotOpponent(current.playerId, batchElos[i]);
+                if (botId != -1) {
+                    rankingService->removeRanking(players->indexOf(current.playerId), gameId);
+                    createMatchBetween(current.playerId, botId);
+                    matchesCreated++;
+                    continue;
+                }
+            }
+            queue.enqueue(current);
+        }
+
+        return matchesCreated;
+    }
+
+    /**
+     * Submit a match result: ratings, history, then hand both players back
+     *
+     * @return true if result recorded successfully
+     */
+    bool submitMatchResult(int matchId, int winnerId) {
+        activeMatches.evictExpired(getCurrentTime());
+
+        Match* match = activeMatches.get(matchId);
+        if (!match || match->isCompleted) return false;
+
+        // Validate winner is part of the match
+        if (match->getTeam(winnerId) == 0) {
+            return false;
+        }
+        if (stateLog) stateLog->resultSubmitted(matchId, winnerId);
+
+        if (match->teamSize > 1) return submitTeamResult(match, winnerId);
+
+        int loserId = (winnerId == match->player1Id) ? match->player2Id : match->player1Id;
+        match->complete(winnerId);
+
+        // Update rankings (this handles ELO calculation)
+        rankingService->updateRankings(winnerId, loserId, gameId);
+
+        // Record to history; the active entry is evicted after the grace window
+        historyService->recordMatch(*match);
+        activeMatches.complete(matchId, getCurrentTime());
+
+        int winnerIndex = players->indexOf(winnerId);
+        int loserIndex = players->indexOf(loserId);
+
+        // Back to idle, and back in the ranking tree for future matchmaking
+        if (winnerIndex != PlayerStore::NO_PLAYER) {
+            leaveMatch(winnerIndex, matchId);
+            updateBotAvailability(winnerIndex, true);
+            rankingService->insertRanking(winnerIndex, gameId);
+        }
+
+        if (loserIndex != PlayerStore::NO_PLAYER) {
+            leaveMatch(loserIndex, matchId);
+            updateBotAvailability(loserIndex, true);
+            rankingService->insertRanking(loserIndex, gameId);
+        }
+
+        return true;
+    }
+
+    /**
+     * Team match result: ratings from team averages, history for every
+     * member, then every member back to idle and back in the ranking tree
+     * (the ELO system re-keys them itself; Glicko-2 only buffers the
+     * result, so they must be re-inserted here)
+     */
+    bool submitTeamResult(Match* match, int winnerId) {
+        match->complete(winnerId);
+        bool team1Won = match->getTeam(winnerId) == 1;
+        const int* winners = team1Won ? match->team1 : match->team2;
+        const int* losers = team1Won ? match->team2 : match->team1;
+
+        rankingService->updateTeamRankings(winners, losers, match->teamSize, gameId);
+        historyService->recordMatch(*match);
+        activeMatches.complete(match->matchId, getCurrentTime());
+
+        for (int t = 0; t < 2; t++) {
+            const int* team = t == 0 ? match->team1 : match->team2;
+            for (int i = 0; i < match->teamSize; i++) {
+                int index = players->indexOf(team[i]);
+                if (index == PlayerStore::NO_PLAYER) continue;
+                leaveMatch(index, match->matchId);
+                rankingService->insertRanking(index, gameId);
+            }
+        }
+        return true;
+    }
+
+    // ========== PERSISTENCE (shard lock held) ==========
+
+    /**
+     * Visit the live queue in FIFO order: visit(entry, party), party being
+     * nullptr for a solo player. One walk that keeps the queue's order;
+     * stale entries are dropped on the way.
+     */
+    template <typename Visit>
+    void forEachQueued(Visit visit) {
+        size_t entries = queue.size();
+        QueueEntry entry;
+        for (size_t i = 0; i < entries && queue.dequeue(entry); i++) {
+            if (!isLiveEntry(entry)) continue;
+            queue.enqueue(entry);
+            visit(entry, entry.partySize > 1 ? queuedParties.get(entry.playerId) : nullptr);
+        }
+    }
+
+    // Visit every match still in progress (completed ones are in history)
+    template <typename Visit>
+    void forEachActiveMatch(Visit visit) {
+        activeMatches.forEach([&visit](const Match& match) {
+            if (!match.isCompleted) visit(match);
+        });
+    }
+
+    int getNextMatchSequence() const {
+        return nextMatchSequence;
+    }
+
+    // Continue match IDs after those of a restored run (never moves back;
+    // allocateMatchId() wraps it)
+    void setNextMatchSequence(int sequence) {
+        if (sequence > nextMatchSequence) nextMatchSequence = sequence;
+    }
+
+    /**
+     * Re-create a logged match with its original pairing (replay)
+     *
+     * Same effects as creating it - humans leave the ranking tree, every
+     * member moves into the match (out of any queue), bots are marked busy
+     * - without telemetry, listeners or logging. A queued party with any
+     * member in the match is released as leaveQueue() releases it: members
+     * left out of the match go back to idle.
+     *
+     * @return false if the ID is taken or not this game's, or a member is
+     *         unknown or busy elsewhere
+     */
+    bool restoreMatch(const Match& match) {
+        if (shardOfMatch(match.matchId) != gameId || activeMatches.get(match.matchId)) return false;
+        int indexes[2 * Match::MAX_TEAM_SIZE];
+        int count = 0;
+        for (int t = 0; t < 2; t++) {
+            const int* team = t == 0 ? match.team1 : match.team2;
+            for (int i = 0; i < match.teamSize; i++) {
+                int index = players->indexOf(team[i]);
+                if (index == PlayerStore::NO_PLAYER || !isClaimable(index)) return false;
+                indexes[count++] = index;
+            }
+        }
+
+        activeMatches.add(match);
+        for (int i = 0; i < count; i++) {
+            int index = indexes[i];
+            const int* leaderId = partyOf.get(players->getId(index));
+            if (leaderId) releaseParty(*leaderId);
+            if (!players->isBot(index)) rankingService->removeRanking(index, gameId);
+            enterMatch(index, match.matchId);
+            updateBotAvailability(index, false);
+        }
+        setNextMatchSequence((match.matchId >> MATCH_SHARD_BITS) + 1);
+        return true;
+    }
+
+    // Match by ID (in progress, or completed within the grace window)
+    Match* getMatch(int matchId) {
+        return activeMatches.get(matchId);
+    }
+
+    size_t getActiveMatchCount() const {
+        return activeMatches.size();
+    }
+
+    size_t getRetiringMatchCount() const {
+        return activeMatches.retiringCount();
+    }
+
+    size_t getQueueSize() const {
+        return static_cast<size_t>(liveCount);
+    }
+
+    // Match-quality histograms - safe to read without the shard lock
+    const MatchTelemetry& getTelemetry() const {
+        return telemetry;
+    }
+};
+
+#endif // MATCHMAKING_SHARD_H
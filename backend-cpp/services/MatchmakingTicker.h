@@ -0,0 +1,156 @@
+#ifndef MATCHMAKING_TICKER_H
+#define MATCHMAKING_TICKER_H
+
+#include "Matchmaker.h"
+#include "GameRegistry.h"
+#include "Clock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * MatchmakingTicker - Background threads that run matchmaking on a fixed tick
+ *
+ * Matching no longer happens as a side effect of requests. Each registered
+ * game gets its own thread, which once per tick calls
+ * Matchmaker::processMatchmaking() for that game; the call holds only that
+ * game's shard lock, so games are matched in parallel and a busy game does
+ * not delay the others. The work per second depends on the tick rate and
+ * queue sizes, not on how often clients poll. Request handlers only
+ * join/leave queues and read state.
+ *
+ * New matches are published through the Matchmaker's match listener
+ * (called from inside the tick, with the shard lock held); HTTP clients
+ * see them on their next status poll.
+ *
+ * Ticks are scheduled on a fixed cadence; a tick that overruns the
+ * interval is followed immediately by the next one.
+ *
+ * Time Complexity:
+ *   - per tick: O(n log n) for the n players queued for that game
+ */
+class MatchmakingTicker {
+public:
+    static const long long DEFAULT_TICK_NANOS = 100 * Clock::NANOS_PER_MILLI;
+
+private:
+    Matchmaker* matchmaker;
+    const GameRegistry* games;
+    long long tickNanos;
+
+    std::thread workers[GameRegistry::MAX_GAMES];
+    int workerCount;
+    std::mutex wakeMutex;
+    std::condition_variable wakeup;
+    bool stopRequested;  // Guarded by wakeMutex
+
+    // Counters (read from any thread)
+    std::atomic<long long> ticks;
+    std::atomic<long long> matchesCreated;
+    std::atomic<long long> lastTickNanos;
+
+    void tick(int gameId) {
+        long long start = Clock::monotonicNanos();
+        int created = matchmaker->processMatchmaking(gameId);
+        ticks.fetch_add(1, std::memory_order_relaxed);
+        matchesCreated.fetch_add(created, std::memory_order_relaxed);
+        lastTickNanos.store(Clock::monotonicNanos() - start, std::memory_order_relaxed);
+
+        // Glicko-2 rating periods close from whichever tick thread sees them due
+        matchmaker->closeRatingPeriodIfDue();
+    }
+
+    void run(int gameId) {
+        long long nextTick = Clock::monotonicNanos();
+        std::unique_lock<std::mutex> wait(wakeMutex);
+        while (!stopRequested) {
+            wait.unlock();
+            tick(gameId);
+            wait.lock();
+
+            // Sleep until the next tick on a fixed cadence (stop wakes early)
+            nextTick += tickNanos;
+            long long now = Clock::monotonicNanos();
+            if (nextTick < now) nextTick = now;
+            wakeup.wait_for(wait, std::chrono::nanoseconds(nextTick - now),
+                            [this] { return stopRequested; });
+        }
+    }
+
+public:
+    MatchmakingTicker(Matchmaker* mm, const GameRegistry* registry)
+        : matchmaker(mm), games(registry), tickNanos(DEFAULT_TICK_NANOS),
+          workerCount(0), stopRequested(false),
+          ticks(0), matchesCreated(0), lastTickNanos(0) {}
+
+    ~MatchmakingTicker() {
+        stop();
+    }
+
+    MatchmakingTicker(const MatchmakingTicker&) = delete;
+    MatchmakingTicker& operator=(const MatchmakingTicker&) = delete;
+
+    /**
+     * Time between ticks (values below 1ms are raised to 1ms)
+     *
+     * Set before start().
+     */
+    void setTickNanos(long long nanos) {
+        tickNanos = nanos < Clock::NANOS_PER_MILLI ? Clock::NANOS_PER_MILLI : nanos;
+    }
+
+    long long getTickNanos() const {
+        return tickNanos;
+    }
+
+    // Start one tick thread per registered game (no-op if already running)
+    void start() {
+        if (workerCount > 0) return;
+        {
+            std::lock_guard<std::mutex> guard(wakeMutex);
+            stopRequested = false;
+        }
+        workerCount = games->size();
+        for (int game = 0; game < workerCount; game++) {
+            workers[game] = std::thread(&MatchmakingTicker::run, this, game);
+        }
+    }
+
+    // Stop the tick threads and wait for their current ticks to finish
+    void stop() {
+        if (workerCount == 0) return;
+        {
+            std::lock_guard<std::mutex> guard(wakeMutex);
+            stopRequested = true;
+        }
+        wakeup.notify_all();
+        for (int game = 0; game < workerCount; game++) {
+            workers[game].join();
+        }
+        workerCount = 0;
+    }
+
+    // Gauge: tick threads running (one per game)
+    int getThreadCount() const {
+        return workerCount;
+    }
+
+    // Counter: ticks run since start, summed over games
+    long long getTickCount() const {
+        return ticks.load(std::memory_order_relaxed);
+    }
+
+    // Counter: matches created by ticks
+    long long getMatchesCreated() const {
+        return matchesCreated.load(std::memory_order_relaxed);
+    }
+
+    // Gauge: duration of the most recent tick (any game) in nanoseconds
+    long long getLastTickNanos() const {
+        return lastTickNanos.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // MATCHMAKING_TICKER_H
@@ -0,0 +1,750 @@
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include "../ds/ByteBuffer.h"
+#include "../ds/MappedFile.h"
+#include "../models/Match.h"
+#include "../models/Party.h"
+#include "PlayerStore.h"
+#include "RankingService.h"
+#include "HistoryService.h"
+#include "Matchmaker.h"
+#include "GameRegistry.h"
+#include "StateLog.h"
+#include "BulkLoader.h"
+#include "Clock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Persistence - Snapshot + write-ahead log for the whole backend state
+ *
+ * Durable state is players (profiles, per-game ratings and Glicko state),
+ * ranking tree membership, seasons and their archives, buffered Glicko
+ * results, match history, queued players and parties, and matches in
+ * progress. It is kept as:
+ *
+ *   <dir>/players-G.img player records at generation G (PlayerStore image)
+ *   <dir>/snapshot.bin  everything else at generation G, compactly
+ *   <dir>/wal-G.log     every operation since then (StateLog)
+ *
+ * SNAPSHOTS:
+ * snapshot() holds every shard lock only while it encodes the state into
+ * two buffers and rotates the log to the next generation, so the images
+ * and the new segment meet exactly. The files are written, synced and
+ * renamed into place after the locks are released (players-G.img first,
+ * so snapshot.bin never names a missing image); only then are the
+ * previous segment and image deleted. A background thread takes one every snapshot
+ * interval (default 5 min) if anything was logged, or sooner once the
+ * segment passes a size limit (default 64 MB), so replay stays short.
+ *
+ * The player image is mapped, not read: the store serves from it as soon
+ * as it is attached, with the same dense indexes as before (buffered
+ * Glicko results are stored by index), and pages fault in as players are
+ * touched. Ranking trees are stored as their ID lists in order, so each is
+ * rebuilt in one pass (BulkLoader, games in parallel, together with the
+ * bot pools); queues and active matches as the joins and pairings that
+ * recreate them.
+ *
+ * RESTORE (startup, before ticks or requests):
+ *   1. load snapshot.bin (checksummed; none = empty state) and map the
+ *      players-G.img it names
+ *   2. replay wal-G.log, wal-G+1.log, ... through the same Matchmaker
+ *      calls that produced them (a crash between rotation and the rename
+ *      leaves two segments); a torn record at a segment's end is ignored
+ *   3. start(): open the next generation, write a fresh snapshot, attach
+ *      the log to the Matchmaker, delete the replayed segments
+ * Restore time is reported (getRestoreStats / toJson).
+ *
+ * Time Complexity:
+ *   - snapshot(): O(p + n + h) for p players, n ranked entries and h
+ *     history entries, of which only encoding runs under the locks
+ *   - restore(): O(p + n + h + r) for r logged records; the player
+ *     store itself is ready after O(p) small writes (see PlayerStore)
+ */
+class Persistence {
+public:
+    static const long long DEFAULT_SNAPSHOT_INTERVAL_NANOS = 300 * Clock::NANOS_PER_SECOND;
+    static const long long DEFAULT_SNAPSHOT_LOG_BYTES = 64LL * 1024 * 1024;
+
+    struct RestoreStats {
+        int players;
+        long long imageBytes;     // Player image mapped
+        long long snapshotBytes;
+        long long records;        // Logged operations replayed
+        long long logBytes;
+        int segments;
+        int failedRecords;        // Records that no longer applied (should be 0)
+        long long playersNanos;   // Until the player store was serving from its image
+        long long buildNanos;     // Bot pools and ranking trees (BulkLoader)
+        int buildThreads;
+        long long snapshotNanos;  // Loading the snapshot (including the image)
+        long long replayNanos;    // Replaying the log
+
+        RestoreStats() : players(0), imageBytes(0), snapshotBytes(0), records(0), logBytes(0), segments(0),
+                         failedRecords(0), playersNanos(0), buildNanos(0), buildThreads(0),
+                         snapshotNanos(0), replayNanos(0) {}
+    };
+
+private:
+    static const int FORMAT_VERSION = 2;
+    static const size_t MAGIC_LENGTH = 8;
+    static const size_t IMAGE_HEADER_BYTES = 64;  // Image columns start aligned
+
+    PlayerStore* players;
+    RankingService* rankingService;
+    HistoryService* historyService;
+    Matchmaker* matchmaker;
+    const GameRegistry* games;
+    StateLog* stateLog;
+
+    std::string directory;
+    long long restoredGeneration;  // Generation of the snapshot loaded
+    long long lastGeneration;      // Last segment replayed
+    RestoreStats restoreStats;
+    long long restoreStart;        // Monotonic ns restore() began
+
+    // One snapshot at a time
+    std::mutex snapshotMutex;
+
+    // Background snapshots
+    std::thread worker;
+    std::mutex wakeMutex;
+    std::condition_variable wakeup;
+    bool stopRequested;  // Guarded by wakeMutex
+    long long intervalNanos;
+    long long logBytesLimit;
+
+    // Counters
+    std::atomic<long long> snapshots;
+    std::atomic<long long> lastSnapshotBytes;
+    std::atomic<long long> lastSnapshotLockedNanos;  // Encoding under the locks
+    std::atomic<long long> lastSnapshotNanos;        // Whole snapshot, including the write
+
+    static const char* magic() {
+        return "ARENASNP";
+    }
+
+    static const char* imageMagic() {
+        return "ARENAIMG";
+    }
+
+    std::string snapshotPath() const {
+        return directory + "/snapshot.bin";
+    }
+
+    std::string imagePath(long long generation) const {
+        return directory + "/players-" + std::to_string(generation) + ".img";
+    }
+
+    // ========== ENCODING ==========
+
+    static void putMatch(ByteWriter& out, const Match& match) {
+        out.putInt(match.matchId);
+        out.putInt(match.gameId);
+        out.putLong(match.createdAt);
+        out.putInt(match.winnerId);
+        out.putByte(match.isCompleted ? 1 : 0);
+        out.putInt(match.teamSize);
+        for (int i = 0; i < match.teamSize; i++) out.putInt(match.team1[i]);
+        for (int i = 0; i < match.teamSize; i++) out.putInt(match.team2[i]);
+    }
+
+    static bool getMatch(ByteReader& in, Match& match) {
+        int matchId = in.getInt();
+        int gameId = in.getInt();
+        long long createdAt = in.getLong();
+        int winnerId = in.getInt();
+        bool completed = in.getByte() != 0;
+        int teamSize = in.getInt();
+        if (!in.ok() || teamSize < 1 || teamSize > Match::MAX_TEAM_SIZE) return false;
+        int team1[Match::MAX_TEAM_SIZE];
+        int team2[Match::MAX_TEAM_SIZE];
+        for (int i = 0; i < teamSize; i++) team1[i] = in.getInt();
+        for (int i = 0; i < teamSize; i++) team2[i] = in.getInt();
+        match = Match(matchId, team1[0], team2[0], gameId, createdAt);
+        if (teamSize > 1) match.setTeams(team1, team2, teamSize);
+        if (completed) match.complete(winnerId);
+        return in.ok();
+    }
+
+    /**
+     * Encode the whole state (caller holds an ExclusiveLock)
+     *
+     * image gets the player image (header + PlayerStore::writeImage);
+     * out gets the header, player count, per-game rankings / seasons /
+     * pending results / match sequence, history, queues, active matches.
+     */
+    void encode(ByteWriter& out, ByteWriter& image, long long generation, Matchmaker::ExclusiveLock& exclusive) {
+        int count = players->size();
+        int gameCount = players->getGameCount();
+        out.reserve(static_cast<size_t>(count) * 8 * gameCount + 1024);
+
+        image.putBytes(imageMagic(), MAGIC_LENGTH);
+        image.putInt(FORMAT_VERSION);
+        image.putLong(generation);
+        image.align(IMAGE_HEADER_BYTES);
+        players->writeImage(image);
+
+        out.putLong(generation);
+        out.putInt(gameCount);
+        out.putInt(static_cast<int>(rankingService->getRatingSystem()));
+        out.putInt(rankingService->getRatingPeriod());
+        out.putInt(count);
+
+        // Per game: ranking membership, seasons, open rating period, match IDs
+        for (int g = 0; g < gameCount; g++) {
+            out.putInt(static_cast<int>(rankingService->getRankingCount(g)));
+            rankingService->forEachRanked(g, [&out](const PlayerELO& entry) {
+                out.putInt(entry.playerId);
+            });
+
+            out.putInt(rankingService->getSeason(g));
+            int archived = rankingService->getArchivedSeasonCount(g);
+            out.putInt(archived);
+            for (int s = 1; s <= archived; s++) {
+                const SeasonArchive* archive = rankingService->getArchivedSeason(g, s);
+                out.putInt(archive->getSeason());
+                out.putInt(archive->size());
+                for (int rank = 1; rank <= archive->size(); rank++) {
+                    int playerId, elo;
+                    archive->getByRank(rank, playerId, elo);
+                    out.putInt(playerId);
+                    out.putInt(elo);
+                }
+            }
+
+            int pending = rankingService->getPendingResults(g);
+            out.putInt(pending);
+            for (int r = 0; r < pending; r++) {
+                int winner, loser;
+                double weight;
+                rankingService->getPendingResult(g, r, winner, loser, weight);
+                out.putInt(winner);
+                out.putInt(loser);
+                out.putDouble(weight);
+            }
+
+            out.putInt(exclusive.shard(g).getNextMatchSequence());
+        }
+
+        // History, per player in index order
+        for (int i = 0; i < count; i++) {
+            LinkedList<Match>* list = historyService->getPlayerHistory(players->getId(i));
+            out.putInt(list ? static_cast<int>(list->size()) : 0);
+            if (!list) continue;
+            for (auto it = list->begin(); it != list->end(); ++it) putMatch(out, *it);
+        }
+
+        // Queues (FIFO, as the joins that recreate them) and matches in progress
+        for (int g = 0; g < gameCount; g++) {
+            size_t countAt = out.size();
+            int entries = 0;
+            out.putInt(0);
+            exclusive.shard(g).forEachQueued([&](const QueueEntry& entry, const Party* party) {
+                if (entry.partySize > 1 && !party) return;
+                int size = party ? party->size : 1;
+                out.putInt(size);
+                for (int m = 0; m < size; m++) out.putInt(party ? party->memberIds[m] : entry.playerId);
+                out.putByte(players->getAttributes(players->indexOf(entry.playerId)).pack());
+                entries++;
+            });
+            out.patchInt(countAt, entries);
+
+            countAt = out.size();
+            int matches = 0;
+            out.putInt(0);
+            exclusive.shard(g).forEachActiveMatch([&](const Match& match) {
+                putMatch(out, match);
+                matches++;
+            });
+            out.patchInt(countAt, matches);
+        }
+    }
+
+    /**
+     * Load an encoded state into the (empty) services
+     *
+     * @return false if the image is truncated or was taken with a
+     *         different game configuration
+     */
+    bool decode(ByteReader& in, long long& outGeneration) {
+        outGeneration = in.getLong();
+        int gameCount = in.getInt();
+        int ratingSystem = in.getInt();
+        int ratingPeriod = in.getInt();
+        if (!in.ok() || gameCount != players->getGameCount() || players->size() != 0) {
+            fprintf(stderr, "[Persistence] Snapshot has %d games, configured %d\n", gameCount, players->getGameCount());
+            return false;
+        }
+        if (ratingSystem != static_cast<int>(rankingService->getRatingSystem())) {
+            printf("[Persistence] Snapshot was taken under another rating system; ratings carry over\n");
+        }
+        rankingService->setRatingPeriod(ratingPeriod);
+
+        // Players: map the image of the same generation
+        int count = in.getInt();
+        if (!in.ok() || !attachImage(outGeneration) || players->size() != count) {
+            fprintf(stderr, "[Persistence] %s is missing or does not match\n", imagePath(outGeneration).c_str());
+            return false;
+        }
+        restoreStats.playersNanos = Clock::monotonicNanos() - restoreStart;
+
+        // Bots rejoin their game's pool; pools and trees are built per game
+        // in parallel once everything is read (BulkLoader)
+        BulkLoader loader(players, rankingService, matchmaker, games);
+        for (int i = 0; i < count; i++) {
+            if (!players->isBot(i)) continue;  // Leaves human profile pages untouched
+            loader.addPoolBot(i, players->getProfile(i).preferredGame);
+        }
+
+        // Per game
+        for (int g = 0; g < gameCount; g++) {
+            int ranked = in.getInt();
+            if (!in.ok() || ranked < 0 || static_cast<size_t>(ranked) > in.remaining()) return false;
+            for (int r = 0; r < ranked; r++) {
+                int index = players->indexOf(in.getInt());
+                if (index != PlayerStore::NO_PLAYER) loader.addRanked(index, g);  // In key order
+            }
+
+            rankingService->restoreSeason(g, in.getInt());
+            int archived = in.getInt();
+            for (int s = 0; s < archived && in.ok(); s++) {
+                int season = in.getInt();
+                int size = in.getInt();
+                if (!in.ok() || size < 0 || static_cast<size_t>(size) > in.remaining()) return false;
+                PlayerELO* ascending = new PlayerELO[size > 0 ? size : 1];
+                for (int rank = 0; rank < size; rank++) {
+                    ascending[size - 1 - rank].playerId = in.getInt();
+                    ascending[size - 1 - rank].elo = in.getInt();
+                }
+                rankingService->restoreArchivedSeason(g, new SeasonArchive(season, ascending, size));
+                delete[] ascending;
+            }
+
+            int pending = in.getInt();
+            for (int r = 0; r < pending && in.ok(); r++) {
+                int winner = in.getInt();
+                int loser = in.getInt();
+                double weight = in.getDouble();
+                if (winner >= 0 && winner < count && loser >= 0 && loser < count) {
+                    rankingService->restorePendingResult(g, winner, loser, weight);
+                }
+            }
+
+            int sequence = in.getInt();
+            Matchmaker::ExclusiveLock exclusive(*matchmaker);
+            exclusive.shard(g).setNextMatchSequence(sequence);
+        }
+        if (!in.ok()) return false;
+        loader.build();
+        restoreStats.buildNanos = loader.getReport().buildNanos;
+        restoreStats.buildThreads = loader.getReport().threads;
+
+        // History
+        Match match;
+        for (int i = 0; i < count; i++) {
+            int entries = in.getInt();
+            int playerId = players->getId(i);
+            for (int e = 0; e < entries; e++) {
+                if (!getMatch(in, match)) return false;
+                historyService->restoreMatch(playerId, match);
+            }
+        }
+
+        // Queues and matches in progress
+        for (int g = 0; g < gameCount; g++) {
+            int entries = in.getInt();
+            for (int e = 0; e < entries && in.ok(); e++) {
+                int size = in.getInt();
+                if (size < 1 || size > Party::MAX_SIZE) return false;
+                int members[Party::MAX_SIZE];
+                for (int m = 0; m < size; m++) members[m] = in.getInt();
+                unsigned char attributes = in.getByte();
+                if (size > 1) matchmaker->joinPartyQueue(members, size, g);
+                else matchmaker->joinQueue(members[0], g, MatchAttributes::unpack(attributes));
+            }
+            int matches = in.getInt();
+            for (int m = 0; m < matches && in.ok(); m++) {
+                if (!getMatch(in, match)) return false;
+                matchmaker->restoreMatch(match);
+            }
+        }
+        return in.ok();
+    }
+
+    // Map players-<generation>.img and serve the (empty) store from it
+    bool attachImage(long long generation) {
+        MappedFile file;
+        if (!file.map(imagePath(generation).c_str())) return false;
+        ByteReader header(file.data(), file.size());
+        char fileMagic[MAGIC_LENGTH];
+        header.getBytes(fileMagic, MAGIC_LENGTH);
+        int version = header.getInt();
+        long long imageGeneration = header.getLong();
+        if (!header.ok() || memcmp(fileMagic, imageMagic(), MAGIC_LENGTH) != 0 ||
+            version != FORMAT_VERSION || imageGeneration != generation) {
+            return false;
+        }
+        restoreStats.imageBytes = static_cast<long long>(file.size());
+        return players->attachImage(file, IMAGE_HEADER_BYTES);
+    }
+
+    // ========== REPLAY ==========
+
+    // Apply one logged operation through the call that produced it
+    bool apply(StateLog::RecordType type, ByteReader& in) {
+        switch (type) {
+            case StateLog::PLAYER: {
+                int playerId = in.getInt();
+                int elo = in.getInt();
+                bool bot = in.getByte() != 0;
+                char name[PlayerStore::MAX_NAME_LENGTH + 1];
+                if (!in.getString(name, sizeof(name))) return false;
+                Matchmaker::ExclusiveLock exclusive(*matchmaker);
+                return players->create(playerId, name, elo, bot) != PlayerStore::NO_PLAYER;
+            }
+            case StateLog::QUEUE: {
+                int playerId = in.getInt();
+                int gameId = in.getInt();
+                unsigned char attributes = in.getByte();
+                return in.ok() && matchmaker->joinQueue(playerId, gameId, MatchAttributes::unpack(attributes));
+            }
+            case StateLog::PARTY: {
+                int gameId = in.getInt();
+                int count = in.getInt();
+                if (!in.ok() || count < 2 || count > Party::MAX_SIZE) return false;
+                int members[Party::MAX_SIZE];
+                for (int i = 0; i < count; i++) members[i] = in.getInt();
+                return in.ok() && matchmaker->joinPartyQueue(members, count, gameId);
+            }
+            case StateLog::LEAVE: {
+                int playerId = in.getInt();
+                int gameId = in.getInt();
+                return in.ok() && matchmaker->leaveQueue(playerId, gameId);
+            }
+            case StateLog::MATCH: {
+                Match match;
+                return StateLog::readMatch(in, match) && matchmaker->restoreMatch(match);
+            }
+            case StateLog::RESULT: {
+                int matchId = in.getInt();
+                int winnerId = in.getInt();
+                return in.ok() && matchmaker->submitMatchResult(matchId, winnerId);
+            }
+            case StateLog::PERIOD:
+                matchmaker->closeRatingPeriod();
+                return true;
+            case StateLog::SEASON: {
+                int gameId = in.getInt();
+                int target = in.getInt();
+                int keepPercent = in.getInt();
+                return in.ok() && matchmaker->rollOverSeason(gameId, RankingService::SeasonRules(target, keepPercent)) > 0;
+            }
+        }
+        return false;
+    }
+
+    // ========== FILES ==========
+
+    // Make a rename in the data directory durable
+    void syncDirectory() const {
+#ifndef _WIN32
+        int fd = ::open(directory.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            fsync(fd);
+            ::close(fd);
+        }
+#endif
+    }
+
+    // Replace path with header + body (temp file, sync, rename)
+    bool writeFile(const std::string& path, const ByteWriter& header, const ByteWriter& body) {
+        std::string temp = path + ".tmp";
+        FILE* out = fopen(temp.c_str(), "wb");
+        if (!out) return false;
+        bool ok = fwrite(header.bytes(), 1, header.size(), out) == header.size() &&
+                  fwrite(body.bytes(), 1, body.size(), out) == body.size();
+        StateLog::syncFile(out);
+        fclose(out);
+        if (!ok) return false;
+#ifdef _WIN32
+        remove(path.c_str());
+#endif
+        if (rename(temp.c_str(), path.c_str()) != 0) return false;
+        syncDirectory();
+        return true;
+    }
+
+    // Write an encoded state as the current snapshot (magic, version, length, CRC, body)
+    bool writeSnapshot(const ByteWriter& body) {
+        ByteWriter header;
+        header.putBytes(magic(), MAGIC_LENGTH);
+        header.putInt(FORMAT_VERSION);
+        header.putLong(static_cast<long long>(body.size()));
+        header.putUnsigned(crc32(body.bytes(), body.size()));
+        return writeFile(snapshotPath(), header, body);
+    }
+
+    /**
+     * Read and check the snapshot file
+     *
+     * @return Body bytes (caller deletes), or nullptr if there is no
+     *         snapshot; outCorrupt is set if one exists but fails its check
+     */
+    char* readSnapshot(size_t& outLength, bool& outCorrupt) const {
+        outLength = 0;
+        outCorrupt = false;
+        FILE* in = fopen(snapshotPath().c_str(), "rb");
+        if (!in) return nullptr;
+        char header[MAGIC_LENGTH];
+        int version = 0;
+        long long length = 0;
+        unsigned checksum = 0;
+        bool ok = fread(header, 1, MAGIC_LENGTH, in) == MAGIC_LENGTH &&
+                  memcmp(header, magic(), MAGIC_LENGTH) == 0 &&
+                  fread(&version, sizeof(version), 1, in) == 1 && version == FORMAT_VERSION &&
+                  fread(&length, sizeof(length), 1, in) == 1 && length >= 0 &&
+                  fread(&checksum, sizeof(checksum), 1, in) == 1;
+        char* body = nullptr;
+        if (ok) {
+            body = new char[length > 0 ? length : 1];
+            ok = fread(body, 1, static_cast<size_t>(length), in) == static_cast<size_t>(length) &&
+                 crc32(body, static_cast<size_t>(length)) == checksum;
+        }
+        fclose(in);
+        if (!ok) {
+            delete[] body;
+            outCorrupt = true;
+            return nullptr;
+        }
+        outLength = static_cast<size_t>(length);
+        return body;
+    }
+
+    /**
+     * Delete log segments and player images older than a generation (those
+     * a snapshot covers). A mapped image cannot be deleted on Windows; it
+     * stays until a later run.
+     */
+    void removeBefore(long long generation, long long from) const {
+        for (long long g = from < 0 ? 0 : from; g < generation; g++) {
+            remove(StateLog::segmentPath(directory, g).c_str());
+            remove(imagePath(g).c_str());
+        }
+    }
+
+    // Encode under the locks, rotating the log to generation (if rotate)
+    bool takeSnapshot(long long generation, bool rotate) {
+        long long start = Clock::monotonicNanos();
+        ByteWriter body;
+        ByteWriter image;
+        {
+            Matchmaker::ExclusiveLock exclusive(*matchmaker);
+            encode(body, image, generation, exclusive);
+            if (rotate && !stateLog->rotate(generation)) return false;
+        }
+        long long locked = Clock::monotonicNanos() - start;
+        if (!writeFile(imagePath(generation), ByteWriter(), image)) {
+            fprintf(stderr, "[Persistence] Failed to write %s\n", imagePath(generation).c_str());
+            return false;
+        }
+        if (!writeSnapshot(body)) {
+            fprintf(stderr, "[Persistence] Failed to write %s\n", snapshotPath().c_str());
+            return false;
+        }
+        snapshots.fetch_add(1, std::memory_order_relaxed);
+        lastSnapshotBytes.store(static_cast<long long>(image.size() + body.size()), std::memory_order_relaxed);
+        lastSnapshotLockedNanos.store(locked, std::memory_order_relaxed);
+        lastSnapshotNanos.store(Clock::monotonicNanos() - start, std::memory_order_relaxed);
+        return true;
+    }
+
+    void run() {
+        long long lastAt = Clock::monotonicNanos();
+        std::unique_lock<std::mutex> wait(wakeMutex);
+        while (!stopRequested) {
+            wakeup.wait_for(wait, std::chrono::seconds(1), [this] { return stopRequested; });
+            if (stopRequested) break;
+            long long now = Clock::monotonicNanos();
+            long long logged = stateLog->getSegmentBytes();
+            if ((logged > 0 && now - lastAt >= intervalNanos) || logged >= logBytesLimit) {
+                wait.unlock();
+                snapshot();
+                wait.lock();
+                lastAt = Clock::monotonicNanos();
+            }
+        }
+    }
+
+public:
+    Persistence(PlayerStore* store, RankingService* ranking, HistoryService* history,
+                Matchmaker* mm, const GameRegistry* registry, StateLog* log)
+        : players(store), rankingService(ranking), historyService(history), matchmaker(mm),
+          games(registry), stateLog(log), restoredGeneration(0), lastGeneration(0), restoreStart(0),
+          stopRequested(false), intervalNanos(DEFAULT_SNAPSHOT_INTERVAL_NANOS),
+          logBytesLimit(DEFAULT_SNAPSHOT_LOG_BYTES), snapshots(0), lastSnapshotBytes(0),
+          lastSnapshotLockedNanos(0), lastSnapshotNanos(0) {}
+
+    ~Persistence() {
+        stop();
+    }
+
+    Persistence(const Persistence&) = delete;
+    Persistence& operator=(const Persistence&) = delete;
+
+    // Time between background snapshots (taken only if something was logged)
+    void setSnapshotIntervalNanos(long long nanos) {
+        intervalNanos = nanos < Clock::NANOS_PER_SECOND ? Clock::NANOS_PER_SECOND : nanos;
+    }
+
+    // Log segment size that triggers a snapshot early
+    void setSnapshotLogBytes(long long bytes) {
+        logBytesLimit = bytes < 1024 ? 1024 : bytes;
+    }
+
+    /**
+     * Load <dir>/snapshot.bin and replay the log segments after it
+     *
+     * Call with empty services, before start() and before any ticks or
+     * requests. No snapshot means a first run (empty state).
+     *
+     * @return false if the snapshot is unreadable or from another game
+     *         configuration; nothing should then be written to dir
+     */
+    bool restore(const std::string& dir) {
+        directory = dir;
+        StateLog::makeDirectory(directory);
+        restoreStats = RestoreStats();
+
+        long long start = Clock::monotonicNanos();
+        restoreStart = start;
+        size_t length = 0;
+        bool corrupt = false;
+        char* body = readSnapshot(length, corrupt);
+        if (corrupt) {
+            fprintf(stderr, "[Persistence] %s is damaged\n", snapshotPath().c_str());
+            return false;
+        }
+        long long generation = 0;
+        if (body) {
+            ByteReader in(body, length);
+            bool ok = decode(in, generation);
+            delete[] body;
+            if (!ok) {
+                fprintf(stderr, "[Persistence] %s could not be loaded\n", snapshotPath().c_str());
+                return false;
+            }
+            restoreStats.snapshotBytes = static_cast<long long>(length);
+        }
+        restoreStats.snapshotNanos = Clock::monotonicNanos() - start;
+
+        // Replay every segment from the snapshot's generation on
+        start = Clock::monotonicNanos();
+        restoredGeneration = generation;
+        lastGeneration = generation;
+        for (long long g = generation; ; g++) {
+            long long validBytes = 0;
+            long long records = StateLog::replay(StateLog::segmentPath(directory, g), [this](StateLog::RecordType type, ByteReader& in) {
+                if (!apply(type, in)) restoreStats.failedRecords++;
+            }, validBytes);
+            if (records < 0) break;
+            lastGeneration = g;
+            restoreStats.segments++;
+            restoreStats.records += records;
+            restoreStats.logBytes += validBytes;
+        }
+        restoreStats.replayNanos = Clock::monotonicNanos() - start;
+        restoreStats.players = players->size();
+        return true;
+    }
+
+    /**
+     * Begin logging: open the next generation's segment, write a snapshot
+     * of the restored state for it, attach the log to the Matchmaker,
+     * delete the replayed segments and start background snapshots
+     *
+     * @return false if the log or the snapshot cannot be written
+     */
+    bool start() {
+        long long generation = lastGeneration + 1;
+        if (!stateLog->open(directory, generation)) {
+            fprintf(stderr, "[Persistence] Cannot open %s\n", StateLog::segmentPath(directory, generation).c_str());
+            return false;
+        }
+        if (!takeSnapshot(generation, false)) {
+            stateLog->close();
+            return false;
+        }
+        matchmaker->setStateLog(stateLog);
+        removeBefore(generation, restoredGeneration - 1);
+
+        std::lock_guard<std::mutex> guard(wakeMutex);
+        stopRequested = false;
+        worker = std::thread(&Persistence::run, this);
+        return true;
+    }
+
+    // Stop background snapshots and commit the log
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(wakeMutex);
+            stopRequested = true;
+        }
+        wakeup.notify_all();
+        if (worker.joinable()) worker.join();
+        stateLog->close();
+    }
+
+    /**
+     * Snapshot now and continue logging in the next generation
+     *
+     * @return false if the snapshot could not be written (the log keeps
+     *         every record, so nothing is lost)
+     */
+    bool snapshot() {
+        std::lock_guard<std::mutex> guard(snapshotMutex);
+        if (!stateLog->isOpen()) return false;
+        long long previous = stateLog->getGeneration();
+        if (!takeSnapshot(previous + 1, true)) return false;
+        removeBefore(previous + 1, previous);
+        return true;
+    }
+
+    const RestoreStats& getRestoreStats() const {
+        return restoreStats;
+    }
+
+    long long getSnapshotCount() const { return snapshots.load(std::memory_order_relaxed); }
+    long long getLastSnapshotBytes() const { return lastSnapshotBytes.load(std::memory_order_relaxed); }
+    long long getLastSnapshotNanos() const { return lastSnapshotNanos.load(std::memory_order_relaxed); }
+    long long getLastSnapshotLockedNanos() const { return lastSnapshotLockedNanos.load(std::memory_order_relaxed); }
+
+    // {"generation":..,"logBytes":..,"records":..,"commits":..,"snapshots":..,...,"restore":{...}}
+    std::string toJson() {
+        char buf[640];
+        snprintf(buf, sizeof(buf),
+                 "{\"generation\":%lld,\"logBytes\":%lld,\"records\":%lld,\"commits\":%lld,"
+                 "\"snapshots\":%lld,\"lastSnapshotBytes\":%lld,\"lastSnapshotMs\":%.1f,\"lastSnapshotLockedMs\":%.1f,"
+                 "\"restore\":{\"players\":%d,\"records\":%lld,\"failedRecords\":%d,\"playersMs\":%.1f,\"buildMs\":%.1f,"
+                 "\"snapshotMs\":%.1f,\"replayMs\":%.1f}}",
+                 stateLog->getGeneration(), stateLog->getSegmentBytes(), stateLog->getAppendedCount(),
+                 stateLog->getCommitCount(), getSnapshotCount(), getLastSnapshotBytes(),
+                 getLastSnapshotNanos() / 1e6, getLastSnapshotLockedNanos() / 1e6,
+                 restoreStats.players, restoreStats.records, restoreStats.failedRecords,
+                 restoreStats.playersNanos / 1e6, restoreStats.buildNanos / 1e6, restoreStats.snapshotNanos / 1e6, restoreStats.replayNanos / 1e6);
+        return buf;
+    }
+};
+
+#endif // PERSISTENCE_H
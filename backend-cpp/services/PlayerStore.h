@@ -0,0 +1,439 @@
+#ifndef PLAYER_STORE_H
+#define PLAYER_STORE_H
+
+#include "../ds/ChunkedArray.h"
+#include "../ds/HashTable.h"
+#include "../ds/StringPool.h"
+#include "../ds/ByteBuffer.h"
+#include "../ds/MappedFile.h"
+#include "../models/Player.h"
+#include "../models/PlayerState.h"
+#include "../models/MatchAttributes.h"
+#include "../models/GlickoRating.h"
+#include "GameRegistry.h"
+#include <atomic>
+
+/**
+ * PlayerStore - Hot/cold split storage for all players (humans and bots)
+ *
+ * Every player gets a dense index when created. The fields read on every
+ * matchmaking decision are kept in parallel columns (structure-of-arrays),
+ * so bot selection and candidate filtering only touch a few bytes per
+ * player instead of pulling a whole profile into cache.
+ *
+ * Hot columns (by player index):
+ *   - ids:   PlayerID
+ *   - elos:  current ELO, one column per game (see RATINGS)
+ *   - flags: BOT bit
+ *   - state: packed PlayerState word (status, game, queue handle, match),
+ *            updated with compare-and-swap at every transition
+ *   - attributes: packed MatchAttributes (latency bucket, input device),
+ *            written by the shard that queues the player
+ *   - queuedAt: monotonic ns of the player's latest queue join, written by
+ *            the shard that queues the player (match telemetry)
+ *
+ * Cold columns (by player index):
+ *   - Player: username ID, preferred game, wins/losses, recent opponents
+ *   - glicko: Glicko-2 rating, deviation and volatility, one column per
+ *            game (read and written only when a rating period closes -
+ *            see Glicko2)
+ *
+ * RATINGS:
+ * A player has a separate rating in every game: the rating record for
+ * (player index, game ID) is elos[gameId][index] (plus glicko[gameId]
+ * [index]). A game's ratings are one dense column, so everything that
+ * reads one game's ratings for many players - queue snapshots, bot and
+ * candidate indexes, ranking trees - walks a single array, and a result
+ * in one game never moves a rating in another. Only the first
+ * setGameCount() columns are filled (all MAX_GAMES by default); callers
+ * pass valid game IDs. New players start at the same ELO in every game.
+ *
+ * Usernames are interned once in a StringPool (raw + JSON-escaped bytes),
+ * so name equality is an ID compare and responses copy pre-escaped bytes.
+ *
+ * PlayerID -> index and username ID -> index lookups use HashTable<int, int>.
+ *
+ * IMAGES:
+ * writeImage() lays the durable columns (ids, flags, profiles, ratings,
+ * Glicko state) out as fixed-size records, one column after another and
+ * padded to whole chunks, followed by an open-addressing PlayerID index,
+ * the username -> player table and the StringPool image. attachImage()
+ * serves an empty store straight from such an image in a MappedFile: the
+ * columns adopt the mapped chunks, lookups probe the mapped index, and
+ * pages are read from disk as they are first touched - nothing is
+ * rebuilt entry by entry. The mapping is private, so later writes stay
+ * in memory; players created afterwards get heap chunks and the heap
+ * HashTables, which indexOf()/findByName() consult after the image.
+ * State, attributes and queue times are not imaged (every player starts
+ * idle).
+ *
+ * Time Complexity:
+ *   - create(): O(1) amortized
+ *   - indexOf(): O(1) average
+ *   - findByName(): O(name length) average
+ *   - column reads/writes: O(1)
+ *   - writeImage(): O(n + name bytes)
+ *   - attachImage(): O(n) small writes (idle states, string table), no
+ *     per-player hashing or copying
+ */
+class PlayerStore {
+public:
+    static const int NO_PLAYER = -1;
+    static const size_t MAX_NAME_LENGTH = 49;
+
+    // Bits in the flags column
+    static const unsigned char FLAG_BOT = 1 << 0;
+
+private:
+    // Image slot for a PlayerID (index NO_PLAYER = empty)
+    struct IdSlot {
+        int id;
+        int index;
+    };
+
+    static const size_t IMAGE_ALIGNMENT = 64;
+
+    // Backing file of an attached image; declared first so it is unmapped
+    // after every column that points into it
+    MappedFile image;
+
+    // Hot columns
+    ChunkedArray<int> ids;
+    ChunkedArray<int> elos[GameRegistry::MAX_GAMES];
+    ChunkedArray<unsigned char> flags;
+    ChunkedArray<std::atomic<PlayerState::Word> > states;
+    ChunkedArray<unsigned char> attributes;
+    ChunkedArray<long long> queuedAt;
+
+    // Cold columns
+    ChunkedArray<Player> profiles;
+    ChunkedArray<GlickoRating> glicko[GameRegistry::MAX_GAMES];
+    int gameCount;  // Rating columns in use
+
+    // Interned usernames
+    StringPool names;
+    
+    // PlayerID -> dense index, username ID -> dense index
+    HashTable<int, int> indexById;
+    HashTable<int, int> indexByName;
+
+    // Attached image's indexes (players 0 .. imageCount-1)
+    const IdSlot* imageIds;
+    size_t imageIdMask;
+    const int* imageByName;  // Username ID -> first index, NO_PLAYER if none
+    int imageNameCount;
+    int imageCount;
+
+    static size_t hashId(int playerId) {
+        return static_cast<size_t>(static_cast<unsigned int>(playerId) * 2654435761u);
+    }
+
+    static size_t chunkCapacity(int count) {
+        return (static_cast<size_t>(count) + ChunkedArray<int>::CHUNK_MASK) & ~ChunkedArray<int>::CHUNK_MASK;
+    }
+
+    // First count elements of a column, padded with T() to whole chunks
+    template <typename T>
+    static void writeColumn(ByteWriter& out, const ChunkedArray<T>& column, int count) {
+        out.align(IMAGE_ALIGNMENT);
+        size_t capacity = chunkCapacity(count);
+        out.reserve(capacity * sizeof(T));
+        for (int i = 0; i < count; i++) out.putBytes(&column[i], sizeof(T));
+        T blank = T();
+        for (size_t i = static_cast<size_t>(count); i < capacity; i++) out.putBytes(&blank, sizeof(T));
+    }
+
+    // Locate a column written by writeColumn(), or nullptr if truncated
+    template <typename T>
+    static T* findColumn(ByteReader& in, char* base, int count) {
+        in.align(IMAGE_ALIGNMENT);
+        T* column = reinterpret_cast<T*>(base + in.offset());
+        return in.skip(chunkCapacity(count) * sizeof(T)) ? column : nullptr;
+    }
+
+    int imageIndexOf(int playerId) const {
+        size_t slot = hashId(playerId) & imageIdMask;
+        for (size_t probes = 0; probes <= imageIdMask; probes++, slot = (slot + 1) & imageIdMask) {
+            const IdSlot& entry = imageIds[slot];
+            if (entry.index < 0 || entry.index >= imageCount) break;
+            if (entry.id == playerId) return entry.index;
+        }
+        return NO_PLAYER;
+    }
+
+    // First player registered with an interned username
+    int indexOfName(int nameId) const {
+        if (nameId < imageNameCount && imageByName[nameId] >= 0 && imageByName[nameId] < imageCount) {
+            return imageByName[nameId];
+        }
+        const int* index = indexByName.get(nameId);
+        return index ? *index : NO_PLAYER;
+    }
+
+public:
+    PlayerStore()
+        : gameCount(GameRegistry::MAX_GAMES), imageIds(nullptr), imageIdMask(0),
+          imageByName(nullptr), imageNameCount(0), imageCount(0) {}
+
+    /**
+     * Number of games to keep ratings for (1..MAX_GAMES)
+     *
+     * Only before the first player is created; the servers pass the
+     * configured game count so unused games cost no memory.
+     *
+     * @return false if players already exist
+     */
+    bool setGameCount(int count) {
+        if (size() > 0) return false;
+        gameCount = count < 1 ? 1 : count > GameRegistry::MAX_GAMES ? GameRegistry::MAX_GAMES : count;
+        return true;
+    }
+
+    int getGameCount() const {
+        return gameCount;
+    }
+
+    /**
+     * Create a new player
+     *
+     * @return Dense index of the player, or NO_PLAYER if the ID is taken
+     */
+    int create(int playerId, const char* name, int elo = 1000, bool bot = false) {
+        if (contains(playerId)) return NO_PLAYER;
+
+        // Usernames are capped at MAX_NAME_LENGTH bytes
+        char truncated[MAX_NAME_LENGTH + 1];
+        strncpy(truncated, name, MAX_NAME_LENGTH);
+        truncated[MAX_NAME_LENGTH] = '\0';
+        int nameId = names.intern(truncated);
+        if (nameId == StringPool::NO_STRING) return NO_PLAYER;
+
+        long long index = profiles.append(Player(playerId, nameId));
+        if (index < 0) return NO_PLAYER;
+
+        ids.append(playerId);
+        for (int g = 0; g < gameCount; g++) {
+            elos[g].append(elo);
+            glicko[g].append(GlickoRating(elo));
+        }
+        flags.append(bot ? FLAG_BOT : 0);
+        states[states.append()].store(PlayerState::initial());
+        attributes.append(MatchAttributes().pack());
+        queuedAt.append(0);
+
+        indexById.insert(playerId, static_cast<int>(index));
+        if (indexOfName(nameId) == NO_PLAYER) {
+            indexByName.insert(nameId, static_cast<int>(index));
+        }
+        return static_cast<int>(index);
+    }
+
+    /**
+     * Find a player's dense index by PlayerID
+     *
+     * @return Index, or NO_PLAYER if unknown
+     */
+    int indexOf(int playerId) const {
+        if (imageIds) {
+            int index = imageIndexOf(playerId);
+            if (index != NO_PLAYER) return index;
+        }
+        const int* index = indexById.get(playerId);
+        return index ? *index : NO_PLAYER;
+    }
+
+    /**
+     * Find a player's dense index by username
+     *
+     * @return Index of the first player registered with that name,
+     *         or NO_PLAYER if unknown
+     */
+    int findByName(const char* name) const {
+        char truncated[MAX_NAME_LENGTH + 1];
+        strncpy(truncated, name, MAX_NAME_LENGTH);
+        truncated[MAX_NAME_LENGTH] = '\0';
+        int nameId = names.find(truncated);
+        if (nameId == StringPool::NO_STRING) return NO_PLAYER;
+        return indexOfName(nameId);
+    }
+
+    bool contains(int playerId) const {
+        return indexOf(playerId) != NO_PLAYER;
+    }
+
+    // Number of players (valid indexes are 0 .. size()-1)
+    int size() const {
+        return static_cast<int>(ids.size());
+    }
+
+    // ========== HOT COLUMNS ==========
+
+    int getId(int index) const { return ids[index]; }
+
+    // Rating record for (player, game)
+    int getElo(int index, int gameId) const { return elos[gameId][index]; }
+    void setElo(int index, int gameId, int elo) { elos[gameId][index] = elo; }
+
+    bool isBot(int index) const { return (flags[index] & FLAG_BOT) != 0; }
+
+    PlayerState::Word getState(int index) const {
+        return states[index].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Atomically replace a player's state word if it still equals expected
+     *
+     * @param expected Word the caller last read; refreshed with the current
+     *                 word when the swap fails
+     * @return true if the transition happened
+     */
+    bool compareAndSetState(int index, PlayerState::Word& expected, PlayerState::Word desired) {
+        return states[index].compare_exchange_strong(expected, desired, std::memory_order_acq_rel);
+    }
+
+    MatchAttributes getAttributes(int index) const { return MatchAttributes::unpack(attributes[index]); }
+    void setAttributes(int index, const MatchAttributes& value) { attributes[index] = value.pack(); }
+
+    long long getQueuedAt(int index) const { return queuedAt[index]; }
+    void setQueuedAt(int index, long long nanos) { queuedAt[index] = nanos; }
+
+    bool isInQueue(int index) const { return PlayerState::status(getState(index)) == PlayerState::QUEUED; }
+    bool isInMatch(int index) const { return PlayerState::status(getState(index)) == PlayerState::IN_MATCH; }
+
+    // ========== COLD TABLE ==========
+
+    Player& getProfile(int index) { return profiles[index]; }
+    const Player& getProfile(int index) const { return profiles[index]; }
+
+    GlickoRating& getGlicko(int index, int gameId) { return glicko[gameId][index]; }
+    const GlickoRating& getGlicko(int index, int gameId) const { return glicko[gameId][index]; }
+
+    // Username bytes (raw, and JSON-escaped without quotes)
+    const char* getName(int index) const { return names.get(profiles[index].nameId); }
+    const char* getEscapedName(int index) const { return names.getEscaped(profiles[index].nameId); }
+    size_t getEscapedNameLength(int index) const { return names.escapedLength(profiles[index].nameId); }
+
+    // ========== IMAGES ==========
+
+    /**
+     * Append an image of every player to out (see IMAGES)
+     *
+     * Column offsets are aligned relative to the start of out, so out must
+     * become the file that is mapped from its first byte. Callers keep
+     * create() and rating writes out for the duration (ExclusiveLock).
+     */
+    void writeImage(ByteWriter& out) const {
+        int count = size();
+        out.putInt(count);
+        out.putInt(gameCount);
+        out.putInt(static_cast<int>(sizeof(Player)));
+        out.putInt(static_cast<int>(sizeof(GlickoRating)));
+
+        writeColumn(out, ids, count);
+        writeColumn(out, flags, count);
+        writeColumn(out, profiles, count);
+        for (int g = 0; g < gameCount; g++) writeColumn(out, elos[g], count);
+        for (int g = 0; g < gameCount; g++) writeColumn(out, glicko[g], count);
+
+        // PlayerID index
+        size_t slotCount = 16;
+        while (slotCount < static_cast<size_t>(count) * 2) slotCount *= 2;
+        IdSlot* slots = new IdSlot[slotCount];
+        for (size_t i = 0; i < slotCount; i++) {
+            slots[i].id = 0;
+            slots[i].index = NO_PLAYER;
+        }
+        for (int i = 0; i < count; i++) {
+            size_t slot = hashId(ids[i]) & (slotCount - 1);
+            while (slots[slot].index != NO_PLAYER) slot = (slot + 1) & (slotCount - 1);
+            slots[slot].id = ids[i];
+            slots[slot].index = i;
+        }
+        out.align(IMAGE_ALIGNMENT);
+        out.putInt(static_cast<int>(slotCount));
+        out.putBytes(slots, slotCount * sizeof(IdSlot));
+        delete[] slots;
+
+        // Username ID -> first player
+        int nameCount = names.size();
+        int* byName = new int[nameCount > 0 ? nameCount : 1];
+        for (int n = 0; n < nameCount; n++) byName[n] = NO_PLAYER;
+        for (int i = count - 1; i >= 0; i--) byName[profiles[i].nameId] = i;
+        out.putInt(nameCount);
+        out.putBytes(byName, static_cast<size_t>(nameCount) * sizeof(int));
+        delete[] byName;
+
+        names.writeImage(out);
+    }
+
+    /**
+     * Serve this (empty) store from an image mapped in file
+     *
+     * Takes over the mapping (file is left unmapped) on success.
+     *
+     * @param offset Where writeImage() output starts in the file
+     * @return false if players exist or the image does not match this
+     *         build and game count
+     */
+    bool attachImage(MappedFile& file, size_t offset) {
+        if (size() > 0 || !file.isMapped()) return false;
+        char* base = file.data();
+        ByteReader in(base, file.size());
+        in.skip(offset);
+        int count = in.getInt();
+        int games = in.getInt();
+        int playerBytes = in.getInt();
+        int glickoBytes = in.getInt();
+        if (!in.ok() || count < 0 || games != gameCount || playerBytes != static_cast<int>(sizeof(Player)) ||
+            glickoBytes != static_cast<int>(sizeof(GlickoRating))) {
+            return false;
+        }
+
+        int* idColumn = findColumn<int>(in, base, count);
+        unsigned char* flagColumn = findColumn<unsigned char>(in, base, count);
+        Player* profileColumn = findColumn<Player>(in, base, count);
+        int* eloColumns[GameRegistry::MAX_GAMES];
+        GlickoRating* glickoColumns[GameRegistry::MAX_GAMES];
+        for (int g = 0; g < gameCount; g++) eloColumns[g] = findColumn<int>(in, base, count);
+        for (int g = 0; g < gameCount; g++) glickoColumns[g] = findColumn<GlickoRating>(in, base, count);
+
+        in.align(IMAGE_ALIGNMENT);
+        int slotCount = in.getInt();
+        if (!in.ok() || slotCount < 1 || (slotCount & (slotCount - 1)) != 0) return false;
+        const IdSlot* slots = reinterpret_cast<const IdSlot*>(base + in.offset());
+        in.skip(static_cast<size_t>(slotCount) * sizeof(IdSlot));
+        int nameCount = in.getInt();
+        if (!in.ok() || nameCount < 0) return false;
+        const int* byName = reinterpret_cast<const int*>(base + in.offset());
+        if (!in.skip(static_cast<size_t>(nameCount) * sizeof(int))) return false;
+        if (!names.attachImage(in, base)) return false;
+
+        ids.adopt(idColumn, static_cast<size_t>(count));
+        flags.adopt(flagColumn, static_cast<size_t>(count));
+        profiles.adopt(profileColumn, static_cast<size_t>(count));
+        for (int g = 0; g < gameCount; g++) {
+            elos[g].adopt(eloColumns[g], static_cast<size_t>(count));
+            glicko[g].adopt(glickoColumns[g], static_cast<size_t>(count));
+        }
+        for (int i = 0; i < count; i++) {
+            states[states.append()].store(PlayerState::initial());
+            attributes.append(MatchAttributes().pack());
+            queuedAt.append(0);
+        }
+
+        imageIds = slots;
+        imageIdMask = static_cast<size_t>(slotCount) - 1;
+        imageByName = byName;
+        imageNameCount = nameCount;
+        imageCount = count;
+        image.swap(file);
+        return true;
+    }
+
+    // Whether the first players are served from a mapped image
+    bool isImageAttached() const {
+        return image.isMapped();
+    }
+};
+
+#endif // PLAYER_STORE_H
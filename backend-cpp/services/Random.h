@@ -0,0 +1,88 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+/**
+ * Random - Small seeded random number generator
+ *
+ * xorshift64* seeded through splitmix64, so nearby seeds (0, 1, 2, ...)
+ * still give unrelated streams. One instance per user; unlike rand() it
+ * has no hidden global state, so the same seed always gives the same
+ * sequence regardless of what else in the process draws numbers.
+ *
+ * Besides uniform integers it draws the distributions the simulator needs:
+ * exponential (arrival gaps, idle time) and normal (skill, match length).
+ *
+ * Time Complexity: O(1) per draw
+ */
+class Random {
+private:
+    uint64_t state;
+
+    static uint64_t splitmix64(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+public:
+    explicit Random(uint64_t seed) {
+        reseed(seed);
+    }
+
+    void reseed(uint64_t seed) {
+        state = splitmix64(seed);
+        if (state == 0) state = 0x9E3779B97F4A7C15ULL;  // xorshift never leaves 0
+    }
+
+    /**
+     * Seed from an environment variable holding a number, or from the
+     * current time if it is unset - for reproducible server runs
+     */
+    static uint64_t seedFromEnvironment(const char* name) {
+        const char* value = getenv(name);
+        if (value && *value) return strtoull(value, nullptr, 10);
+        return static_cast<uint64_t>(time(nullptr));
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // Uniform in [0, bound) (bound > 0)
+    int nextInt(int bound) {
+        return static_cast<int>((next() >> 33) % static_cast<uint64_t>(bound));
+    }
+
+    // Uniform in [low, high]
+    int between(int low, int high) {
+        return low + nextInt(high - low + 1);
+    }
+
+    // Uniform in [0, 1)
+    double nextDouble() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Exponential with the given mean (gaps between Poisson arrivals)
+    double exponential(double mean) {
+        return -mean * std::log(1.0 - nextDouble());
+    }
+
+    // Normal via Box-Muller (one value per call)
+    double normal(double mean, double deviation) {
+        double u1 = 1.0 - nextDouble();
+        double u2 = nextDouble();
+        return mean + deviation * std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+};
+
+#endif // RANDOM_H
@@ -2,9 +2,17 @@
 #define RANKING_SERVICE_H
 
 #include "../ds/AVLTree.h"
-#include "../ds/HashTable.h"
+#include "../ds/FenwickTree.h"
+#include "../ds/Sort.h"
 #include "../models/Player.h"
+#include "../models/Match.h"
+#include "PlayerStore.h"
+#include "GameRegistry.h"
+#include "Glicko2.h"
+#include "SeasonArchive.h"
+#include <atomic>
 #include <cmath>
+#include <climits>
 
 /**
  * RankingService - Manages player rankings per game
@@ -14,27 +22,158 @@
  *   - Generate leaderboards via in-order traversal
  *   - Find closest-ranked player for matchmaking
  * 
- * ELO calculation based on standard K-factor formula.
+ * Trees are held in an array indexed by game ID (see GameRegistry).
+ * Each game's tree is keyed on that game's rating column in PlayerStore
+ * (getElo(index, gameId)), and every rating change goes through here as
+ * remove(old key) / write column / insert(new key), so a tree entry always
+ * carries the player's current rating in its game. Ranking calls take the
+ * player index where the caller already has it (insertRanking,
+ * removeRanking), so they cost no ID lookup.
+ * 
+ * Two rating systems (chosen at startup with setRatingSystem):
+ *   - ELO (default): standard K-factor formula, applied as each result
+ *     is submitted.
+ *   - GLICKO2: results are buffered per game and applied when the rating
+ *     period closes (closeRatingPeriod), in one batch pass per game
+ *     (see Glicko2) followed by one sweep moving the re-rated players in
+ *     the ranking tree. Wins/losses still count immediately.
+ * Either way the game's ELO column holds the rating matchmaking uses.
+ *
+ * DISTRIBUTION:
+ * Beside each tree, a FenwickTree counts the tree's entries per ELO point
+ * (RATING_RANGE buckets from MIN_RATING; ratings outside are counted in
+ * the edge buckets). Every tree insert and remove goes through enter() /
+ * leave(), which keep the two in step, so percentile, count-above,
+ * rating-at-percentile and histogram queries are O(log R) prefix sums
+ * instead of a traversal.
+ *
+ * SEASONS:
+ * Each game's tree is its current season's leaderboard. startSeason()
+ * closes it without per-player tree operations:
+ *   1. the tree is walked once in order into a flat array, which becomes
+ *      the season's SeasonArchive (read-only, queried by rank)
+ *   2. the game's rating column is soft-reset in one pass (SeasonRules:
+ *      every rating pulled toward a target, e.g. half-way to 1000)
+ *   3. the reset is order-preserving, so the array only needs the ties
+ *      it created put back in ID order, and is written back into the tree
+ *      nodes in place (AVLTree::replaceInOrder) - same shape, no allocation
+ *   4. the distribution is rebuilt from the array (FenwickTree::assign)
+ * O(n + p + R) for n ranked players and p players, plus sorting the ties
+ * the reset creates.
+ *
+ * LEADERBOARD VERSIONS:
+ * Every change to a game's tree, or to the win/loss counts a leaderboard
+ * shows, bumps that game's version (getLeaderboardVersion). Changes happen
+ * under the game's shard lock; the version is atomic, so readers can tell
+ * whether a rendered leaderboard is still current without the lock
+ * (see LeaderboardCache). Win/loss counts are a player's totals over all
+ * games, so a result also bumps every other game's version, after the
+ * counts have changed (those boards render under their own shard locks).
  */
 class RankingService {
+public:
+    enum RatingSystem {
+        ELO = 0,
+        GLICKO2 = 1
+    };
+    
+    // Rating range tracked by the distributions, one bucket per ELO point
+    static const int MIN_RATING = 0;
+    static const int RATING_RANGE = 4096;
+    
+    /**
+     * Soft reset applied to every rating when a season starts: the rating
+     * keeps keepPercent of its distance from target (default: half-way to
+     * 1000, so 1400 -> 1200 and 700 -> 850). Order-preserving for
+     * 0 <= keepPercent <= 100.
+     */
+    struct SeasonRules {
+        int target;
+        int keepPercent;
+        
+        SeasonRules() : target(1000), keepPercent(50) {}
+        SeasonRules(int pullTarget, int keep)
+            : target(pullTarget), keepPercent(keep < 0 ? 0 : keep > 100 ? 100 : keep) {}
+        
+        int apply(int elo) const {
+            return target + static_cast<int>(static_cast<long long>(elo - target) * keepPercent / 100);
+        }
+    };
+
 private:
-    // One AVL tree per game for rankings
-    AVLTree<PlayerELO> pingpongRankings;
-    AVLTree<PlayerELO> snakeRankings;
-    AVLTree<PlayerELO> tankRankings;
+    // One AVL tree per game for rankings, indexed by game ID
+    AVLTree<PlayerELO> rankings[GameRegistry::MAX_GAMES];
     
-    // Reference to player storage
-    HashTable<int, Player>* playerStorage;
+    // Entries of each game's tree counted per rating bucket
+    FenwickTree* distributions[GameRegistry::MAX_GAMES];
+    
+    // Reference to player storage and game registry
+    PlayerStore* players;
+    const GameRegistry* games;
     
     // K-factor for ELO calculation
     static const int K_FACTOR = 32;
+
+    // Glicko-2: results buffered per game, and the number of the open period
+    RatingSystem ratingSystem;
+    Glicko2 periods[GameRegistry::MAX_GAMES];
+    int ratingPeriod;
+    
+    // Leaderboard version per game, bumped on every rank-affecting change
+    std::atomic<long long> versions[GameRegistry::MAX_GAMES];
+    
+    // Current season per game (from 1) and the archives of finished ones
+    int seasons[GameRegistry::MAX_GAMES];
+    SeasonArchive** archives[GameRegistry::MAX_GAMES];
+    int archiveCounts[GameRegistry::MAX_GAMES];
+    int archiveCapacities[GameRegistry::MAX_GAMES];
+    
+    void addArchive(int gameId, SeasonArchive* archive) {
+        if (archiveCounts[gameId] == archiveCapacities[gameId]) {
+            int capacity = archiveCapacities[gameId] == 0 ? 4 : archiveCapacities[gameId] * 2;
+            SeasonArchive** grown = new SeasonArchive*[capacity];
+            for (int i = 0; i < archiveCounts[gameId]; i++) grown[i] = archives[gameId][i];
+            delete[] archives[gameId];
+            archives[gameId] = grown;
+            archiveCapacities[gameId] = capacity;
+        }
+        archives[gameId][archiveCounts[gameId]++] = archive;
+    }
+    
+    void touch(int gameId) {
+        versions[gameId].fetch_add(1, std::memory_order_release);
+    }
+    
+    // A result changed win/loss counts, which every game's board shows
+    void touchOtherGames(int gameId) {
+        for (int g = 0; g < games->size(); g++) {
+            if (g != gameId) touch(g);
+        }
+    }
+    
+    static int bucketOf(int elo) {
+        int bucket = elo - MIN_RATING;
+        return bucket < 0 ? 0 : bucket >= RATING_RANGE ? RATING_RANGE - 1 : bucket;
+    }
+    
+    // Insert into a game's tree and count the entry (duplicates are ignored)
+    void enter(int gameId, const PlayerELO& entry) {
+        AVLTree<PlayerELO>& tree = rankings[gameId];
+        size_t before = tree.size();
+        tree.insert(entry);
+        if (tree.size() > before) distributions[gameId]->add(bucketOf(entry.elo), 1);
+    }
+    
+    // Remove from a game's tree and uncount the entry
+    bool leave(int gameId, const PlayerELO& entry) {
+        if (!rankings[gameId].remove(entry)) return false;
+        distributions[gameId]->add(bucketOf(entry.elo), -1);
+        return true;
+    }
     
     // Get the appropriate tree for a game
-    AVLTree<PlayerELO>* getTreeForGame(const char* gameName) {
-        if (strcmp(gameName, "pingpong") == 0) return &pingpongRankings;
-        if (strcmp(gameName, "snake") == 0) return &snakeRankings;
-        if (strcmp(gameName, "tank") == 0) return &tankRankings;
-        return nullptr;
+    AVLTree<PlayerELO>* getTreeForGame(int gameId) {
+        return games->isValid(gameId) ? &rankings[gameId] : nullptr;
     }
     
     // Calculate expected score (probability of winning)
@@ -47,32 +186,124 @@ private:
         return currentElo + static_cast<int>(K_FACTOR * (actualScore - expectedScore));
     }
 
+    // Change one player's ELO in a game and move their tree entry with it
+    void applyDelta(int index, int playerId, int delta, int gameId) {
+        int oldElo = players->getElo(index, gameId);
+        leave(gameId, PlayerELO(oldElo, playerId));
+        players->setElo(index, gameId, oldElo + delta);
+        enter(gameId, PlayerELO(oldElo + delta, playerId));
+    }
+
 public:
-    RankingService(HashTable<int, Player>* storage) : playerStorage(storage) {}
+    RankingService(PlayerStore* store, const GameRegistry* registry) 
+        : players(store), games(registry), ratingSystem(ELO), ratingPeriod(0) {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            versions[g].store(0);
+            distributions[g] = new FenwickTree(RATING_RANGE);
+            seasons[g] = 1;
+            archives[g] = nullptr;
+            archiveCounts[g] = 0;
+            archiveCapacities[g] = 0;
+        }
+    }
+    
+    ~RankingService() {
+        for (int g = 0; g < GameRegistry::MAX_GAMES; g++) {
+            delete distributions[g];
+            for (int i = 0; i < archiveCounts[g]; i++) delete archives[g][i];
+            delete[] archives[g];
+        }
+    }
+    
+    RankingService(const RankingService&) = delete;
+    RankingService& operator=(const RankingService&) = delete;
+
+    /**
+     * Select the rating system (set before any results are submitted)
+     */
+    void setRatingSystem(RatingSystem system) {
+        ratingSystem = system;
+    }
+
+    RatingSystem getRatingSystem() const {
+        return ratingSystem;
+    }
     
     /**
      * Add player to a game's ranking tree
      */
-    void addPlayerToRanking(int playerId, const char* gameName) {
-        Player* player = playerStorage->get(playerId);
-        if (!player) return;
+    void addPlayerToRanking(int playerId, int gameId) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return;
+        insertRanking(index, gameId);
+    }
+    
+    /**
+     * Add a player (by index) to a game's ranking tree at their rating
+     * in that game - O(log n), no ID lookup
+     */
+    void insertRanking(int index, int gameId) {
+        if (!games->isValid(gameId)) return;
+        enter(gameId, PlayerELO(players->getElo(index, gameId), players->getId(index)));
+        touch(gameId);
+    }
+    
+    /**
+     * Fill a game's empty tree with many players (by index) at once
+     *
+     * Entries are read from the game's rating column and sorted only if
+     * they are not already in key order (a snapshot's ranked list is);
+     * then the tree is built balanced in one pass (AVLTree::assignSorted)
+     * and the distribution in one pass (FenwickTree::assign). Only the
+     * game's own tree, distribution and version are written, so different
+     * games can be built on different threads at once.
+     *
+     * Time Complexity: O(n + R) for input in key order, O(n log n + R)
+     * otherwise
+     *
+     * @return false for an invalid game or a tree that is not empty
+     */
+    bool buildRanking(const int* indexes, int count, int gameId) {
+        if (!games->isValid(gameId) || !rankings[gameId].isEmpty()) return false;
+        PlayerELO* entries = new PlayerELO[count > 0 ? count : 1];
+        bool ordered = true;
+        for (int i = 0; i < count; i++) {
+            entries[i] = PlayerELO(players->getElo(indexes[i], gameId), players->getId(indexes[i]));
+            if (i > 0 && !(entries[i - 1] < entries[i])) ordered = false;
+        }
+        if (!ordered) {
+            PlayerELO* scratch = new PlayerELO[count];
+            mergeSort(entries, scratch, static_cast<size_t>(count),
+                      [](const PlayerELO& a, const PlayerELO& b) { return a < b; });
+            delete[] scratch;
+        }
         
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
-        if (!tree) return;
+        // A tree holds each key once
+        int unique = 0;
+        for (int i = 0; i < count; i++) {
+            if (unique == 0 || entries[unique - 1] < entries[i]) entries[unique++] = entries[i];
+        }
+        int* counts = new int[RATING_RANGE]();
+        for (int i = 0; i < unique; i++) counts[bucketOf(entries[i].elo)]++;
+        rankings[gameId].assignSorted(entries, static_cast<size_t>(unique));
+        distributions[gameId]->assign(counts);
+        delete[] counts;
+        delete[] entries;
         
-        PlayerELO entry(player->elo, playerId);
-        tree->insert(entry);
+        touch(gameId);
+        return true;
     }
     
     /**
-     * Remove player from a game's ranking tree
+     * Remove a player (by index) from a game's ranking tree - O(log n)
+     *
+     * @return false if they were not in it
      */
-    void removePlayerFromRanking(int playerId, int elo, const char* gameName) {
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
-        if (!tree) return;
-        
-        PlayerELO entry(elo, playerId);
-        tree->remove(entry);
+    bool removeRanking(int index, int gameId) {
+        if (!games->isValid(gameId) ||
+            !leave(gameId, PlayerELO(players->getElo(index, gameId), players->getId(index)))) return false;
+        touch(gameId);
+        return true;
     }
     
     /**
@@ -80,47 +311,163 @@ public:
      * 
      * @param winnerId ID of the winning player
      * @param loserId ID of the losing player
-     * @param gameName Name of the game
+     * @param gameId ID of the game
      */
-    void updateRankings(int winnerId, int loserId, const char* gameName) {
-        Player* winner = playerStorage->get(winnerId);
-        Player* loser = playerStorage->get(loserId);
+    void updateRankings(int winnerId, int loserId, int gameId) {
+        int winnerIndex = players->indexOf(winnerId);
+        int loserIndex = players->indexOf(loserId);
         
-        if (!winner || !loser) return;
+        if (winnerIndex == PlayerStore::NO_PLAYER || loserIndex == PlayerStore::NO_PLAYER) return;
         
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
         if (!tree) return;
         
+        touch(gameId);
+        if (ratingSystem == GLICKO2) {
+            periods[gameId].record(winnerIndex, loserIndex);
+            players->getProfile(winnerIndex).wins++;
+            players->getProfile(loserIndex).losses++;
+            touchOtherGames(gameId);
+            return;
+        }
+        
         // Store old ELOs for removal
-        int winnerOldElo = winner->elo;
-        int loserOldElo = loser->elo;
+        int winnerOldElo = players->getElo(winnerIndex, gameId);
+        int loserOldElo = players->getElo(loserIndex, gameId);
         
         // Remove old entries from AVL tree
         PlayerELO winnerOld(winnerOldElo, winnerId);
         PlayerELO loserOld(loserOldElo, loserId);
-        tree->remove(winnerOld);
-        tree->remove(loserOld);
+        leave(gameId, winnerOld);
+        leave(gameId, loserOld);
         
         // Calculate new ELOs
         float winnerExpected = calculateExpectedScore(winnerOldElo, loserOldElo);
-        float loserExpected = calculateExpectedScore(loserOldElo, winnerOldElo);
+        float loserExpected = 1.0f - winnerExpected;
         
-        winner->elo = calculateNewElo(winnerOldElo, winnerExpected, 1.0f);
-        loser->elo = calculateNewElo(loserOldElo, loserExpected, 0.0f);
+        int winnerNewElo = calculateNewElo(winnerOldElo, winnerExpected, 1.0f);
+        int loserNewElo = calculateNewElo(loserOldElo, loserExpected, 0.0f);
+        players->setElo(winnerIndex, gameId, winnerNewElo);
+        players->setElo(loserIndex, gameId, loserNewElo);
         
-        // Update win/loss counts
-        winner->wins++;
-        loser->losses++;
+        // Update win/loss counts (cold profile)
+        players->getProfile(winnerIndex).wins++;
+        players->getProfile(loserIndex).losses++;
+        touchOtherGames(gameId);
         
         // Reinsert with new ELOs
-        PlayerELO winnerNew(winner->elo, winnerId);
-        PlayerELO loserNew(loser->elo, loserId);
-        tree->insert(winnerNew);
-        tree->insert(loserNew);
+        PlayerELO winnerNew(winnerNewElo, winnerId);
+        PlayerELO loserNew(loserNewElo, loserId);
+        enter(gameId, winnerNew);
+        enter(gameId, loserNew);
+    }
+    
+    /**
+     * Update rankings after a team match
+     * 
+     * Expected scores come from the two teams' average ELOs; every member
+     * of a team gets the same change, as if the team were one player.
+     * 
+     * @param winnerIds Members of the winning team
+     * @param loserIds Members of the losing team
+     * @param teamSize Players per team
+     * @param gameId ID of the game
+     */
+    void updateTeamRankings(const int* winnerIds, const int* loserIds, int teamSize, int gameId) {
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
+        if (!tree || teamSize <= 0) return;
+        
+        int winnerIndexes[Match::MAX_TEAM_SIZE];
+        int loserIndexes[Match::MAX_TEAM_SIZE];
+        long long winnerTotal = 0, loserTotal = 0;
+        for (int i = 0; i < teamSize; i++) {
+            winnerIndexes[i] = players->indexOf(winnerIds[i]);
+            loserIndexes[i] = players->indexOf(loserIds[i]);
+            if (winnerIndexes[i] == PlayerStore::NO_PLAYER || loserIndexes[i] == PlayerStore::NO_PLAYER) return;
+            winnerTotal += players->getElo(winnerIndexes[i], gameId);
+            loserTotal += players->getElo(loserIndexes[i], gameId);
+        }
+        touch(gameId);
+        
+        if (ratingSystem == GLICKO2) {
+            // Every winner against every loser, weighted to one game each
+            for (int i = 0; i < teamSize; i++) {
+                for (int j = 0; j < teamSize; j++) {
+                    periods[gameId].record(winnerIndexes[i], loserIndexes[j], 1.0 / teamSize);
+                }
+                players->getProfile(winnerIndexes[i]).wins++;
+                players->getProfile(loserIndexes[i]).losses++;
+            }
+            touchOtherGames(gameId);
+            return;
+        }
+        int winnerAverage = static_cast<int>(winnerTotal / teamSize);
+        int loserAverage = static_cast<int>(loserTotal / teamSize);
+        
+        float winnerExpected = calculateExpectedScore(winnerAverage, loserAverage);
+        int winnerDelta = calculateNewElo(winnerAverage, winnerExpected, 1.0f) - winnerAverage;
+        int loserDelta = calculateNewElo(loserAverage, 1.0f - winnerExpected, 0.0f) - loserAverage;
         
-        // Update player storage
-        playerStorage->update(winnerId, *winner);
-        playerStorage->update(loserId, *loser);
+        for (int i = 0; i < teamSize; i++) {
+            applyDelta(winnerIndexes[i], winnerIds[i], winnerDelta, gameId);
+            players->getProfile(winnerIndexes[i]).wins++;
+            applyDelta(loserIndexes[i], loserIds[i], loserDelta, gameId);
+            players->getProfile(loserIndexes[i]).losses++;
+        }
+        touchOtherGames(gameId);
+    }
+    
+    /**
+     * Re-rate a game's players from the results buffered this period (GLICKO2)
+     *
+     * One batch pass over the results (Glicko2::close), then one sweep
+     * moving every re-rated player that is in the game's ranking tree to
+     * their new ELO. Players out of the tree (in a match) are re-added at
+     * their new ELO when their match ends. changed(playerIndex, oldElo) is
+     * called for every player whose ELO in this game moved, so the game's
+     * other indexes can be re-keyed. Call for every game, then
+     * finishRatingPeriod().
+     *
+     * Time Complexity: O(r + p log n) for r results and p players re-rated
+     *
+     * @return Number of players re-rated
+     */
+    template <typename Changed>
+    int closeRatingPeriod(int gameId, Changed changed) {
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
+        if (!tree) return 0;
+        touch(gameId);
+        return periods[gameId].close(players, gameId, ratingPeriod, [&](int index, int oldElo) {
+            int playerId = players->getId(index);
+            if (leave(gameId, PlayerELO(oldElo, playerId))) {
+                enter(gameId, PlayerELO(players->getElo(index, gameId), playerId));
+            }
+            changed(index, oldElo);
+        });
+    }
+    
+    // Start the next rating period (after closing every game's)
+    void finishRatingPeriod() {
+        ratingPeriod++;
+    }
+    
+    int getRatingPeriod() const {
+        return ratingPeriod;
+    }
+    
+    /**
+     * Leaderboard version of a game - O(1), safe without the shard lock
+     *
+     * Equal versions mean an identical leaderboard; read it again under
+     * the shard lock before rendering to get the version rendered.
+     */
+    long long getLeaderboardVersion(int gameId) const {
+        return games->isValid(gameId) ? versions[gameId].load(std::memory_order_acquire) : 0;
+    }
+    
+    // Results waiting for a game's rating period to close
+    int getPendingResults(int gameId) const {
+        return games->isValid(gameId) ? periods[gameId].pending() : 0;
     }
     
     /**
@@ -128,14 +475,14 @@ public:
      * 
      * Uses reverse in-order traversal to get players sorted by ELO descending.
      * 
-     * @param gameName Name of the game
+     * @param gameId ID of the game
      * @param outPlayers Array to store player IDs
      * @param outElos Array to store player ELOs
      * @param maxCount Maximum number of entries to return
      * @return Actual number of entries returned
      */
-    int getLeaderboard(const char* gameName, int* outPlayerIds, int* outElos, int maxCount) {
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
+    int getLeaderboard(int gameId, int* outPlayerIds, int* outElos, int maxCount) {
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
         if (!tree) return 0;
         
         struct LeaderboardData {
@@ -165,27 +512,253 @@ public:
      * Uses AVL tree's findClosest for O(log n) performance.
      * 
      * @param playerId Player looking for a match
-     * @param gameName Game to match for
+     * @param gameId Game to match for
      * @return ID of closest-ranked opponent, or -1 if none found
      */
-    int findClosestOpponent(int playerId, const char* gameName) {
-        Player* player = playerStorage->get(playerId);
-        if (!player) return -1;
+    int findClosestOpponent(int playerId, int gameId) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return -1;
         
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
         if (!tree || tree->size() < 2) return -1;
         
-        PlayerELO target(player->elo, playerId);
+        PlayerELO target(players->getElo(index, gameId), playerId);
         PlayerELO* closest = tree->findClosestExcluding(target, target);
         
         return closest ? closest->playerId : -1;
     }
     
+    /**
+     * Find the closest-ranked player within an ELO window
+     * 
+     * Range query on the ranking tree: only players with
+     * |elo - player's elo| <= window are visited.
+     * 
+     * @param accept Filter called with each candidate's PlayerID;
+     *               return true if the candidate may be matched
+     * @return PlayerID of the closest accepted player, or -1
+     * 
+     * Time Complexity: O(log n + k) for k players in the window
+     */
+    template <typename Accept>
+    int findClosestInWindow(int playerId, int gameId, int window, Accept accept) {
+        int index = players->indexOf(playerId);
+        if (index == PlayerStore::NO_PLAYER) return -1;
+        
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
+        if (!tree || tree->size() < 2) return -1;
+        
+        int elo = players->getElo(index, gameId);
+        PlayerELO low(elo - window, INT_MIN);
+        PlayerELO high(elo + window, INT_MAX);
+        
+        int bestId = -1;
+        int bestDiff = window + 1;
+        tree->rangeTraversal(low, high, [&](const PlayerELO& entry) {
+            int diff = entry.elo > elo ? entry.elo - elo : elo - entry.elo;
+            if (entry.elo > elo && diff >= bestDiff) return false;  // Only farther from here on
+            if (entry.playerId != playerId && diff < bestDiff && accept(entry.playerId)) {
+                bestDiff = diff;
+                bestId = entry.playerId;
+            }
+            return true;
+        });
+        return bestId;
+    }
+    
+    /**
+     * Ranked players in a game rated strictly above an ELO - O(log R)
+     */
+    long long getCountAbove(int gameId, int elo) const {
+        if (!games->isValid(gameId)) return 0;
+        if (elo < MIN_RATING) return distributions[gameId]->total();
+        return distributions[gameId]->countAtOrAbove(bucketOf(elo) + 1);
+    }
+    
+    /**
+     * Percentile of an ELO in a game: share of ranked players rated below
+     * it, 0-100 - O(log R)
+     */
+    double getPercentile(int gameId, int elo) const {
+        if (!games->isValid(gameId)) return 0.0;
+        const FenwickTree* distribution = distributions[gameId];
+        if (distribution->total() == 0) return 0.0;
+        return 100.0 * distribution->countBelow(bucketOf(elo)) / distribution->total();
+    }
+    
+    /**
+     * "Top X%" for an ELO in a game: share of ranked players rated at or
+     * above it, 0-100 - O(log R)
+     */
+    double getTopPercent(int gameId, int elo) const {
+        if (!games->isValid(gameId)) return 100.0;
+        const FenwickTree* distribution = distributions[gameId];
+        if (distribution->total() == 0) return 100.0;
+        return 100.0 * distribution->countAtOrAbove(bucketOf(elo)) / distribution->total();
+    }
+    
+    /**
+     * Lowest ELO at or above which the top (100 - percentile)% sit, i.e.
+     * the rating at a percentile (0-100) - O(log R)
+     *
+     * @return MIN_RATING if the game has no ranked players
+     */
+    int getEloAtPercentile(int gameId, double percentile) const {
+        if (!games->isValid(gameId)) return MIN_RATING;
+        const FenwickTree* distribution = distributions[gameId];
+        long long total = distribution->total();
+        if (total == 0) return MIN_RATING;
+        long long rank = static_cast<long long>(std::ceil(percentile / 100.0 * total));
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+        return MIN_RATING + distribution->findByRank(rank);
+    }
+    
+    /**
+     * Histogram of a game's ranked ratings: outCounts[i] = players rated
+     * in [from + i * width, from + (i + 1) * width) - O(buckets * log R)
+     */
+    void getHistogram(int gameId, int from, int width, int buckets, long long* outCounts) const {
+        for (int i = 0; i < buckets; i++) outCounts[i] = 0;
+        if (!games->isValid(gameId) || width <= 0) return;
+        const FenwickTree* distribution = distributions[gameId];
+        long long below = distribution->countBelow(bucketOf(from));
+        for (int i = 0; i < buckets; i++) {
+            long long upTo = distribution->countBelow(bucketOf(from + (i + 1) * width - 1) + 1);
+            outCounts[i] = upTo - below;
+            below = upTo;
+        }
+    }
+    
+    /**
+     * Close a game's current season and start the next one
+     *
+     * Archives the standings, soft-resets every player's rating in the
+     * game and re-keys the tree and distribution in place (see SEASONS).
+     * Players out of the tree (in a match) rejoin it at their reset
+     * rating. The caller re-keys its own ELO-keyed indexes afterwards.
+     *
+     * Time Complexity: O(n + p + R) for n ranked players and p players,
+     * plus sorting the ties the reset creates
+     *
+     * @return The new season number, or -1 for an invalid game
+     */
+    int startSeason(int gameId, const SeasonRules& rules) {
+        if (!games->isValid(gameId)) return -1;
+        AVLTree<PlayerELO>& tree = rankings[gameId];
+        int count = static_cast<int>(tree.size());
+        
+        // 1. Standings, lowest first
+        PlayerELO* entries = new PlayerELO[count > 0 ? count : 1];
+        int filled = 0;
+        tree.inOrderTraversal([entries, &filled](const PlayerELO& entry) {
+            entries[filled++] = entry;
+        });
+        addArchive(gameId, new SeasonArchive(seasons[gameId], entries, count));
+        
+        // 2. Soft reset of the game's rating column
+        int playerCount = players->size();
+        for (int index = 0; index < playerCount; index++) {
+            int elo = rules.apply(players->getElo(index, gameId));
+            players->setElo(index, gameId, elo);
+            players->getGlicko(index, gameId).rating = elo;
+        }
+        
+        // 3. Same map over the tree's keys; only runs of equal new ELO can
+        //    be out of ID order (ratings it merged), and only those are sorted
+        for (int i = 0; i < count; i++) entries[i].elo = rules.apply(entries[i].elo);
+        PlayerELO* scratch = nullptr;
+        for (int start = 0; start < count; ) {
+            int end = start + 1;
+            bool ordered = true;
+            while (end < count && entries[end].elo == entries[start].elo) {
+                if (entries[end].playerId < entries[end - 1].playerId) ordered = false;
+                end++;
+            }
+            if (!ordered) {
+                if (!scratch) scratch = new PlayerELO[count];
+                mergeSort(entries + start, scratch, static_cast<size_t>(end - start),
+                          [](const PlayerELO& a, const PlayerELO& b) { return a < b; });
+            }
+            start = end;
+        }
+        delete[] scratch;
+        tree.replaceInOrder(entries);
+        
+        // 4. Distribution from the new keys
+        int* counts = new int[RATING_RANGE]();
+        for (int i = 0; i < count; i++) counts[bucketOf(entries[i].elo)]++;
+        distributions[gameId]->assign(counts);
+        delete[] counts;
+        delete[] entries;
+        
+        touch(gameId);
+        return ++seasons[gameId];
+    }
+    
+    int getSeason(int gameId) const {
+        return games->isValid(gameId) ? seasons[gameId] : 0;
+    }
+    
+    // Number of finished seasons archived for a game
+    int getArchivedSeasonCount(int gameId) const {
+        return games->isValid(gameId) ? archiveCounts[gameId] : 0;
+    }
+    
+    /**
+     * Final standings of a finished season (1 .. getSeason() - 1)
+     *
+     * @return nullptr if the season is not archived
+     */
+    const SeasonArchive* getArchivedSeason(int gameId, int season) const {
+        if (!games->isValid(gameId) || season < 1 || season > archiveCounts[gameId]) return nullptr;
+        return archives[gameId][season - 1];
+    }
+    
+    // ========== PERSISTENCE ==========
+    
+    // Visit a game's ranked entries, lowest (ELO, ID) first - O(n)
+    template <typename Visit>
+    void forEachRanked(int gameId, Visit visit) {
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
+        if (tree) tree->inOrderTraversal(visit);
+    }
+    
+    // One result buffered in a game's open rating period (player indexes)
+    void getPendingResult(int gameId, int i, int& winnerIndex, int& loserIndex, double& weight) const {
+        periods[gameId].getResult(i, winnerIndex, loserIndex, weight);
+    }
+    
+    // Put back a buffered result taken from a snapshot
+    void restorePendingResult(int gameId, int winnerIndex, int loserIndex, double weight) {
+        if (games->isValid(gameId)) periods[gameId].record(winnerIndex, loserIndex, weight);
+    }
+    
+    void setRatingPeriod(int period) {
+        ratingPeriod = period;
+    }
+    
+    /**
+     * Restore a game's season counter and take ownership of an archive
+     * of a finished season (in season order)
+     */
+    void restoreSeason(int gameId, int season) {
+        if (games->isValid(gameId)) seasons[gameId] = season;
+    }
+    
+    void restoreArchivedSeason(int gameId, SeasonArchive* archive) {
+        if (!games->isValid(gameId)) {
+            delete archive;
+            return;
+        }
+        addArchive(gameId, archive);
+    }
+    
     /**
      * Get ranking tree size for a game
      */
-    size_t getRankingCount(const char* gameName) {
-        AVLTree<PlayerELO>* tree = getTreeForGame(gameName);
+    size_t getRankingCount(int gameId) {
+        AVLTree<PlayerELO>* tree = getTreeForGame(gameId);
         return tree ? tree->size() : 0;
     }
 };
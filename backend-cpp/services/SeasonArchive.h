@@ -0,0 +1,95 @@
+#ifndef SEASON_ARCHIVE_H
+#define SEASON_ARCHIVE_H
+
+#include "../models/Player.h"
+#include <cstddef>
+
+/**
+ * SeasonArchive - One game's final standings for a finished season
+ *
+ * Read-only once built: two flat arrays (player IDs and ELOs) in rank
+ * order, best first, copied out of the ranking tree when the season
+ * closes. Rank k is position k - 1, so any page of the standings is a
+ * straight copy, and the rank a rating would have held is one binary
+ * search. 8 bytes per ranked player; no tree nodes or pointers kept.
+ *
+ * Time Complexity:
+ *   - getByRank(): O(1)
+ *   - getPage(): O(page size)
+ *   - countAbove(): O(log n)
+ */
+class SeasonArchive {
+private:
+    int season;
+    int count;
+    int* playerIds;  // Rank order (highest ELO first)
+    int* elos;
+
+public:
+    /**
+     * Build from the tree's entries in ascending order
+     *
+     * @param ascending Entries sorted by (ELO, player ID), lowest first
+     */
+    SeasonArchive(int seasonNumber, const PlayerELO* ascending, int entryCount)
+        : season(seasonNumber), count(entryCount < 0 ? 0 : entryCount),
+          playerIds(new int[count > 0 ? count : 1]), elos(new int[count > 0 ? count : 1]) {
+        for (int i = 0; i < count; i++) {
+            const PlayerELO& entry = ascending[count - 1 - i];
+            playerIds[i] = entry.playerId;
+            elos[i] = entry.elo;
+        }
+    }
+
+    ~SeasonArchive() {
+        delete[] playerIds;
+        delete[] elos;
+    }
+
+    SeasonArchive(const SeasonArchive&) = delete;
+    SeasonArchive& operator=(const SeasonArchive&) = delete;
+
+    int getSeason() const { return season; }
+
+    int size() const { return count; }
+
+    /**
+     * Player and final ELO at a rank (1 = top)
+     *
+     * @return false if the rank is out of range
+     */
+    bool getByRank(int rank, int& outPlayerId, int& outElo) const {
+        if (rank < 1 || rank > count) return false;
+        outPlayerId = playerIds[rank - 1];
+        outElo = elos[rank - 1];
+        return true;
+    }
+
+    /**
+     * Copy up to maxCount entries starting at a rank (1 = top)
+     *
+     * @return Number of entries copied
+     */
+    int getPage(int fromRank, int maxCount, int* outPlayerIds, int* outElos) const {
+        if (fromRank < 1) fromRank = 1;
+        int copied = 0;
+        for (int i = fromRank - 1; i < count && copied < maxCount; i++, copied++) {
+            outPlayerIds[copied] = playerIds[i];
+            outElos[copied] = elos[i];
+        }
+        return copied;
+    }
+
+    // Players who finished rated strictly above an ELO (that ELO's rank - 1)
+    int countAbove(int elo) const {
+        int low = 0, high = count;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (elos[mid] > elo) low = mid + 1;
+            else high = mid;
+        }
+        return low;
+    }
+};
+
+#endif // SEASON_ARCHIVE_H
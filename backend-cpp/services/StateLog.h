@@ -0,0 +1,427 @@
+#ifndef STATE_LOG_H
+#define STATE_LOG_H
+
+#include "../ds/ByteBuffer.h"
+#include "../models/Match.h"
+#include "Clock.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <io.h>
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * StateLog - Binary write-ahead log of state-changing operations
+ *
+ * Every operation that changes durable state appends one record while it
+ * still holds the lock that ordered it (the shard lock, or every shard
+ * lock), so the log order is an order the operations really happened in:
+ *
+ *   PLAYER   player created (ID, name, starting ELO, bot flag)
+ *   QUEUE    player queued for a game (with latency bucket / device)
+ *   PARTY    party queued for a game (members, leader first)
+ *   LEAVE    player (or their party) left a game's queue
+ *   MATCH    match created (ID, game, teams, creation time)
+ *   RESULT   match result submitted (match ID, winner)
+ *   PERIOD   Glicko-2 rating period closed
+ *   SEASON   season rolled over for a game (soft-reset rules)
+ *
+ * Replaying the records in order through the same services reproduces the
+ * state: ratings are recomputed by the same code from the same inputs, so
+ * results are logged as (match, winner), not as rating changes. Matches
+ * are the exception - which players a tick pairs depends on timing, so
+ * MATCH records carry the pairing itself.
+ *
+ * FORMAT:
+ * Each record is [payload length][CRC-32 of payload][payload], payload
+ * starting with the record type. A crash can leave a torn record at the
+ * end of the file; replay stops at the first record whose length or
+ * checksum does not match.
+ *
+ * GROUP COMMIT:
+ * append only encodes the record into an in-memory batch (no I/O under
+ * the caller's lock). One flusher thread writes the whole batch and syncs
+ * the file once, so every record appended while the previous sync was in
+ * flight shares the next one. The batch is committed every commit
+ * interval (default 2ms), or at once when someone waits in sync() -
+ * request handlers call sync() before answering, so an acknowledged
+ * operation is on disk, while tick threads never wait for the disk.
+ *
+ * SEGMENTS:
+ * The log lives in <dir>/wal-<generation>.log. rotate() starts the next
+ * generation's file; Persistence rotates when it takes a snapshot, so a
+ * snapshot of generation G plus wal-G.log (and any later segment) is the
+ * whole state, and older segments can be deleted.
+ *
+ * Time Complexity:
+ *   - append: O(record size), one short lock
+ *   - commit: one write and one sync per batch
+ */
+class StateLog {
+public:
+    enum RecordType {
+        PLAYER = 1,
+        QUEUE = 2,
+        PARTY = 3,
+        LEAVE = 4,
+        MATCH = 5,
+        RESULT = 6,
+        PERIOD = 7,
+        SEASON = 8
+    };
+
+    static const long long DEFAULT_COMMIT_INTERVAL_NANOS = 2 * Clock::NANOS_PER_MILLI;
+
+private:
+    static const size_t FRAME_HEADER = 2 * sizeof(unsigned);
+
+    std::string directory;
+    FILE* file;
+    long long generation;
+
+    // Batch being filled by append(), guarded by batchMutex
+    ByteWriter pending;
+    long long appended;      // Records appended so far
+    long long committed;     // Records on disk (written and synced)
+    bool commitRequested;
+    bool stopRequested;
+    std::mutex batchMutex;
+    std::condition_variable wakeFlusher;
+    std::condition_variable wakeWaiters;
+
+    // Held while writing to the file (flusher, rotate); taken before batchMutex
+    std::mutex fileMutex;
+    ByteWriter writing;
+
+    std::thread flusher;
+    long long commitIntervalNanos;
+
+    // Counters
+    std::atomic<long long> segmentBytes;
+    std::atomic<long long> commits;
+
+    // Encode one record into the batch: encode(writer) writes the payload after the type
+    template <typename Encode>
+    void append(RecordType type, Encode encode) {
+        if (!file) return;
+        std::lock_guard<std::mutex> guard(batchMutex);
+        size_t start = pending.size();
+        pending.putUnsigned(0);
+        pending.putUnsigned(0);
+        pending.putByte(static_cast<unsigned char>(type));
+        encode(pending);
+        size_t payload = pending.size() - start - FRAME_HEADER;
+        pending.patchUnsigned(start, static_cast<unsigned>(payload));
+        pending.patchUnsigned(start + sizeof(unsigned), crc32(pending.bytes() + start + FRAME_HEADER, payload));
+        appended++;
+    }
+
+    // Write the current batch and sync it (caller holds fileMutex)
+    void commitBatch() {
+        long long upTo;
+        {
+            std::lock_guard<std::mutex> guard(batchMutex);
+            writing.swap(pending);
+            pending.clear();
+            commitRequested = false;
+            upTo = appended;
+        }
+        if (writing.size() > 0 && file) {
+            fwrite(writing.bytes(), 1, writing.size(), file);
+            syncFile(file);
+            segmentBytes.fetch_add(static_cast<long long>(writing.size()), std::memory_order_relaxed);
+            commits.fetch_add(1, std::memory_order_relaxed);
+            writing.clear();
+        }
+        {
+            std::lock_guard<std::mutex> guard(batchMutex);
+            committed = upTo;
+        }
+        wakeWaiters.notify_all();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> wait(batchMutex);
+        while (!stopRequested) {
+            wakeFlusher.wait_for(wait, std::chrono::nanoseconds(commitIntervalNanos),
+                                 [this] { return commitRequested || stopRequested; });
+            if (appended == committed) continue;
+            wait.unlock();
+            {
+                std::lock_guard<std::mutex> io(fileMutex);
+                commitBatch();
+            }
+            wait.lock();
+        }
+    }
+
+public:
+    StateLog()
+        : file(nullptr), generation(0), appended(0), committed(0), commitRequested(false),
+          stopRequested(false), commitIntervalNanos(DEFAULT_COMMIT_INTERVAL_NANOS),
+          segmentBytes(0), commits(0) {}
+
+    ~StateLog() {
+        close();
+    }
+
+    StateLog(const StateLog&) = delete;
+    StateLog& operator=(const StateLog&) = delete;
+
+    // ========== FILES ==========
+
+    // Flush stdio buffers and sync a file's data to disk
+    static void syncFile(FILE* f) {
+        fflush(f);
+#ifdef _WIN32
+        _commit(_fileno(f));
+#else
+        fdatasync(fileno(f));
+#endif
+    }
+
+    // Create a directory if it does not exist (one level)
+    static void makeDirectory(const std::string& path) {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    static std::string segmentPath(const std::string& dir, long long gen) {
+        return dir + "/wal-" + std::to_string(gen) + ".log";
+    }
+
+    /**
+     * Start appending to <dir>/wal-<gen>.log (created if missing) and
+     * start the flusher thread
+     *
+     * @return false if the file cannot be opened
+     */
+    bool open(const std::string& dir, long long gen) {
+        close();
+        makeDirectory(dir);
+        file = fopen(segmentPath(dir, gen).c_str(), "ab");
+        if (!file) return false;
+        directory = dir;
+        generation = gen;
+        segmentBytes.store(ftell(file), std::memory_order_relaxed);
+        stopRequested = false;
+        flusher = std::thread(&StateLog::run, this);
+        return true;
+    }
+
+    // Commit what is pending, stop the flusher and close the file
+    void close() {
+        if (!file) return;
+        {
+            std::lock_guard<std::mutex> guard(batchMutex);
+            stopRequested = true;
+        }
+        wakeFlusher.notify_all();
+        flusher.join();
+        {
+            std::lock_guard<std::mutex> io(fileMutex);
+            commitBatch();
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    /**
+     * Longest a record waits before its batch is committed (when nobody
+     * calls sync); set before open()
+     */
+    void setCommitIntervalNanos(long long nanos) {
+        commitIntervalNanos = nanos < Clock::NANOS_PER_MILLI / 10 ? Clock::NANOS_PER_MILLI / 10 : nanos;
+    }
+
+    /**
+     * Wait until every record appended so far is on disk
+     *
+     * Commits the current batch now rather than at the next interval.
+     * No-op when the log is closed.
+     */
+    void sync() {
+        if (!file) return;
+        std::unique_lock<std::mutex> wait(batchMutex);
+        long long target = appended;
+        if (committed >= target) return;
+        commitRequested = true;
+        wakeFlusher.notify_one();
+        wakeWaiters.wait(wait, [this, target] { return committed >= target; });
+    }
+
+    /**
+     * Commit the current segment and continue in wal-<gen>.log
+     *
+     * The caller holds whatever orders appends (Persistence holds every
+     * shard lock), so the old segment ends exactly where its snapshot
+     * begins.
+     *
+     * @return false if the new file cannot be opened (appends are then dropped)
+     */
+    bool rotate(long long gen) {
+        std::lock_guard<std::mutex> io(fileMutex);
+        if (!file) return false;
+        commitBatch();
+        fclose(file);
+        file = fopen(segmentPath(directory, gen).c_str(), "ab");
+        generation = gen;
+        segmentBytes.store(0, std::memory_order_relaxed);
+        return file != nullptr;
+    }
+
+    long long getGeneration() const { return generation; }
+
+    // Bytes in the current segment (committed)
+    long long getSegmentBytes() const { return segmentBytes.load(std::memory_order_relaxed); }
+
+    // Syncs performed; appended / commits is the group-commit batch size
+    long long getCommitCount() const { return commits.load(std::memory_order_relaxed); }
+
+    long long getAppendedCount() {
+        std::lock_guard<std::mutex> guard(batchMutex);
+        return appended;
+    }
+
+    // ========== RECORDS ==========
+
+    void playerCreated(int playerId, const char* name, int elo, bool bot) {
+        append(PLAYER, [&](ByteWriter& out) {
+            out.putInt(playerId);
+            out.putInt(elo);
+            out.putByte(bot ? 1 : 0);
+            out.putString(name);
+        });
+    }
+
+    void queued(int playerId, int gameId, unsigned char attributes) {
+        append(QUEUE, [&](ByteWriter& out) {
+            out.putInt(playerId);
+            out.putInt(gameId);
+            out.putByte(attributes);
+        });
+    }
+
+    void partyQueued(const int* memberIds, int count, int gameId) {
+        append(PARTY, [&](ByteWriter& out) {
+            out.putInt(gameId);
+            out.putInt(count);
+            for (int i = 0; i < count; i++) out.putInt(memberIds[i]);
+        });
+    }
+
+    void left(int playerId, int gameId) {
+        append(LEAVE, [&](ByteWriter& out) {
+            out.putInt(playerId);
+            out.putInt(gameId);
+        });
+    }
+
+    void matchCreated(const Match& match) {
+        append(MATCH, [&](ByteWriter& out) {
+            out.putInt(match.matchId);
+            out.putInt(match.gameId);
+            out.putLong(match.createdAt);
+            out.putInt(match.teamSize);
+            for (int i = 0; i < match.teamSize; i++) out.putInt(match.team1[i]);
+            for (int i = 0; i < match.teamSize; i++) out.putInt(match.team2[i]);
+        });
+    }
+
+    void resultSubmitted(int matchId, int winnerId) {
+        append(RESULT, [&](ByteWriter& out) {
+            out.putInt(matchId);
+            out.putInt(winnerId);
+        });
+    }
+
+    void ratingPeriodClosed() {
+        append(PERIOD, [](ByteWriter&) {});
+    }
+
+    void seasonStarted(int gameId, int target, int keepPercent) {
+        append(SEASON, [&](ByteWriter& out) {
+            out.putInt(gameId);
+            out.putInt(target);
+            out.putInt(keepPercent);
+        });
+    }
+
+    // MATCH payload (after the type) back into a Match
+    static bool readMatch(ByteReader& in, Match& match) {
+        int matchId = in.getInt();
+        int gameId = in.getInt();
+        long long createdAt = in.getLong();
+        int teamSize = in.getInt();
+        if (!in.ok() || teamSize < 1 || teamSize > Match::MAX_TEAM_SIZE) return false;
+        int team1[Match::MAX_TEAM_SIZE];
+        int team2[Match::MAX_TEAM_SIZE];
+        for (int i = 0; i < teamSize; i++) team1[i] = in.getInt();
+        for (int i = 0; i < teamSize; i++) team2[i] = in.getInt();
+        match = Match(matchId, team1[0], team2[0], gameId, createdAt);
+        if (teamSize > 1) match.setTeams(team1, team2, teamSize);
+        return in.ok();
+    }
+
+    // ========== REPLAY ==========
+
+    /**
+     * Read a segment and call visit(type, reader) for each intact record,
+     * in order; reader is positioned after the type
+     *
+     * @param outValidBytes Length of the intact prefix (a torn tail is ignored)
+     * @return Records visited, or -1 if the file does not exist
+     */
+    template <typename Visit>
+    static long long replay(const std::string& path, Visit visit, long long& outValidBytes) {
+        outValidBytes = 0;
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) return -1;
+        fseek(in, 0, SEEK_END);
+        long size = ftell(in);
+        fseek(in, 0, SEEK_SET);
+        char* bytes = new char[size > 0 ? size : 1];
+        size_t length = size > 0 ? fread(bytes, 1, static_cast<size_t>(size), in) : 0;
+        fclose(in);
+
+        long long records = 0;
+        size_t position = 0;
+        while (length - position >= FRAME_HEADER) {
+            unsigned payload;
+            unsigned checksum;
+            memcpy(&payload, bytes + position, sizeof(payload));
+            memcpy(&checksum, bytes + position + sizeof(payload), sizeof(checksum));
+            if (payload == 0 || payload > length - position - FRAME_HEADER) break;
+            const char* body = bytes + position + FRAME_HEADER;
+            if (crc32(body, payload) != checksum) break;
+
+            ByteReader reader(body, payload);
+            unsigned char type = reader.getByte();
+            visit(static_cast<RecordType>(type), reader);
+            records++;
+            position += FRAME_HEADER + payload;
+        }
+        outValidBytes = static_cast<long long>(position);
+        delete[] bytes;
+        return records;
+    }
+};
+
+#endif // STATE_LOG_H
@@ -0,0 +1,141 @@
+#ifndef TEAM_BALANCER_H
+#define TEAM_BALANCER_H
+
+/**
+ * TeamBalancer - Split 2N players into two teams of N with the smallest
+ * difference in total ELO
+ *
+ * Equal team sizes make equal totals the same as equal averages, which is
+ * what team rating updates use (RankingService::updateTeamRankings).
+ *
+ * ALGORITHM:
+ *   - Exact (N <= EXACT_MAX_TEAM_SIZE): enumerate every team containing
+ *     player 0 (the other team is its complement) as an (N-1)-of-(2N-1)
+ *     bitmask, stepping through masks of equal popcount with Gosper's
+ *     hack. 5v5 is 126 splits.
+ *   - Heuristic (larger N): greedy largest-first - take players from
+ *     strongest to weakest, each to the team with the lower total that
+ *     still has room - then apply the best one-for-one swap between the
+ *     teams until no swap narrows the gap.
+ *
+ * Time Complexity (N players per team):
+ *   - exact: O(C(2N-1, N-1) * N)
+ *   - heuristic: O(N^2) per swap round; rounds are few in practice
+ *     because every applied swap strictly narrows the gap
+ */
+class TeamBalancer {
+public:
+    static const int MAX_TEAM_SIZE = 8;
+    static const int EXACT_MAX_TEAM_SIZE = 5;
+
+private:
+    static long long gapOf(long long total1, long long total) {
+        long long gap = 2 * total1 - total;
+        return gap < 0 ? -gap : gap;
+    }
+
+public:
+    /**
+     * Balanced split of elos[0 .. 2*teamSize-1]
+     *
+     * @param side Output: side[i] is 0 or 1, teamSize players on each
+     * @return Difference between the two teams' total ELO
+     */
+    static long long split(const int* elos, int teamSize, int* side) {
+        if (teamSize <= EXACT_MAX_TEAM_SIZE) return splitExact(elos, teamSize, side);
+        return splitGreedy(elos, teamSize, side);
+    }
+
+    // Exhaustive split - optimal (teamSize <= MAX_TEAM_SIZE)
+    static long long splitExact(const int* elos, int teamSize, int* side) {
+        int count = 2 * teamSize;
+        long long total = 0;
+        for (int i = 0; i < count; i++) total += elos[i];
+
+        // Bit b of a mask puts player b+1 on player 0's team
+        unsigned limit = 1u << (count - 1);
+        unsigned mask = (1u << (teamSize - 1)) - 1;
+        unsigned bestMask = mask;
+        long long bestGap = -1;
+        while (mask < limit) {
+            long long total1 = elos[0];
+            for (int b = 0; b < count - 1; b++) {
+                if (mask & (1u << b)) total1 += elos[b + 1];
+            }
+            long long gap = gapOf(total1, total);
+            if (bestGap < 0 || gap < bestGap) {
+                bestGap = gap;
+                bestMask = mask;
+                if (gap == 0) break;
+            }
+            if (mask == 0) break;  // 1v1: the only split
+
+            // Next mask with the same number of bits (Gosper's hack)
+            unsigned lowest = mask & (0u - mask);
+            unsigned ripple = mask + lowest;
+            mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+        }
+
+        side[0] = 0;
+        for (int b = 0; b < count - 1; b++) {
+            side[b + 1] = (bestMask & (1u << b)) ? 0 : 1;
+        }
+        return bestGap;
+    }
+
+    // Largest-first greedy plus pairwise swaps - near-optimal, O(N^2) per round
+    static long long splitGreedy(const int* elos, int teamSize, int* side) {
+        int count = 2 * teamSize;
+
+        // Strongest first (insertion sort; count <= 2 * MAX_TEAM_SIZE)
+        int order[2 * MAX_TEAM_SIZE];
+        for (int i = 0; i < count; i++) {
+            int j = i;
+            while (j > 0 && elos[order[j - 1]] < elos[i]) {
+                order[j] = order[j - 1];
+                j--;
+            }
+            order[j] = i;
+        }
+
+        long long totals[2] = {0, 0};
+        int sizes[2] = {0, 0};
+        for (int k = 0; k < count; k++) {
+            int player = order[k];
+            int team = totals[0] <= totals[1] ? 0 : 1;
+            if (sizes[team] == teamSize) team = 1 - team;
+            side[player] = team;
+            totals[team] += elos[player];
+            sizes[team]++;
+        }
+
+        // Best one-for-one swap while it narrows the gap
+        long long total = totals[0] + totals[1];
+        long long gap = gapOf(totals[0], total);
+        while (gap > 0) {
+            int bestA = -1;
+            int bestB = -1;
+            long long bestGap = gap;
+            for (int a = 0; a < count; a++) {
+                if (side[a] != 0) continue;
+                for (int b = 0; b < count; b++) {
+                    if (side[b] != 1) continue;
+                    long long swapped = gapOf(totals[0] - elos[a] + elos[b], total);
+                    if (swapped < bestGap) {
+                        bestGap = swapped;
+                        bestA = a;
+                        bestB = b;
+                    }
+                }
+            }
+            if (bestA == -1) break;
+            side[bestA] = 1;
+            side[bestB] = 0;
+            totals[0] += elos[bestB] - elos[bestA];
+            gap = bestGap;
+        }
+        return gap;
+    }
+};
+
+#endif // TEAM_BALANCER_H
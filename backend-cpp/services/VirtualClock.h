@@ -0,0 +1,43 @@
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include "Clock.h"
+#include <atomic>
+
+/**
+ * VirtualClock - Simulated time that only moves when advanced
+ *
+ * Starts at monotonic 0 and a fixed wall-clock epoch, so a run driven by
+ * it (queue waits, window growth, bot fallback, match timestamps) is the
+ * same on every machine and can run far faster than real time. Reads are
+ * atomic; advancing is meant for one driver thread.
+ */
+class VirtualClock : public TimeSource {
+private:
+    std::atomic<long long> nanos;
+    long long epochMillis;
+
+public:
+    static const long long DEFAULT_EPOCH_MILLIS = 1700000000000LL;  // 2023-11-14
+
+    explicit VirtualClock(long long startEpochMillis = DEFAULT_EPOCH_MILLIS)
+        : nanos(0), epochMillis(startEpochMillis) {}
+
+    VirtualClock(const VirtualClock&) = delete;
+    VirtualClock& operator=(const VirtualClock&) = delete;
+
+    long long monotonicNanos() const {
+        return nanos.load(std::memory_order_relaxed);
+    }
+
+    long long wallMillis() const {
+        return epochMillis + monotonicNanos() / Clock::NANOS_PER_MILLI;
+    }
+
+    // Move time forward (negative steps are ignored)
+    void advance(long long stepNanos) {
+        if (stepNanos > 0) nanos.fetch_add(stepNanos, std::memory_order_relaxed);
+    }
+};
+
+#endif // VIRTUAL_CLOCK_H
@@ -28,6 +28,7 @@
 #include <functional>
 #include <cstring>
 #include <cstdio>
+#include <cctype>
 
 namespace http {
 
@@ -35,21 +36,41 @@ struct Request {
     std::string method;
     std::string path;
     std::string body;
-    std::map<std::string, std::string> params;
+    std::map<std::string, std::string> params;   // Query string (?key=value&...)
+    std::map<std::string, std::string> headers;  // Names lower-cased
     
     // URL path parameter (e.g., /api/players/123 -> matches[1] = "123")
     std::string matches[10];
+    
+    // Query parameter by name, "" if absent
+    std::string get_param_value(const std::string& name) const {
+        std::map<std::string, std::string>::const_iterator it = params.find(name);
+        return it == params.end() ? "" : it->second;
+    }
+    
+    // Header value by name (any case), "" if absent
+    std::string get_header_value(const std::string& name) const {
+        std::string key;
+        for (size_t i = 0; i < name.size(); i++) key += static_cast<char>(tolower(static_cast<unsigned char>(name[i])));
+        std::map<std::string, std::string>::const_iterator it = headers.find(key);
+        return it == headers.end() ? "" : it->second;
+    }
 };
 
 struct Response {
     int status = 200;
     std::string body;
     std::string content_type = "application/json";
+    std::map<std::string, std::string> headers;  // Extra response headers
     
     void set_content(const std::string& content, const std::string& type) {
         body = content;
         content_type = type;
     }
+    
+    void set_header(const std::string& name, const std::string& value) {
+        headers[name] = value;
+    }
 };
 
 typedef std::function<void(const Request&, Response&)> Handler;
@@ -98,21 +119,73 @@ private:
         size_t path_end = request.find(' ', path_start);
         req.path = request.substr(path_start, path_end - path_start);
         
+        // Split off the query string: /path?a=1&b=2 -> params["a"] = "1", ...
+        size_t query_start = req.path.find('?');
+        if (query_start != std::string::npos) {
+            std::string query = req.path.substr(query_start + 1);
+            req.path = req.path.substr(0, query_start);
+            size_t pair_start = 0;
+            while (pair_start < query.size()) {
+                size_t pair_end = query.find('&', pair_start);
+                if (pair_end == std::string::npos) pair_end = query.size();
+                size_t equals = query.find('=', pair_start);
+                if (equals != std::string::npos && equals < pair_end) {
+                    req.params[query.substr(pair_start, equals - pair_start)] =
+                        query.substr(equals + 1, pair_end - equals - 1);
+                } else if (pair_end > pair_start) {
+                    req.params[query.substr(pair_start, pair_end - pair_start)] = "";
+                }
+                pair_start = pair_end + 1;
+            }
+        }
+        
         // Parse body (after double newline)
         size_t body_start = request.find("\r\n\r\n");
         if (body_start != std::string::npos) {
             req.body = request.substr(body_start + 4);
         }
+        
+        // Parse headers ("Name: value" lines between the request line and body)
+        size_t line_start = request.find("\r\n");
+        while (line_start != std::string::npos && line_start < body_start) {
+            line_start += 2;
+            size_t line_end = request.find("\r\n", line_start);
+            if (line_end == std::string::npos || line_end > body_start) line_end = body_start;
+            size_t colon = request.find(':', line_start);
+            if (colon != std::string::npos && colon < line_end) {
+                std::string name;
+                for (size_t i = line_start; i < colon; i++) name += static_cast<char>(tolower(static_cast<unsigned char>(request[i])));
+                size_t value_start = colon + 1;
+                while (value_start < line_end && request[value_start] == ' ') value_start++;
+                req.headers[name] = request.substr(value_start, line_end - value_start);
+            }
+            line_start = line_end == body_start ? std::string::npos : line_end;
+        }
+    }
+    
+    static const char* status_text(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 204: return "No Content";
+            case 304: return "Not Modified";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            default: return "OK";
+        }
     }
     
     std::string build_response(const Response& res) {
         std::string response;
-        response += "HTTP/1.1 " + std::to_string(res.status) + " OK\r\n";
+        response += "HTTP/1.1 " + std::to_string(res.status) + " " + status_text(res.status) + "\r\n";
         response += "Content-Type: " + res.content_type + "\r\n";
         response += "Content-Length: " + std::to_string(res.body.length()) + "\r\n";
+        for (std::map<std::string, std::string>::const_iterator it = res.headers.begin(); it != res.headers.end(); ++it) {
+            response += it->first + ": " + it->second + "\r\n";
+        }
         response += "Access-Control-Allow-Origin: *\r\n";
         response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-        response += "Access-Control-Allow-Headers: Content-Type\r\n";
+        response += "Access-Control-Allow-Headers: Content-Type, If-None-Match\r\n";
+        response += "Access-Control-Expose-Headers: ETag\r\n";
         response += "Connection: close\r\n";
         response += "\r\n";
         response += res.body;
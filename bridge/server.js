@@ -128,6 +128,10 @@ function startCppBackend() {
 
     cppProcess = spawn(cppPath, [], {
         cwd: path.join(__dirname, '..', 'backend-cpp'),
+        // Snapshot + write-ahead log directory, so a restart keeps players and ratings
+        env: Object.assign({}, process.env, {
+            ARENA_DATA_DIR: process.env.ARENA_DATA_DIR || path.join(__dirname, '..', 'backend-cpp', 'data')
+        }),
         stdio: ['ignore', 'pipe', 'pipe']
     });
 